@@ -27,13 +27,81 @@
  */
 
 #include <hirzel/json/Value.hpp>
+#include <hirzel/json/Arena.hpp>
+#include <hirzel/json/KeyPool.hpp>
+#include <hirzel/json/MappedFile.hpp>
+#include <hirzel/json/ParseResult.hpp>
+#include <hirzel/json/Parser.hpp>
+#include <hirzel/json/Pointer.hpp>
+#include <hirzel/json/PointerSet.hpp>
+#include <hirzel/json/Query.hpp>
+#include <hirzel/json/Validator.hpp>
+#include <hirzel/json/Document.hpp>
+#include <hirzel/json/TapeValue.hpp>
+#include <hirzel/json/Token.hpp>
+#include <hirzel/json/parse.hpp>
+#include <hirzel/json/bind.hpp>
+#include <hirzel/json/PushParser.hpp>
+#include <hirzel/json/ValueBuilder.hpp>
+#include <hirzel/json/NdjsonReader.hpp>
+#include <hirzel/json/Writer.hpp>
+#include <hirzel/json/string.hpp>
+#include <hirzel/json/binary.hpp>
 
 namespace hirzel::json
 {
 	Value deserialize(const char* json);
 	Value deserialize(const std::string& json);
+	Value deserialize(const char* json, Arena& arena);
+	Value deserialize(const std::string& json, Arena& arena);
+	// Object keys borrow interned storage from keys, which must outlive the result
+	Value deserialize(const char* json, KeyPool& keys);
+	Value deserialize(const std::string& json, KeyPool& keys);
+	// Strings without escapes view json directly, so it must outlive the result too
+	Value deserializeView(const char* json, Arena& arena);
+	Value deserializeView(const std::string& json, Arena& arena);
+	Value deserializeView(std::string&& json, Arena& arena) = delete;
+	Value deserializeView(const MappedFile& file, Arena& arena);
+	// Maps the file rather than reading it, so its contents are never copied
+	Value deserializeFile(const std::string& filepath);
+	Value deserializeFile(const std::string& filepath, Arena& arena);
+	// Never throw for malformed input. Line and column of an error are read
+	// from json, so it must outlive the result for those to be asked for.
+	ParseResult tryDeserialize(const char* json);
+	ParseResult tryDeserialize(const std::string& json);
+	ParseResult tryDeserialize(const char* json, Arena& arena);
+	ParseResult tryDeserialize(const std::string& json, Arena& arena);
+	ParseResult tryDeserialize(const char* json, KeyPool& keys);
+	ParseResult tryDeserialize(const std::string& json, KeyPool& keys);
+	// Parses only the first length bytes of json, so it can be a slice such as
+	// one line of NDJSON. The byte at length must be whitespace or the
+	// terminator, and json must be terminated somewhere after it.
+	ParseResult tryDeserialize(const char* json, size_t length);
+	ParseResult tryDeserialize(const char* json, size_t length, KeyPool& keys);
+	// Checks values against the format as they are read and stops at the first
+	// one it rejects, reported as ParseError::FormatMismatch at that value
+	Value deserialize(const char* json, const Validator& validator);
+	Value deserialize(const std::string& json, const Validator& validator);
+	ParseResult tryDeserialize(const char* json, const Validator& validator);
+	ParseResult tryDeserialize(const std::string& json, const Validator& validator);
+	// Parses into out, reusing the containers and strings it already holds
+	// where the document has the same shape. Parser does the same and also
+	// keeps its own buffers between documents.
+	void deserializeInto(const char* json, Value& out);
+	void deserializeInto(const std::string& json, Value& out);
+	Value deserialize(Token& token);
+	Value deserialize(Token& token, Arena& arena);
+	void serialize(Writer& out, const Value& json, bool minimized = false);
 	void serialize(std::ostream& out, const Value& json, bool minimized = false);
 	std::string serialize(const Value& json, bool minimized = false);
+
+	// Same output as serialize. Arrays and objects of 1024 members or more
+	// are split into chunks that are serialized on threadCount threads, one
+	// per core for 0, and joined in order. The value must not be changed
+	// while this runs.
+	void serializeParallel(Writer& out, const Value& json, bool minimized = false, size_t threadCount = 0);
+	void serializeParallel(std::ostream& out, const Value& json, bool minimized = false, size_t threadCount = 0);
+	std::string serializeParallel(const Value& json, bool minimized = false, size_t threadCount = 0);
 }
 
 #endif
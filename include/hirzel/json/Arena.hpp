@@ -0,0 +1,80 @@
+#ifndef HIRZEL_JSON_JSON_ARENA_HPP
+#define HIRZEL_JSON_JSON_ARENA_HPP
+
+#include <hirzel/json/Value.hpp>
+#include <memory_resource>
+#include <string_view>
+
+namespace hirzel::json
+{
+	/*
+	 * Monotonic allocator for whole documents. Values created by an arena
+	 * never free their payloads individually; everything is released at once
+	 * when the arena is reset or destroyed, so they must be destroyed before
+	 * either happens. Arrays and objects filled through arrayToFill and
+	 * objectToFill, as parsing does, hold nothing else and are released
+	 * without being walked. Once one is handed out by Value's non-const
+	 * accessors it may be given values that own memory, so it is destroyed
+	 * with them instead. Copying such a Value produces an ordinary
+	 * heap-backed deep copy.
+	 */
+	class Arena : public std::pmr::memory_resource
+	{
+		struct Block
+		{
+			Block* next;
+			size_t size;
+		};
+
+		Block* _blocks;
+		char* _cursor;
+		char* _end;
+		size_t _nextBlockSize;
+		size_t _allocationCount;
+		size_t _bytesUsed;
+		size_t _bytesReserved;
+		size_t _blockCount;
+		size_t _deallocationCount;
+
+	private:
+
+		void* allocateBlock(size_t bytes, size_t alignment);
+
+	protected:
+
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void*, size_t, size_t) override { _deallocationCount += 1; }
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	public:
+
+		Arena(size_t initialBlockSize = 64 * 1024);
+		Arena(Arena&&) = delete;
+		Arena(const Arena&) = delete;
+		~Arena();
+
+		void reset();
+
+		// Strings short enough to be stored inline never touch the arena
+		Value createString(std::string_view text);
+		// Refers to text without copying it, so text must outlive the value
+		Value viewString(std::string_view text);
+		Key createKey(std::string_view text);
+		Value createArray();
+		Value createObject();
+		// The contents of a value from createArray or createObject, to be given
+		// only values from this arena, such as inline strings, so that it can
+		// be released without being walked
+		Array& arrayToFill(Value& array);
+		Object& objectToFill(Value& object);
+
+		const auto& allocationCount() const { return _allocationCount; }
+		const auto& bytesUsed() const { return _bytesUsed; }
+		const auto& bytesReserved() const { return _bytesReserved; }
+		const auto& blockCount() const { return _blockCount; }
+		// Memory given back by containers, which is only reclaimed on reset
+		const auto& deallocationCount() const { return _deallocationCount; }
+	};
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef HIRZEL_JSON_JSON_CURSOR_HPP
+#define HIRZEL_JSON_JSON_CURSOR_HPP
+
+#include <hirzel/json/Token.hpp>
+#include <hirzel/json/Value.hpp>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace hirzel::json
+{
+	class Cursor
+	{
+		Token _token;
+
+	private:
+
+		Token firstChild(TokenType open) const;
+		static void seekSeparator(Token& token, TokenType close);
+
+	public:
+
+		Cursor(const Token& token);
+
+		ValueType type() const;
+		bool isNull() const { return _token.type() == TokenType::Null; }
+		bool isNumber() const { return _token.type() == TokenType::Number; }
+		bool isBoolean() const { return _token.type() == TokenType::True || _token.type() == TokenType::False; }
+		bool isString() const { return _token.type() == TokenType::String; }
+		bool isArray() const { return _token.type() == TokenType::LeftBracket; }
+		bool isObject() const { return _token.type() == TokenType::LeftBrace; }
+
+		double number() const;
+		bool boolean() const;
+		// Contents exactly as they appear in the source, escapes included
+		std::string_view rawString() const;
+		// Views the source when there are no escapes, otherwise decodes into buffer
+		std::string_view string(std::string& buffer) const;
+		std::string string() const;
+		Value value() const;
+		// Source text of the whole value, which can be copied out unparsed
+		std::string_view raw() const;
+		size_t length() const;
+
+		std::optional<Cursor> at(size_t i) const;
+		std::optional<Cursor> at(std::string_view key) const;
+		Cursor operator[](size_t i) const;
+		Cursor operator[](std::string_view key) const;
+
+		template <typename Callback>
+		void forEachElement(Callback&& callback) const
+		{
+			auto token = firstChild(TokenType::LeftBracket);
+
+			while (token.type() != TokenType::RightBracket)
+			{
+				callback(Cursor(token));
+				token.skipValue();
+				seekSeparator(token, TokenType::RightBracket);
+			}
+		}
+
+		template <typename Callback>
+		void forEachMember(Callback&& callback) const
+		{
+			auto token = firstChild(TokenType::LeftBrace);
+			auto decodedKey = std::string();
+
+			while (token.type() != TokenType::RightBrace)
+			{
+				if (token.type() != TokenType::String)
+					throw std::runtime_error("Expected label, got '" + token.text() + "'.");
+
+				auto key = Cursor(token).string(decodedKey);
+
+				token.seekNext();
+
+				if (token.type() != TokenType::Colon)
+					throw std::runtime_error("Expected ':' before '" + token.text() + "'.");
+
+				token.seekNext();
+				callback(key, Cursor(token));
+				token.skipValue();
+				seekSeparator(token, TokenType::RightBrace);
+			}
+		}
+
+		const auto& token() const { return _token; }
+	};
+}
+
+#endif
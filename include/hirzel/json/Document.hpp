@@ -0,0 +1,39 @@
+#ifndef HIRZEL_JSON_JSON_DOCUMENT_HPP
+#define HIRZEL_JSON_JSON_DOCUMENT_HPP
+
+#include <hirzel/json/Cursor.hpp>
+#include <hirzel/json/StructuralIndex.hpp>
+#include <string>
+
+namespace hirzel::json
+{
+	/*
+	 * On-demand view of a JSON buffer. Nothing is parsed up front beyond the
+	 * structural index; cursors decode fields as they are accessed and skip
+	 * everything else, so unvisited parts of the document are not validated.
+	 * The buffer must outlive the document and all of its cursors.
+	 */
+	class Document
+	{
+		const char* _src;
+		size_t _length;
+		StructuralIndex _index;
+		bool _isIndexed;
+
+	public:
+
+		Document(const char* json);
+		Document(const char* json, size_t length);
+		Document(const std::string& json);
+		Document(std::string&&) = delete;
+		Document(Document&&) = default;
+		Document(const Document&) = delete;
+
+		Cursor root() const;
+
+		const auto* src() const { return _src; }
+		const auto& length() const { return _length; }
+	};
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef HIRZEL_JSON_JSON_KEY_HPP
+#define HIRZEL_JSON_JSON_KEY_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace hirzel::json
+{
+	/*
+	 * Object member key. Short keys are stored inline, longer ones on the heap
+	 * unless they are borrowed from an Arena or KeyPool that outlives the key.
+	 * Copies never borrow, so they stay valid after that storage is gone.
+	 */
+	class Key
+	{
+		enum class Storage : uint8_t
+		{
+			Owned,
+			Borrowed,
+			Inline
+		};
+
+		struct Data
+		{
+			Storage storage;
+			uint32_t length;
+			const char* chars;
+		};
+
+		struct InlineText
+		{
+			Storage storage;
+			uint8_t length;
+			char chars[sizeof(Data) - 2];
+		};
+
+		union
+		{
+			Data _data;
+			InlineText _inline;
+		};
+
+	private:
+
+		void init(std::string_view text);
+		void release();
+
+	public:
+
+		static constexpr size_t inlineCapacity = sizeof(InlineText::chars);
+
+		Key();
+		Key(std::string_view text);
+		Key(const std::string& text) : Key(std::string_view(text)) {}
+		Key(const char* text) : Key(std::string_view(text)) {}
+		Key(Key&& other) noexcept;
+		Key(const Key& other);
+		~Key() { release(); }
+
+		// Refers to text without copying it, so text must outlive the key
+		static Key borrow(std::string_view text);
+
+		Key& operator=(Key&& other) noexcept;
+		Key& operator=(const Key& other);
+
+		std::string_view view() const
+		{
+			return _data.storage == Storage::Inline
+				? std::string_view(_inline.chars, _inline.length)
+				: std::string_view(_data.chars, _data.length);
+		}
+
+		operator std::string_view() const { return view(); }
+
+		const char* data() const { return view().data(); }
+		size_t length() const { return view().length(); }
+		bool isBorrowed() const { return _data.storage == Storage::Borrowed; }
+		bool isInline() const { return _data.storage == Storage::Inline; }
+
+		// Interned keys share storage, so equal ones usually compare by pointer
+		bool operator==(std::string_view other) const
+		{
+			auto text = view();
+
+			return text.length() == other.length()
+				&& (text.data() == other.data() || text == other);
+		}
+
+		bool operator!=(std::string_view other) const { return !(*this == other); }
+	};
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef HIRZEL_JSON_JSON_KEY_POOL_HPP
+#define HIRZEL_JSON_JSON_KEY_POOL_HPP
+
+#include <hirzel/json/Arena.hpp>
+#include <hirzel/json/Key.hpp>
+#include <hirzel/json/Value.hpp>
+#include <atomic>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_set>
+
+namespace hirzel::json
+{
+	/*
+	 * Interning table for object keys, shared by every document parsed with
+	 * it and safe to use from several threads at once. Each distinct key is
+	 * stored once and the keys of parsed objects borrow that storage, so the
+	 * pool must outlive those documents (copies of them own their keys). Keys
+	 * short enough to be stored inline skip the pool and its statistics. Once
+	 * the pool holds maxBytes of text, or for keys longer than maxKeyLength,
+	 * keys are no longer interned and get their own storage as usual.
+	 * Containers parsed with the pool come from createArray and createObject,
+	 * which mark them to be copied in full rather than shared.
+	 */
+	class KeyPool
+	{
+		Arena _storage;
+		std::unordered_set<std::string_view> _keys;
+		mutable std::shared_mutex _mutex;
+		size_t _maxKeyLength;
+		size_t _maxBytes;
+		size_t _bytesStored;
+		std::atomic<size_t> _lookupCount;
+		std::atomic<size_t> _hitCount;
+		std::atomic<size_t> _bytesSaved;
+
+	public:
+
+		KeyPool(size_t maxKeyLength = 256, size_t maxBytes = 16 * 1024 * 1024);
+		KeyPool(KeyPool&&) = delete;
+		KeyPool(const KeyPool&) = delete;
+
+		Key intern(std::string_view key);
+		static Value createArray();
+		static Value createObject();
+
+		size_t keyCount() const;
+		size_t bytesStored() const;
+		size_t lookupCount() const { return _lookupCount.load(std::memory_order_relaxed); }
+		size_t hitCount() const { return _hitCount.load(std::memory_order_relaxed); }
+		// Key text that was found in the pool instead of being stored again
+		size_t bytesSaved() const { return _bytesSaved.load(std::memory_order_relaxed); }
+		double hitRate() const;
+
+		const auto& maxKeyLength() const { return _maxKeyLength; }
+		const auto& maxBytes() const { return _maxBytes; }
+	};
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef HIRZEL_JSON_JSON_MAPPED_FILE_HPP
+#define HIRZEL_JSON_JSON_MAPPED_FILE_HPP
+
+#include <string>
+
+namespace hirzel::json
+{
+	/*
+	 * Read-only view of a whole file, memory mapped where the platform allows
+	 * it. The contents are always followed by at least padding zero bytes, so
+	 * they are null terminated and the tokenizer may scan past the end in
+	 * blocks without faulting, even when the file size is a multiple of the
+	 * page size. Elsewhere the file is read into a padded heap buffer.
+	 */
+	class MappedFile
+	{
+		char* _data;
+		size_t _length;
+		size_t _capacity;
+
+	private:
+
+		void release();
+
+	public:
+
+		static constexpr size_t padding = 64;
+
+		// Sequential files are read ahead aggressively and dropped behind the
+		// reader, which suits parsing but not random access
+		MappedFile(const std::string& filepath, bool isSequential = true);
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile(const MappedFile&) = delete;
+		~MappedFile() { release(); }
+
+		MappedFile& operator=(MappedFile&& other) noexcept;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* data() const { return _data; }
+		const auto& length() const { return _length; }
+	};
+}
+
+#endif
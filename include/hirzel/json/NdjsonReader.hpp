@@ -0,0 +1,66 @@
+#ifndef HIRZEL_JSON_JSON_NDJSON_READER_HPP
+#define HIRZEL_JSON_JSON_NDJSON_READER_HPP
+
+#include <hirzel/json/Value.hpp>
+#include <hirzel/json/KeyPool.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace hirzel::json
+{
+	struct NdjsonRecord
+	{
+		// 1-based line number and byte offset of the line in the input
+		size_t line = 0;
+		size_t offset = 0;
+		Value value;
+		// Empty unless the line failed to parse
+		std::string error;
+
+		bool isError() const { return !error.empty(); }
+	};
+
+	/*
+	 * Reads newline-delimited JSON on a pool of worker threads. The input is
+	 * split into line-aligned chunks which are parsed independently; records
+	 * are handed to the callback on the calling thread, either in input order
+	 * or in whatever order chunks finish. Blank lines are skipped and a line
+	 * that fails to parse yields a record carrying the error instead of
+	 * stopping the read. Only a bounded number of parsed chunks is held at
+	 * once, so inputs far larger than memory can be streamed from a mapping.
+	 */
+	class NdjsonReader
+	{
+	public:
+
+		using Callback = std::function<void(NdjsonRecord&&)>;
+
+	private:
+
+		size_t _threadCount;
+		size_t _chunkSize;
+		KeyPool* _keys;
+		bool _isOrdered;
+
+	public:
+
+		NdjsonReader(size_t threadCount = 0, bool isOrdered = true, size_t chunkSize = 1 << 20);
+
+		// Interns object keys in keys, which must outlive the records read
+		void setKeyPool(KeyPool* keys) { _keys = keys; }
+
+		// Lines are parsed in place, so src must be terminated at length as a
+		// std::string or MappedFile is
+		void read(const char* src, size_t length, const Callback& callback) const;
+		std::vector<NdjsonRecord> read(const char* src, size_t length) const;
+		std::vector<NdjsonRecord> read(const std::string& src) const;
+
+		const auto& threadCount() const { return _threadCount; }
+		const auto& chunkSize() const { return _chunkSize; }
+		const auto& isOrdered() const { return _isOrdered; }
+		auto* keyPool() const { return _keys; }
+	};
+}
+
+#endif
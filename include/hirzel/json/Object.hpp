@@ -0,0 +1,107 @@
+#ifndef HIRZEL_JSON_JSON_OBJECT_HPP
+#define HIRZEL_JSON_JSON_OBJECT_HPP
+
+#include <hirzel/json/Value.hpp>
+#include <hirzel/json/Key.hpp>
+#include <initializer_list>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * Insertion-ordered map of keys to values. Members are stored contiguously
+	 * and searched linearly while the object is small; past indexThreshold
+	 * members an open-addressing hash index is built alongside them. Keys must
+	 * not be modified through iterators, as that would desync the index.
+	 */
+	class Object
+	{
+	public:
+
+		using Member = std::pair<Key, Value>;
+		using iterator = std::pmr::vector<Member>::iterator;
+		using const_iterator = std::pmr::vector<Member>::const_iterator;
+
+		static constexpr size_t indexThreshold = 8;
+
+	private:
+
+		struct Slot
+		{
+			uint32_t hash = 0;
+			// Position of the member plus one, so that zero marks an empty slot
+			uint32_t position = 0;
+		};
+
+		std::pmr::vector<Member> _members;
+		std::pmr::vector<Slot> _slots;
+
+	private:
+
+		size_t indexOf(std::string_view key) const;
+		size_t indexOf(std::string_view key, uint32_t hash) const;
+		void addSlot(uint32_t hash, size_t index);
+		void rebuildIndex();
+
+	public:
+
+		Object() = default;
+		Object(std::pmr::memory_resource* resource);
+		Object(std::initializer_list<Member> members);
+		Object(Object&&) = default;
+		Object(const Object&) = default;
+
+		Object& operator=(Object&&) = default;
+		Object& operator=(const Object&) = default;
+
+		// Inserts value under key unless the key is already present, in which
+		// case the existing member is kept, as with std::unordered_map.
+		std::pair<iterator, bool> emplace(Key&& key, Value&& value);
+		Value& operator[](std::string_view key);
+
+		// Hash used by the index, so lookups repeated with the same key can
+		// compute it once and use the overloads of find that take it
+		static uint32_t hash(std::string_view key);
+
+		iterator find(std::string_view key);
+		const_iterator find(std::string_view key) const;
+		iterator find(std::string_view key, uint32_t hash);
+		const_iterator find(std::string_view key, uint32_t hash) const;
+		bool contains(std::string_view key) const { return find(key) != end(); }
+
+		// Preserves the order of the remaining members, so this is linear
+		size_t erase(std::string_view key);
+		// Drops the members from position size on
+		void truncate(size_t size);
+		void reserve(size_t size) { _members.reserve(size); }
+		void clear();
+
+		iterator begin() { return _members.begin(); }
+		iterator end() { return _members.end(); }
+		const_iterator begin() const { return _members.begin(); }
+		const_iterator end() const { return _members.end(); }
+
+		size_t size() const { return _members.size(); }
+		bool empty() const { return _members.empty(); }
+		bool isIndexed() const { return !_slots.empty(); }
+	};
+
+	template <typename T>
+	Value Value::from(const std::unordered_map<std::string, T>& object)
+	{
+		Object out;
+
+		out.reserve(object.size());
+
+		for (const auto& pair : object)
+			out[pair.first] = pair.second;
+
+		return out;
+	}
+}
+
+#endif
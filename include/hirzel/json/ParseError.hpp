@@ -0,0 +1,35 @@
+#ifndef HIRZEL_JSON_JSON_PARSE_ERROR_HPP
+#define HIRZEL_JSON_JSON_PARSE_ERROR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hirzel::json
+{
+	enum class ParseError : uint8_t
+	{
+		None,
+		UnexpectedEndOfFile,
+		UnexpectedCharacter,
+		InvalidLiteral,
+		UnterminatedString,
+		InvalidNumber,
+		InvalidEscape,
+		InvalidUnicodeEscape,
+		ExpectedKey,
+		ExpectedColon,
+		ExpectedCommaOrBrace,
+		ExpectedCommaOrBracket,
+		TrailingContent,
+		TooDeep,
+		// Well-formed, but rejected by the Validator it was parsed against
+		FormatMismatch
+	};
+
+	// Nesting deeper than this is rejected rather than risking the stack
+	static constexpr size_t maxParseDepth = 1024;
+
+	const char* describe(ParseError error);
+}
+
+#endif
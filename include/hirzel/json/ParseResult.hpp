@@ -0,0 +1,51 @@
+#ifndef HIRZEL_JSON_JSON_PARSE_RESULT_HPP
+#define HIRZEL_JSON_JSON_PARSE_RESULT_HPP
+
+#include <hirzel/json/ParseError.hpp>
+#include <hirzel/json/Value.hpp>
+#include <string>
+
+namespace hirzel::json
+{
+	/*
+	 * Outcome of tryDeserialize: either the parsed value or the first error
+	 * and the byte offset it was found at. Line and column are worked out
+	 * from the source on first request, so the source must still be alive
+	 * when they are asked for.
+	 */
+	class ParseResult
+	{
+		Value _value;
+		const char* _src;
+		size_t _offset;
+		mutable size_t _line;
+		mutable size_t _column;
+		ParseError _error;
+
+	private:
+
+		void locate() const;
+
+	public:
+
+		ParseResult(Value&& value);
+		ParseResult(ParseError error, const char* src, size_t offset);
+
+		bool isOk() const { return _error == ParseError::None; }
+		explicit operator bool() const { return isOk(); }
+
+		Value& value() { assert(isOk()); return _value; }
+		const Value& value() const { assert(isOk()); return _value; }
+		Value take() { assert(isOk()); return std::move(_value); }
+
+		// 1-based and counted in bytes
+		size_t line() const;
+		size_t column() const;
+		std::string message() const;
+
+		const auto& error() const { return _error; }
+		const auto& offset() const { return _offset; }
+	};
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef HIRZEL_JSON_JSON_PARSER_HPP
+#define HIRZEL_JSON_JSON_PARSER_HPP
+
+#include <hirzel/json/ParseError.hpp>
+#include <hirzel/json/StructuralIndex.hpp>
+#include <hirzel/json/Value.hpp>
+#include <string>
+
+namespace hirzel::json
+{
+	/*
+	 * Parses one document after another into values the caller keeps. The
+	 * arrays, objects and strings already in a value are parsed into wherever
+	 * the new document has the same shape, and the token index and decoding
+	 * buffer are kept between calls, so once warmed up, parsing documents
+	 * shaped like the last ones allocates next to nothing.
+	 *
+	 * On failure the value holds whatever had been parsed before the error.
+	 * Defined in src/hirzel/json.cpp, alongside deserialize.
+	 */
+	class Parser
+	{
+		StructuralIndex _index;
+		std::string _decoded;
+		size_t _errorOffset = 0;
+		ParseError _error = ParseError::None;
+
+	public:
+
+		void parseInto(const char* json, size_t length, Value& out);
+		void parseInto(const char* json, Value& out);
+		void parseInto(const std::string& json, Value& out);
+		// Never throw for malformed input, which is described by error()
+		bool tryParseInto(const char* json, size_t length, Value& out);
+		bool tryParseInto(const char* json, Value& out);
+		bool tryParseInto(const std::string& json, Value& out);
+
+		// Of the last call
+		const auto& error() const { return _error; }
+		const auto& errorOffset() const { return _errorOffset; }
+	};
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef HIRZEL_JSON_JSON_POINTER_HPP
+#define HIRZEL_JSON_JSON_POINTER_HPP
+
+#include <hirzel/json/Value.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * RFC 6901 JSON Pointer such as "/colors/3/code". The text is parsed once:
+	 * each reference token is unescaped, hashed for object lookup and, where
+	 * it is a valid array index, converted to one up front, so resolving the
+	 * pointer against a value does not allocate.
+	 */
+	class Pointer
+	{
+	public:
+
+		static constexpr size_t notAnIndex = (size_t)-1;
+
+		struct Segment
+		{
+			uint32_t offset;
+			uint32_t length;
+			uint32_t hash;
+			// Array index named by the token, or notAnIndex if it names none
+			size_t index;
+		};
+
+	private:
+
+		std::string _text;
+		// Unescaped reference tokens stored back to back
+		std::string _keys;
+		std::vector<Segment> _segments;
+
+	public:
+
+		Pointer() = default;
+		// Explicit so that string keys passed to Value::at stay unambiguous
+		explicit Pointer(std::string_view text);
+		explicit Pointer(const std::string& text) : Pointer(std::string_view(text)) {}
+		explicit Pointer(const char* text) : Pointer(std::string_view(text)) {}
+
+		// Steps from value to the member or item named by segment i
+		const Value* step(const Value& value, size_t i) const;
+		Value* step(Value& value, size_t i) const;
+
+		// Returns nullptr if any token along the way does not exist
+		const Value* resolve(const Value& root) const;
+		Value* resolve(Value& root) const;
+
+		std::string_view key(size_t i) const { return std::string_view(_keys).substr(_segments[i].offset, _segments[i].length); }
+		const auto& segments() const { return _segments; }
+		const auto& text() const { return _text; }
+		size_t depth() const { return _segments.size(); }
+
+		bool operator==(const Pointer& other) const { return _text == other._text; }
+		bool operator!=(const Pointer& other) const { return _text != other._text; }
+	};
+}
+
+#endif
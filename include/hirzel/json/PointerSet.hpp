@@ -0,0 +1,36 @@
+#ifndef HIRZEL_JSON_JSON_POINTER_SET_HPP
+#define HIRZEL_JSON_JSON_POINTER_SET_HPP
+
+#include <hirzel/json/Pointer.hpp>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * Group of pointers resolved against a document together. They are
+	 * ordered up front so pointers sharing a prefix are adjacent, letting a
+	 * resolve walk each shared prefix once instead of once per pointer.
+	 */
+	class PointerSet
+	{
+		std::vector<Pointer> _pointers;
+		// Positions of the pointers in resolution order
+		std::vector<size_t> _order;
+		// Segments each pointer in _order shares with the one before it
+		std::vector<size_t> _shared;
+		size_t _maxDepth;
+
+	public:
+
+		PointerSet(std::vector<Pointer> pointers);
+
+		// Stores the value found by pointer i, or nullptr, at out[i]
+		void resolve(const Value& root, const Value** out) const;
+		std::vector<const Value*> resolve(const Value& root) const;
+
+		const auto& pointers() const { return _pointers; }
+		size_t size() const { return _pointers.size(); }
+	};
+}
+
+#endif
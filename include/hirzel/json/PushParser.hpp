@@ -0,0 +1,440 @@
+#ifndef HIRZEL_JSON_JSON_PUSH_PARSER_HPP
+#define HIRZEL_JSON_JSON_PUSH_PARSER_HPP
+
+#include <hirzel/json/number.hpp>
+#include <hirzel/json/string.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * Incremental counterpart to EventParser. Input may be fed in chunks of
+	 * any size and events are reported as soon as each token is complete.
+	 * State is a stack of open containers plus, only when a token straddles
+	 * two chunks, the part of that token seen so far.
+	 */
+	template <typename Handler>
+	class PushParser
+	{
+		enum class Expect : uint8_t
+		{
+			Value,
+			ValueOrEnd,
+			Key,
+			KeyOrEnd,
+			Colon,
+			CommaOrEnd,
+			Done
+		};
+
+		enum class Lexeme : uint8_t
+		{
+			None,
+			String,
+			StringEscape,
+			Number,
+			Literal,
+			Slash,
+			LineComment,
+			BlockComment,
+			BlockCommentEnd
+		};
+
+		Handler& _handler;
+		std::vector<char> _containers;
+		std::string _buffer;
+		std::string _decoded;
+		const char* _literal;
+		size_t _literalPos;
+		size_t _offset;
+		Expect _expect;
+		Lexeme _lexeme;
+		bool _isKey;
+
+	private:
+
+		[[noreturn]] void unexpected(char c) const
+		{
+			throw std::runtime_error(std::string("Unexpected character '") + c + "' at pos: " + std::to_string(_offset) + ".");
+		}
+
+		static bool isNumberChar(char c)
+		{
+			return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+		}
+
+		void completeValue()
+		{
+			_expect = _containers.empty()
+				? Expect::Done
+				: Expect::CommaOrEnd;
+		}
+
+		void completeString(std::string_view text)
+		{
+			_lexeme = Lexeme::None;
+
+			if (findEscape(text) != text.size())
+			{
+				unescape(text, _decoded);
+				text = _decoded;
+			}
+
+			if (_isKey)
+			{
+				_handler.onKey(text);
+				_expect = Expect::Colon;
+				return;
+			}
+
+			_handler.onString(text);
+			completeValue();
+		}
+
+		void completeNumber()
+		{
+			double value;
+
+			if (!parseNumber(_buffer.data(), _buffer.length(), value))
+				throw std::runtime_error("Invalid number '" + _buffer + "' at pos: " + std::to_string(_offset) + ".");
+
+			_lexeme = Lexeme::None;
+			_handler.onNumber(value);
+			_buffer.clear();
+			completeValue();
+		}
+
+		void completeLiteral()
+		{
+			_lexeme = Lexeme::None;
+
+			switch (_literal[0])
+			{
+			case 't':
+				_handler.onBoolean(true);
+				break;
+
+			case 'f':
+				_handler.onBoolean(false);
+				break;
+
+			default:
+				_handler.onNull();
+				break;
+			}
+
+			completeValue();
+		}
+
+		void close(char c)
+		{
+			if (_containers.empty() || _containers.back() != (c == '}' ? '{' : '['))
+				unexpected(c);
+
+			_containers.pop_back();
+
+			if (c == '}')
+				_handler.onEndObject();
+			else
+				_handler.onEndArray();
+
+			completeValue();
+		}
+
+		void startValue(char c)
+		{
+			switch (c)
+			{
+			case '{':
+				_handler.onStartObject();
+				_containers.push_back('{');
+				_expect = Expect::KeyOrEnd;
+				break;
+
+			case '[':
+				_handler.onStartArray();
+				_containers.push_back('[');
+				_expect = Expect::ValueOrEnd;
+				break;
+
+			case '\"':
+				_lexeme = Lexeme::String;
+				_isKey = false;
+				break;
+
+			case 't':
+			case 'f':
+			case 'n':
+				_lexeme = Lexeme::Literal;
+				_literal = c == 't' ? "true" : c == 'f' ? "false" : "null";
+				_literalPos = 1;
+				break;
+
+			default:
+				if (c != '-' && (c < '0' || c > '9'))
+					unexpected(c);
+
+				_lexeme = Lexeme::Number;
+				_buffer.push_back(c);
+				break;
+			}
+		}
+
+		void structural(char c)
+		{
+			if ((unsigned char)c <= ' ')
+				return;
+
+			if (c == '/')
+			{
+				_lexeme = Lexeme::Slash;
+				return;
+			}
+
+			switch (_expect)
+			{
+			case Expect::Value:
+				startValue(c);
+				break;
+
+			case Expect::ValueOrEnd:
+				if (c == ']')
+					close(c);
+				else
+					startValue(c);
+				break;
+
+			case Expect::KeyOrEnd:
+			case Expect::Key:
+				if (c == '}' && _expect == Expect::KeyOrEnd)
+				{
+					close(c);
+					break;
+				}
+
+				if (c != '\"')
+					unexpected(c);
+
+				_lexeme = Lexeme::String;
+				_isKey = true;
+				break;
+
+			case Expect::Colon:
+				if (c != ':')
+					unexpected(c);
+
+				_expect = Expect::Value;
+				break;
+
+			case Expect::CommaOrEnd:
+				if (c == ',')
+				{
+					_expect = _containers.back() == '{'
+						? Expect::Key
+						: Expect::Value;
+					break;
+				}
+
+				close(c);
+				break;
+
+			case Expect::Done:
+				unexpected(c);
+			}
+		}
+
+		// Returns the position after the string if it closed within [i, end).
+		size_t scanString(const char* data, size_t i, size_t end)
+		{
+			auto start = i;
+
+			while (i < end)
+			{
+				auto c = data[i];
+
+				if (c == '\"')
+				{
+					if (_buffer.empty())
+					{
+						completeString(std::string_view(data + start, i - start));
+					}
+					else
+					{
+						_buffer.append(data + start, i - start);
+						completeString(_buffer);
+						_buffer.clear();
+					}
+
+					return i + 1;
+				}
+
+				if (c == '\\')
+				{
+					if (i + 1 == end)
+					{
+						_buffer.append(data + start, i + 1 - start);
+						_lexeme = Lexeme::StringEscape;
+
+						return end;
+					}
+
+					i += 1;
+				}
+
+				i += 1;
+			}
+
+			_buffer.append(data + start, end - start);
+
+			return end;
+		}
+
+	public:
+
+		PushParser(Handler& handler) :
+			_handler(handler),
+			_literal(nullptr),
+			_literalPos(0),
+			_offset(0),
+			_expect(Expect::Value),
+			_lexeme(Lexeme::None),
+			_isKey(false)
+		{}
+
+		void feed(const char* data, size_t length)
+		{
+			size_t i = 0;
+
+			while (i < length)
+			{
+				auto c = data[i];
+
+				switch (_lexeme)
+				{
+				case Lexeme::None:
+					structural(c);
+					i += 1;
+					break;
+
+				case Lexeme::String:
+				{
+					auto next = scanString(data, i, length);
+
+					_offset += next - i;
+					i = next;
+					continue;
+				}
+
+				case Lexeme::StringEscape:
+					_buffer.push_back(c);
+					_lexeme = Lexeme::String;
+					i += 1;
+					break;
+
+				case Lexeme::Number:
+					if (!isNumberChar(c))
+					{
+						completeNumber();
+						continue;
+					}
+
+					_buffer.push_back(c);
+					i += 1;
+					break;
+
+				case Lexeme::Literal:
+					if (_literal[_literalPos] == '\0')
+					{
+						if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+							unexpected(c);
+
+						completeLiteral();
+						continue;
+					}
+
+					if (c != _literal[_literalPos])
+						unexpected(c);
+
+					_literalPos += 1;
+					i += 1;
+					break;
+
+				case Lexeme::Slash:
+					if (c == '/')
+						_lexeme = Lexeme::LineComment;
+					else if (c == '*')
+						_lexeme = Lexeme::BlockComment;
+					else
+						unexpected(c);
+
+					i += 1;
+					break;
+
+				case Lexeme::LineComment:
+					if (c == '\n')
+						_lexeme = Lexeme::None;
+
+					i += 1;
+					break;
+
+				case Lexeme::BlockComment:
+					if (c == '*')
+						_lexeme = Lexeme::BlockCommentEnd;
+
+					i += 1;
+					break;
+
+				case Lexeme::BlockCommentEnd:
+					if (c == '/')
+						_lexeme = Lexeme::None;
+					else if (c != '*')
+						_lexeme = Lexeme::BlockComment;
+
+					i += 1;
+					break;
+				}
+
+				_offset += 1;
+			}
+		}
+
+		void feed(std::string_view data) { feed(data.data(), data.size()); }
+
+		// Signals the end of input. Numbers and literals that ended the input are
+		// only reported here, since more digits could otherwise still arrive.
+		void finish()
+		{
+			if (_lexeme == Lexeme::Number)
+				completeNumber();
+			else if (_lexeme == Lexeme::Literal && _literal[_literalPos] == '\0')
+				completeLiteral();
+			else if (_lexeme == Lexeme::LineComment)
+				_lexeme = Lexeme::None;
+
+			if (_lexeme != Lexeme::None || _expect != Expect::Done)
+				throw std::runtime_error("Unexpected end of file.");
+		}
+
+		void reset()
+		{
+			_containers.clear();
+			_buffer.clear();
+			_literal = nullptr;
+			_literalPos = 0;
+			_offset = 0;
+			_expect = Expect::Value;
+			_lexeme = Lexeme::None;
+			_isKey = false;
+		}
+
+		size_t depth() const { return _containers.size(); }
+		bool isComplete() const { return _expect == Expect::Done && _lexeme == Lexeme::None; }
+		const auto& offset() const { return _offset; }
+	};
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef HIRZEL_JSON_JSON_QUERY_HPP
+#define HIRZEL_JSON_JSON_QUERY_HPP
+
+#include <hirzel/json/Cursor.hpp>
+#include <hirzel/json/Document.hpp>
+#include <hirzel/json/Value.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * Compiled JSONPath expression. The supported subset is
+	 *
+	 *     $                 the root
+	 *     .name ['name']    a member
+	 *     [3]               an array element
+	 *     .* [*]            every member or element
+	 *     ..name ..* ..[i]  the same, applied at any depth
+	 *     [?(@.a.b == 'x')] elements or members whose relative path compares
+	 *                       to a string, number, boolean or null literal with
+	 *                       == != < <= > >=, or [?(@.a)] for existence
+	 *
+	 * Queries run either over a Value or over a Cursor, in which case they walk
+	 * the token stream directly: subtrees that cannot match are skipped without
+	 * being parsed and matches are returned as cursors, whose raw() is the
+	 * span of the match in the source.
+	 */
+	class Query
+	{
+	public:
+
+		enum class StepType : uint8_t
+		{
+			Name,
+			Index,
+			Wildcard,
+			Filter
+		};
+
+		enum class Comparison : uint8_t
+		{
+			Exists,
+			Equal,
+			NotEqual,
+			Less,
+			LessEqual,
+			Greater,
+			GreaterEqual
+		};
+
+		struct Step
+		{
+			StepType type;
+			// Applies the step to the node and to all of its descendants
+			bool isRecursive;
+			uint32_t hash;
+			std::string name;
+			// Array index, or the position in filters() of a Filter step
+			size_t index;
+		};
+
+		struct Filter
+		{
+			std::vector<Step> path;
+			Comparison comparison;
+			Value literal;
+		};
+
+	private:
+
+		class Parser;
+
+		std::string _text;
+		std::vector<Step> _steps;
+		std::vector<Filter> _filters;
+
+	private:
+
+		template <typename Node, typename Match>
+		void selectFrom(const Node& node, size_t step, size_t depth, std::vector<Match>& out) const;
+		template <typename Node, typename Match>
+		void applyStep(const Node& node, size_t step, size_t depth, std::vector<Match>& out) const;
+		template <typename Node, typename Match>
+		void selectDescendants(const Node& node, size_t step, size_t depth, std::vector<Match>& out) const;
+		template <typename Node>
+		bool isMatch(const Step& step, const Node& child, std::string_view key, size_t index, std::string& buffer) const;
+		template <typename Node>
+		bool matches(const Node& node, const Filter& filter, std::string& buffer) const;
+
+	public:
+
+		explicit Query(std::string_view text);
+		explicit Query(const std::string& text) : Query(std::string_view(text)) {}
+		explicit Query(const char* text) : Query(std::string_view(text)) {}
+
+		// Matches are appended to out as the walk reaches them. A descendant
+		// step visits nodes in document order, so $..name returns its matches
+		// in document order too. Nesting deeper than maxParseDepth throws.
+		void select(const Value& root, std::vector<const Value*>& out) const;
+		void select(const Cursor& root, std::vector<Cursor>& out) const;
+		std::vector<const Value*> select(const Value& root) const;
+		std::vector<Cursor> select(const Cursor& root) const;
+		std::vector<Cursor> select(const Document& document) const { return select(document.root()); }
+
+		const auto& text() const { return _text; }
+		const auto& steps() const { return _steps; }
+		const auto& filters() const { return _filters; }
+	};
+}
+
+#endif
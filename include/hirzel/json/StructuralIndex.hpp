@@ -0,0 +1,40 @@
+#ifndef HIRZEL_JSON_JSON_STRUCTURAL_INDEX_HPP
+#define HIRZEL_JSON_JSON_STRUCTURAL_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace hirzel::json
+{
+	/*
+	 * First parsing stage: classifies the input 64 bytes at a time and records
+	 * the start of every token. The last position is always the terminating
+	 * NUL so that tokenizing ends with EndOfFile. Positions take four bytes
+	 * each, and the buffer grows with the tokens found instead of being sized
+	 * up front for a token at every byte of the input.
+	 */
+	class StructuralIndex
+	{
+		std::unique_ptr<uint32_t[]> _positions;
+		size_t _capacity = 0;
+		size_t _count = 0;
+
+	private:
+
+		void reserve(size_t capacity);
+
+	public:
+
+		bool build(const char* src, size_t length);
+		void clear() { _count = 0; }
+
+		static const char* implementationName();
+
+		const uint32_t* positions() const { return _positions.get(); }
+		const auto& count() const { return _count; }
+		bool isEmpty() const { return _count == 0; }
+	};
+}
+
+#endif
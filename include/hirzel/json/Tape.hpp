@@ -0,0 +1,106 @@
+#ifndef HIRZEL_JSON_JSON_TAPE_HPP
+#define HIRZEL_JSON_JSON_TAPE_HPP
+
+#include <hirzel/json/MappedFile.hpp>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hirzel::json
+{
+	class TapeValue;
+
+	/*
+	 * Immutable document stored as a flat array of 64-bit words and a string
+	 * buffer. Each word holds a tag in its top byte and a payload below it:
+	 *
+	 *     null, true, false   no payload
+	 *     number              followed by a word holding the double's bits
+	 *     string              offset of its length-prefixed, null-terminated
+	 *                         text in the string buffer; keys are strings too
+	 *     start of container  bits 0-31: index just past its end word,
+	 *                         bits 32-55: its size, saturated at maxCount
+	 *     end of container    index of its start word
+	 *
+	 * A saved tape is the words and strings behind a small header, so loading
+	 * it maps the file and reads values straight out of the mapping. Tapes
+	 * are stored in the byte order of the machine that wrote them.
+	 */
+	class Tape
+	{
+	public:
+
+		enum class Tag : uint8_t
+		{
+			Null = 'n',
+			True = 't',
+			False = 'f',
+			Number = 'd',
+			String = '\"',
+			StartArray = '[',
+			EndArray = ']',
+			StartObject = '{',
+			EndObject = '}'
+		};
+
+		static constexpr uint32_t version = 1;
+		static constexpr uint64_t maxCount = 0xFFFFFF;
+
+	private:
+
+		std::vector<uint64_t> _wordStorage;
+		std::vector<char> _stringStorage;
+		std::optional<MappedFile> _file;
+		const uint64_t* _words;
+		size_t _wordCount;
+		const char* _strings;
+		size_t _stringLength;
+
+	private:
+
+		Tape();
+
+	public:
+
+		Tape(const char* json);
+		Tape(const char* json, size_t length);
+		Tape(const std::string& json);
+		Tape(Tape&&) = default;
+		Tape(const Tape&) = delete;
+
+		Tape& operator=(Tape&&) = default;
+		Tape& operator=(const Tape&) = delete;
+
+		// Maps a file written by save. The contents are trusted beyond checking
+		// the header against the file size.
+		static Tape load(const std::string& filepath);
+		void write(std::ostream& out) const;
+		void save(const std::string& filepath) const;
+
+		TapeValue root() const;
+
+		static Tag tagOf(uint64_t word) { return (Tag)(word >> 56); }
+		static uint64_t payloadOf(uint64_t word) { return word & 0x00FFFFFFFFFFFFFF; }
+
+		std::string_view stringAt(size_t offset) const
+		{
+			uint32_t length;
+
+			std::memcpy(&length, _strings + offset, sizeof(length));
+
+			return std::string_view(_strings + offset + sizeof(length), length);
+		}
+
+		const uint64_t& operator[](size_t index) const { return _words[index]; }
+		const auto* words() const { return _words; }
+		const auto& wordCount() const { return _wordCount; }
+		const auto& stringLength() const { return _stringLength; }
+		bool isMapped() const { return _file.has_value(); }
+	};
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef HIRZEL_JSON_JSON_TAPE_VALUE_HPP
+#define HIRZEL_JSON_JSON_TAPE_VALUE_HPP
+
+#include <hirzel/json/Tape.hpp>
+#include <hirzel/json/Value.hpp>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace hirzel::json
+{
+	/*
+	 * Read-only view of a value in a Tape, with the same accessors as
+	 * Value. Strings view the tape, so the tape must outlive them and the view.
+	 * Containers know where they end, so skipping over one takes a single step.
+	 */
+	class TapeValue
+	{
+		const Tape* _tape;
+		size_t _index;
+
+	private:
+
+		uint64_t word() const { return (*_tape)[_index]; }
+		Tape::Tag tag() const { return Tape::tagOf(word()); }
+		// Index of the value after this one in the same container
+		size_t next() const;
+
+	public:
+
+		TapeValue(const Tape& tape, size_t index);
+
+		ValueType type() const;
+		bool isNull() const { return tag() == Tape::Tag::Null; }
+		bool isNumber() const { return tag() == Tape::Tag::Number; }
+		bool isBoolean() const { return tag() == Tape::Tag::True || tag() == Tape::Tag::False; }
+		bool isString() const { return tag() == Tape::Tag::String; }
+		bool isArray() const { return tag() == Tape::Tag::StartArray; }
+		bool isObject() const { return tag() == Tape::Tag::StartObject; }
+
+		double number() const;
+		bool boolean() const;
+		std::string_view string() const;
+		// Members or elements of containers, characters of strings, else 0
+		size_t length() const;
+		Value value() const;
+
+		std::optional<TapeValue> at(size_t i) const;
+		std::optional<TapeValue> at(std::string_view key) const;
+		TapeValue operator[](size_t i) const;
+		TapeValue operator[](std::string_view key) const;
+
+		template <typename Callback>
+		void forEachElement(Callback&& callback) const
+		{
+			if (!isArray())
+				throw std::runtime_error("Value is not an array.");
+
+			auto end = (size_t)(Tape::payloadOf(word()) & 0xFFFFFFFF) - 1;
+
+			for (auto element = TapeValue(*_tape, _index + 1); element._index < end; element._index = element.next())
+				callback(element);
+		}
+
+		template <typename Callback>
+		void forEachMember(Callback&& callback) const
+		{
+			if (!isObject())
+				throw std::runtime_error("Value is not an object.");
+
+			auto end = (size_t)(Tape::payloadOf(word()) & 0xFFFFFFFF) - 1;
+
+			for (auto index = _index + 1; index < end; )
+			{
+				auto member = TapeValue(*_tape, index + 1);
+
+				callback(_tape->stringAt(Tape::payloadOf((*_tape)[index])), member);
+				index = member.next();
+			}
+		}
+
+		const auto& index() const { return _index; }
+	};
+}
+
+#endif
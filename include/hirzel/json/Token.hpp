@@ -3,32 +3,56 @@
 
 #include "hirzel/primitives.hpp"
 #include "hirzel/json/TokenType.hpp"
+#include "hirzel/json/ParseError.hpp"
 #include <string>
 
 namespace hirzel::json
 {
+	class StructuralIndex;
+
 	class Token
 	{
 		const char* _src;
+		const uint32_t* _structural;
 		size_t _pos;
 		size_t _length;
+		// Tokens stop here even if src goes on, as a line of NDJSON does
+		size_t _srcLength;
 		TokenType _type;
+		ParseError _error;
 
 	public:
 
 		Token(const char* src, size_t pos, size_t length, TokenType type);
+		static Token invalid(const char* src, size_t pos, ParseError error);
 		Token(Token&&) = default;
 		Token(const Token&) = default;
 
 		static Token initialFor(const char* src);
+		static Token initialFor(const char* src, const StructuralIndex& index);
+		static Token initialFor(const char* src, size_t length, StructuralIndex& index);
+		// Same as initialFor, but returns an Invalid token instead of throwing
+		static Token tryInitialFor(const char* src, size_t length, StructuralIndex& index);
 
 		void seekNext();
+		// Same as seekNext, but returns false and becomes Invalid instead of throwing
+		bool trySeekNext();
+		void throwIfInvalid() const;
+		// Skips past the current value and returns the offset just after it.
+		// Only brackets are matched, so malformed values are skipped too.
+		size_t skipValue();
+		// Skips past the current value, checking it as deserialize would.
+		// Returns false at the first error, or past maxParseDepth counting
+		// from depth. Escapes are decoded into buffer to check them.
+		bool trySkipValidValue(std::string& buffer, size_t depth = 0);
 		std::string text() const;
+		double number() const;
 
 		const auto* src() const { return _src; }
 		const auto& pos() const { return _pos; }
 		const auto& length() const { return _length; }
 		const auto& type() const { return _type; }
+		const auto& error() const { return _error; }
 	};
 }
 
@@ -16,7 +16,9 @@ namespace hirzel::json
 		True,
 		False,
 		Null,
-		EndOfFile
+		EndOfFile,
+		// Tokenizing failed; Token::error() says why
+		Invalid
 	};
 }
 
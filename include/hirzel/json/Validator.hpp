@@ -0,0 +1,123 @@
+#ifndef HIRZEL_JSON_JSON_VALIDATOR_HPP
+#define HIRZEL_JSON_JSON_VALIDATOR_HPP
+
+#include <hirzel/json/Token.hpp>
+#include <hirzel/json/Value.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * Compiled validation format. The format language is
+	 *
+	 *     #          integer            %          number
+	 *     $          string             &          boolean
+	 *     #[0,10)    bounds, inclusive with [] and exclusive with (), where
+	 *     %(~,1]     ~ is the limit of the type
+	 *     {a:#,b:$}  object with at least these members
+	 *     [#,$]      array of exactly these elements
+	 *     [$,#...]   array whose last element repeats any number of times
+	 *     ?          after any of the above, null is accepted as well and
+	 *                the member may be missing
+	 *
+	 * The format is compiled once into a flat program: one instruction per
+	 * type, with the members or elements of containers listed in children().
+	 * Checking runs the program without allocating or describing failures;
+	 * errors() runs it again to say what failed and where. Text can be checked
+	 * straight from its tokens, skipping members the format does not mention.
+	 */
+	class Validator
+	{
+	public:
+
+		enum class Check : uint8_t
+		{
+			Integer,
+			Number,
+			String,
+			Boolean,
+			Object,
+			Array
+		};
+
+		struct Instruction
+		{
+			Check check;
+			bool isNullable;
+			bool isMinExclusive;
+			bool isMaxExclusive;
+			// The last element of an array repeats any number of times
+			bool isVariadic;
+			double min;
+			double max;
+			// Members of an object or elements of an array, as positions in children()
+			uint32_t firstChild;
+			uint32_t childCount;
+			// Set on the members of an object
+			uint32_t hash;
+			std::string key;
+		};
+
+		// Which members of an object have been read so far. The first 64 fit
+		// in a mask, so only very large objects allocate.
+		class SeenMembers
+		{
+			uint64_t _mask = 0;
+			std::vector<bool> _rest;
+
+		public:
+
+			void mark(size_t i);
+			// Whether every member that may not be missing has been seen
+			bool isComplete(const Validator& validator, const Instruction& object) const;
+		};
+
+	private:
+
+		class Parser;
+		struct Report;
+
+		std::string _format;
+		std::vector<Instruction> _program;
+		std::vector<uint32_t> _children;
+
+	private:
+
+		bool checkValue(const Instruction& instruction, const Value& value, Report* report) const;
+		bool checkToken(const Instruction& instruction, Token& token, std::string& buffer) const;
+
+	public:
+
+		explicit Validator(std::string_view format);
+		explicit Validator(const std::string& format) : Validator(std::string_view(format)) {}
+		explicit Validator(const char* format) : Validator(std::string_view(format)) {}
+
+		bool isValid(const Value& value) const;
+		// Malformed text is invalid rather than an error
+		bool isValidJson(const char* json, size_t length) const;
+		bool isValidJson(const char* json) const;
+		bool isValidJson(const std::string& json) const;
+		// One message per failure, each starting with the JSON pointer of the
+		// value that failed. Empty when the value is valid.
+		std::vector<std::string> errors(const Value& value) const;
+
+		const Instruction& root() const { return _program[0]; }
+		const Instruction& child(const Instruction& parent, size_t i) const { return _program[_children[parent.firstChild + i]]; }
+		// Instruction for element i of an array, or nullptr if there can be no such element
+		const Instruction* element(const Instruction& array, size_t i) const;
+		// Position of the member with this key among the children of an
+		// object, or its childCount if the format does not mention it
+		size_t findMember(const Instruction& object, std::string_view key, uint32_t hash) const;
+		static bool isInRange(const Instruction& instruction, double number);
+		static const char* describe(Check check);
+
+		const auto& format() const { return _format; }
+		const auto& program() const { return _program; }
+		const auto& children() const { return _children; }
+	};
+}
+
+#endif
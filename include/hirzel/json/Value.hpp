@@ -2,7 +2,12 @@
 #define HIRZEL_JSON_JSON_VALUE_HPP
 
 #include <hirzel/json/ValueType.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <iostream>
@@ -12,22 +17,110 @@
 namespace hirzel::json
 {
 	class Value;
+	class Arena;
+	class Object;
+	class Pointer;
 
-	using Object = std::unordered_map<std::string, Value>;
-	using Array = std::vector<Value>;
+	/*
+	 * Arrays, like objects, take a std::pmr::memory_resource so that an Arena
+	 * can hold them. This deliberately changes the type from std::vector<Value>:
+	 * arrays made without a resource still use the heap, but code that names
+	 * std::vector<Value> must name Array instead or convert with Value::from.
+	 */
+	using Array = std::pmr::vector<Value>;
 
+	/*
+	 * Owned strings, arrays and objects are shared between copies of a value
+	 * and only copied when one of them is changed, so copying a value takes
+	 * constant time however large it is. Copies may be read and destroyed on
+	 * different threads at once, like copies of a std::shared_ptr.
+	 *
+	 * Non-const accessors make the payload unique before returning it, so a
+	 * reference they return must not be used after the value is copied.
+	 */
 	class Value
 	{
-		ValueType _type;
+		enum class Storage : uint8_t
+		{
+			// Payload is on the heap, behind a count of the values sharing it
+			Owned,
+			// Payload belongs to an arena and is released with it
+			Borrowed,
+			// Arena array or object handed out for changes, which may have been
+			// given values that own memory, so it is destroyed in place
+			Adopting,
+			// Owned payload holding object keys borrowed from a KeyPool, which
+			// is never shared so that copies own their keys
+			Pooled,
+			// String characters are stored in the value itself
+			Inline
+		};
+
+		// Both layouts begin with the type and storage, so those can be read
+		// through either one regardless of which is active.
+		struct Data
+		{
+			ValueType type;
+			Storage storage;
+			uint32_t length;
+			union
+			{
+				bool boolean;
+				double number;
+				std::string* string;
+				const char* chars;
+				Array* array;
+				Object* object;
+			};
+		};
+
+		struct InlineString
+		{
+			ValueType type;
+			Storage storage;
+			uint8_t length;
+			char chars[sizeof(Data) - 3];
+		};
+
 		union
 		{
-			bool _boolean;
-			double _number;
-			std::string* _string;
-			Array* _array;
-			Object* _object;
+			Data _data;
+			InlineString _inline;
 		};
 
+		friend class Arena;
+		friend class KeyPool;
+
+		using References = std::atomic<size_t>;
+
+		// Keeps payloads as aligned as operator new would
+		static constexpr size_t referencesSize = alignof(std::max_align_t);
+
+	private:
+
+		void initString(std::string_view text);
+		// Gives this value its own copy of a payload it shares with others
+		void unshareSlow();
+
+		template <typename T, typename... Arguments>
+		static T* createShared(Arguments&&... arguments);
+		template <typename T>
+		static void release(T* payload);
+
+		static References& referencesOf(const void* payload)
+		{
+			return *std::launder((References*)((char*)const_cast<void*>(payload) - referencesSize));
+		}
+
+		// Readies a payload for changes through a non-const accessor
+		void unshare(const void* payload)
+		{
+			if (_data.storage == Storage::Owned && referencesOf(payload).load(std::memory_order_acquire) != 1)
+				unshareSlow();
+			else if (_data.storage == Storage::Borrowed)
+				_data.storage = Storage::Adopting;
+		}
+
 	public:
 
 		Value();
@@ -68,59 +161,75 @@ namespace hirzel::json
 			return out;
 		}
 
+		// Defined in Object.hpp, where Object is complete
 		template <typename T>
-		static Value from(const std::unordered_map<std::string, T>& object)
-		{
-			Object out;
+		static Value from(const std::unordered_map<std::string, T>& object);
 
-			for (const auto& pair : object)
-				out[pair.first] = pair.second;
+		// Strings up to this length are stored inline instead of on the heap
+		static constexpr size_t inlineCapacity = sizeof(InlineString::chars);
 
-			return out;
-		}
+		double& number() { assert(_data.type == ValueType::Number); return _data.number; }
+		const double& number() const { assert(_data.type == ValueType::Number); return _data.number; }
 
-		double& number() { assert(_type == ValueType::Number); return _number; }
-		const double& number() const { assert(_type == ValueType::Number); return _number; }
+		bool& boolean() { assert(_data.type == ValueType::Boolean); return _data.boolean; }
+		const bool& boolean() const { assert(_data.type == ValueType::Boolean); return _data.boolean; }
 
-		bool& boolean() { assert(_type == ValueType::Boolean); return _boolean; }
-		const bool& boolean() const { assert(_type == ValueType::Boolean); return _boolean; }
+		// Inline and borrowed strings are first copied to the heap, so the
+		// const overload is the one to read with
+		std::string& string();
+		std::string_view string() const
+		{
+			assert(_data.type == ValueType::String);
+
+			switch (_data.storage)
+			{
+			case Storage::Inline:
+				return std::string_view(_inline.chars, _inline.length);
 
-		std::string& string() { assert(_type == ValueType::String); return *_string; }
-		const std::string& string() const { assert(_type == ValueType::String); return *_string; }
+			case Storage::Borrowed:
+				return std::string_view(_data.chars, _data.length);
+
+			default:
+				return std::string_view(*_data.string);
+			}
+		}
 
-		auto& array() { assert(_type == ValueType::Array); return *_array; }
-		const auto& array() const { assert(_type == ValueType::Array); return *_array; }
+		auto& array() { assert(_data.type == ValueType::Array); unshare(_data.array); return *_data.array; }
+		const auto& array() const { assert(_data.type == ValueType::Array); return *_data.array; }
 
-		auto& object() { assert(_type == ValueType::Object); return *_object; }
-		const auto& object() const { assert(_type == ValueType::Object); return *_object; }
+		auto& object() { assert(_data.type == ValueType::Object); unshare(_data.object); return *_data.object; }
+		const auto& object() const { assert(_data.type == ValueType::Object); return *_data.object; }
 
 		int64_t asInteger() const;
 		double asDecimal() const;
 		bool asBoolean() const;
 		std::string	asString() const;
 
-		bool contains(const std::string& key) const
-		{
-			return _type == ValueType::Object ?
-				_object->find(key) != _object->end() :
-				false;
-		}
+		bool contains(const std::string& key) const { return at(key) != nullptr; }
 
 		bool isEmpty() const;
-		bool isNull() const { return _type == ValueType::Null; }
-		bool isDecimal() const { return _type == ValueType::Number; }
-		bool isNumber() const { return _type == ValueType::Number; }
-		bool isBoolean() const { return _type == ValueType::Boolean; }
-		bool isString() const { return _type == ValueType::String; }
-		bool isArray() const { return _type == ValueType::Array; }
-		bool isObject() const { return _type == ValueType::Object; }
+		bool isNull() const { return _data.type == ValueType::Null; }
+		bool isDecimal() const { return _data.type == ValueType::Number; }
+		bool isNumber() const { return _data.type == ValueType::Number; }
+		bool isBoolean() const { return _data.type == ValueType::Boolean; }
+		bool isString() const { return _data.type == ValueType::String; }
+		bool isArray() const { return _data.type == ValueType::Array; }
+		bool isObject() const { return _data.type == ValueType::Object; }
 
 		size_t length() const;
-		const auto& type() const { return _type; }
+		const auto& type() const { return _data.type; }
+		bool isBorrowed() const { return _data.storage == Storage::Borrowed || _data.storage == Storage::Adopting; }
+		bool isInline() const { return _data.storage == Storage::Inline; }
+		bool isPooled() const { return _data.storage == Storage::Pooled; }
+		// Whether another value refers to the same string, array or object
+		bool isShared() const;
 		const char* typeName() const noexcept;
 
 		Value& operator=(Value&& other);
 		Value& operator=(const Value& other);
+		// Makes this a string, reusing the characters it already holds if
+		// they are its own and have room
+		void assign(std::string_view text);
 
 		Value *at(size_t i);
 		const Value *at(size_t i) const;
@@ -132,6 +241,9 @@ namespace hirzel::json
 		Value& operator[](const std::string& key);
 		const Value& operator[](const std::string& key) const;
 
+		Value *at(const Pointer& pointer);
+		const Value *at(const Pointer& pointer) const;
+
 		bool operator==(const Value& other) const;
 		bool operator!=(const Value& other) const { return !(*this == other); }
 
@@ -139,4 +251,7 @@ namespace hirzel::json
 	};
 }
 
+// Object holds Values by value, so it can only be defined once Value is complete
+#include <hirzel/json/Object.hpp>
+
 #endif
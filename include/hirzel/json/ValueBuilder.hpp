@@ -0,0 +1,46 @@
+#ifndef HIRZEL_JSON_JSON_VALUE_BUILDER_HPP
+#define HIRZEL_JSON_JSON_VALUE_BUILDER_HPP
+
+#include <hirzel/json/Value.hpp>
+#include <string_view>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * Event handler that assembles a Value, for use with EventParser or
+	 * PushParser when the whole document is wanted rather than its events.
+	 */
+	class ValueBuilder
+	{
+		std::vector<Value> _containers;
+		std::vector<std::string> _keys;
+		Value _result;
+		bool _isComplete;
+
+	private:
+
+		void add(Value&& value);
+
+	public:
+
+		ValueBuilder();
+
+		void onNull() { add(Value()); }
+		void onBoolean(bool value) { add(Value(value)); }
+		void onNumber(double value) { add(Value(value)); }
+		void onString(std::string_view value) { add(Value(std::string(value))); }
+		void onKey(std::string_view key) { _keys.emplace_back(key); }
+		void onStartObject() { _containers.emplace_back(ValueType::Object); }
+		void onStartArray() { _containers.emplace_back(ValueType::Array); }
+		void onEndObject() { onEnd(); }
+		void onEndArray() { onEnd(); }
+		void onEnd();
+
+		Value take();
+
+		bool isComplete() const { return _isComplete; }
+	};
+}
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef HIRZEL_JSON_JSON_VALUE_TYPE_HPP
 #define HIRZEL_JSON_JSON_VALUE_TYPE_HPP
 
+#include <cstdint>
+
 namespace hirzel::json
 {
-	enum class ValueType
+	enum class ValueType : uint8_t
 	{
 		Null,
 		Number,
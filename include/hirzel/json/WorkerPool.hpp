@@ -0,0 +1,53 @@
+#ifndef HIRZEL_JSON_JSON_WORKER_POOL_HPP
+#define HIRZEL_JSON_JSON_WORKER_POOL_HPP
+
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * Threads running one function for the length of a single call. When the
+	 * function throws on a worker, cancel is called so the others can return
+	 * early, and join() rethrows the exception on the calling thread. If the
+	 * pool is destroyed without join(), as when the calling thread throws, it
+	 * cancels and joins the workers. Failing to start a thread does the same
+	 * for those already started before the error propagates.
+	 */
+	class WorkerPool
+	{
+	public:
+
+		using Function = std::function<void()>;
+
+	private:
+
+		Function _work;
+		Function _cancel;
+		std::vector<std::thread> _threads;
+		std::exception_ptr _error;
+		std::mutex _mutex;
+
+	private:
+
+		void run();
+		void stop();
+
+	public:
+
+		// cancel may be called from any thread, more than once
+		WorkerPool(size_t threadCount, Function work, Function cancel);
+		WorkerPool(WorkerPool&&) = delete;
+		WorkerPool(const WorkerPool&) = delete;
+		~WorkerPool();
+
+		// Waits for every worker to return and rethrows the first exception
+		// any of them threw
+		void join();
+	};
+}
+
+#endif
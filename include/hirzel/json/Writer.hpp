@@ -0,0 +1,83 @@
+#ifndef HIRZEL_JSON_JSON_WRITER_HPP
+#define HIRZEL_JSON_JSON_WRITER_HPP
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace hirzel::json
+{
+	/*
+	 * Contiguous output buffer for the serializer. It either owns a buffer that
+	 * grows as needed, fills a caller-provided buffer and records whether the
+	 * output did not fit, or flushes to a stream whenever its buffer fills.
+	 */
+	class Writer
+	{
+		std::unique_ptr<char[]> _storage;
+		std::ostream* _stream;
+		char* _data;
+		size_t _length;
+		size_t _capacity;
+		size_t _fixedCapacity;
+		bool _isFixed;
+		bool _isOverflowed;
+
+	private:
+
+		bool reserveSlow(size_t size);
+
+	public:
+
+		Writer(size_t initialCapacity = 4096);
+		Writer(char* data, size_t capacity);
+		Writer(std::ostream& stream, size_t bufferSize = 64 * 1024);
+		Writer(Writer&&) = delete;
+		Writer(const Writer&) = delete;
+		~Writer();
+
+		// Makes room for size more bytes. Only fails for a caller-provided
+		// buffer, after which every write is dropped.
+		bool reserve(size_t size)
+		{
+			return _length + size <= _capacity || reserveSlow(size);
+		}
+
+		void write(const char* data, size_t length)
+		{
+			if (!reserve(length))
+				return;
+
+			std::memcpy(_data + _length, data, length);
+			_length += length;
+		}
+
+		void write(std::string_view text) { write(text.data(), text.length()); }
+
+		void put(char c)
+		{
+			if (!reserve(1))
+				return;
+
+			_data[_length] = c;
+			_length += 1;
+		}
+
+		// Starts a new line indented by depth tabs
+		void newline(size_t depth);
+
+		void flush();
+		void clear();
+
+		std::string_view view() const { return std::string_view(_data, _length); }
+		std::string str() const { return std::string(_data, _length); }
+
+		const char* data() const { return _data; }
+		const auto& length() const { return _length; }
+		const auto& isOverflowed() const { return _isOverflowed; }
+	};
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef HIRZEL_JSON_JSON_BINARY_HPP
+#define HIRZEL_JSON_JSON_BINARY_HPP
+
+#include <hirzel/json/Arena.hpp>
+#include <hirzel/json/Value.hpp>
+#include <hirzel/json/Writer.hpp>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace hirzel::json
+{
+	// Numbers are written with the smallest integer or float encoding that
+	// holds them exactly and are read back as doubles, so integers beyond 2^53
+	// lose precision. Binary data decodes to a string of its bytes. Map keys
+	// must be strings and MessagePack extension types are not supported.
+	void toMessagePack(Writer& out, const Value& value);
+	void toMessagePack(std::ostream& out, const Value& value);
+	std::string toMessagePack(const Value& value);
+	Value fromMessagePack(std::string_view data);
+	Value fromMessagePack(std::string_view data, Arena& arena);
+	// Strings, binary data and keys refer to data, so it must outlive the result
+	Value fromMessagePackView(std::string_view data, Arena& arena);
+	Value fromMessagePackView(std::string&& data, Arena& arena) = delete;
+
+	// Tags are skipped and their content decoded as is. Undefined decodes
+	// to null and half-precision floats are read but never written.
+	void toCbor(Writer& out, const Value& value);
+	void toCbor(std::ostream& out, const Value& value);
+	std::string toCbor(const Value& value);
+	Value fromCbor(std::string_view data);
+	Value fromCbor(std::string_view data, Arena& arena);
+	Value fromCborView(std::string_view data, Arena& arena);
+	Value fromCborView(std::string&& data, Arena& arena) = delete;
+}
+
+#endif
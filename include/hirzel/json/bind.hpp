@@ -0,0 +1,643 @@
+#ifndef HIRZEL_JSON_JSON_BIND_HPP
+#define HIRZEL_JSON_JSON_BIND_HPP
+
+#include <hirzel/json/StructuralIndex.hpp>
+#include <hirzel/json/Token.hpp>
+#include <hirzel/json/Writer.hpp>
+#include <hirzel/json/string.hpp>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hirzel::json
+{
+	/*
+	 * Reads JSON straight into user types and writes them back out without
+	 * building values in between. A struct is bound by listing its fields:
+	 *
+	 *     namespace hirzel::json
+	 *     {
+	 *         template <>
+	 *         struct Binding<Point>
+	 *         {
+	 *             static constexpr auto fields = std::make_tuple(
+	 *                 field("x", &Point::x),
+	 *                 field("y", &Point::y));
+	 *         };
+	 *     }
+	 *
+	 * Fields may be numbers, booleans, strings, other bound structs, and
+	 * vectors, optionals and string-keyed maps of those. Keys are dispatched
+	 * through a perfect hash of the field names built at compile time, so
+	 * finding a field costs one hash and one comparison. Members missing from
+	 * the input keep their value, unknown members are skipped and empty
+	 * optionals are left out when writing.
+	 */
+	template <typename Owner, typename Member>
+	struct Field
+	{
+		std::string_view name;
+		Member Owner::* member;
+	};
+
+	template <typename Owner, typename Member>
+	constexpr Field<Owner, Member> field(std::string_view name, Member Owner::* member)
+	{
+		return { name, member };
+	}
+
+	template <typename T>
+	struct Binding;
+
+	/*
+	 * Reads and writes one type. Other types, such as enums, can be bound by
+	 * specializing it with the same two functions, built from the helpers
+	 * below. The token is left just past the value that was read.
+	 */
+	template <typename T, typename = void>
+	struct Binder {};
+
+	template <typename T, typename = void>
+	struct IsBindable : std::false_type {};
+
+	template <typename T>
+	struct IsBindable<T, std::void_t<decltype(Binder<T>::read(std::declval<Token&>(), std::declval<T&>(), size_t()))>> : std::true_type {};
+
+	template <typename T>
+	static constexpr bool isBindable = IsBindable<T>::value;
+
+	template <typename T, typename = void>
+	struct IsBound : std::false_type {};
+
+	template <typename T>
+	struct IsBound<T, std::void_t<decltype(Binding<T>::fields)>> : std::true_type {};
+
+	// Checks that the token opens a container and steps inside it. Returns
+	// false, having stepped past it, when the container is empty.
+	bool enterContainer(Token& token, TokenType open, size_t depth);
+	// Steps past the comma after a member or element. Returns false, having
+	// stepped past the container, once its end is reached.
+	bool nextInContainer(Token& token, TokenType close);
+	// Reads a key and the colon after it. Keys without escapes view the
+	// source and others are decoded into buffer.
+	std::string_view readKey(Token& token, std::string& buffer);
+	// Steps past the token if it is null
+	bool readNull(Token& token);
+	bool readBoolean(Token& token);
+	double readNumber(Token& token);
+	// Integers are read exactly rather than through a double
+	int64_t readInteger(Token& token, int64_t min, int64_t max);
+	uint64_t readUnsigned(Token& token, uint64_t max);
+	void readString(Token& token, std::string& out);
+	// Skips a member no field is bound to, checking it as deserialize would
+	void skipValue(Token& token, std::string& buffer, size_t depth);
+
+	void writeNumber(Writer& out, double value);
+	void writeInteger(Writer& out, int64_t value);
+	void writeUnsigned(Writer& out, uint64_t value);
+
+	constexpr size_t ceilPowerOfTwo(size_t value)
+	{
+		size_t out = 1;
+
+		while (out < value)
+			out *= 2;
+
+		return out;
+	}
+
+	constexpr uint32_t hashFieldName(std::string_view name, uint32_t seed)
+	{
+		uint32_t hash = 2166136261u ^ seed;
+
+		for (auto c : name)
+		{
+			hash ^= (uint8_t)c;
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+
+	constexpr uint32_t displaceFieldHash(uint32_t hash, uint32_t displacement)
+	{
+		hash += displacement * 0x9E3779B9u;
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+
+		return hash;
+	}
+
+	/*
+	 * Hash and displace: names are spread over buckets by their hash, and each
+	 * bucket gets the displacement that moves all of its names into free slots.
+	 */
+	template <size_t count>
+	struct FieldLayout
+	{
+		static constexpr size_t bucketCount = ceilPowerOfTwo(count);
+		static constexpr size_t slotCount = ceilPowerOfTwo(count * 2);
+
+		uint32_t seed = 0;
+		std::array<uint32_t, bucketCount> displacements = {};
+		// Index of the field in each slot plus one, or zero when empty
+		std::array<uint8_t, slotCount> slots = {};
+
+		constexpr size_t slotOf(uint32_t hash) const
+		{
+			return displaceFieldHash(hash, displacements[hash & (bucketCount - 1)]) & (slotCount - 1);
+		}
+	};
+
+	template <size_t count>
+	constexpr bool placeFields(FieldLayout<count>& layout, const std::array<std::string_view, count>& names)
+	{
+		constexpr auto bucketCount = FieldLayout<count>::bucketCount;
+		constexpr uint32_t maxDisplacement = 1 << 16;
+		auto hashes = std::array<uint32_t, count>();
+		auto bucketSizes = std::array<size_t, bucketCount>();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			hashes[i] = hashFieldName(names[i], layout.seed);
+			bucketSizes[hashes[i] & (bucketCount - 1)] += 1;
+		}
+
+		// Fullest buckets first, while there is the most room
+		for (auto size = count; size > 0; --size)
+		{
+			for (size_t bucket = 0; bucket < bucketCount; ++bucket)
+			{
+				if (bucketSizes[bucket] != size)
+					continue;
+
+				auto isPlaced = false;
+
+				for (uint32_t displacement = 0; displacement < maxDisplacement && !isPlaced; ++displacement)
+				{
+					layout.displacements[bucket] = displacement;
+					isPlaced = true;
+
+					for (size_t i = 0; i < count && isPlaced; ++i)
+					{
+						if ((hashes[i] & (bucketCount - 1)) != bucket)
+							continue;
+
+						auto& slot = layout.slots[layout.slotOf(hashes[i])];
+
+						if (slot != 0)
+							isPlaced = false;
+						else
+							slot = (uint8_t)(i + 1);
+					}
+
+					if (isPlaced)
+						break;
+
+					for (size_t i = 0; i < count; ++i)
+					{
+						auto& slot = layout.slots[layout.slotOf(hashes[i])];
+
+						if ((hashes[i] & (bucketCount - 1)) == bucket && slot == i + 1)
+							slot = 0;
+					}
+				}
+
+				if (!isPlaced)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	template <size_t count>
+	constexpr FieldLayout<count> layoutFields(const std::array<std::string_view, count>& names)
+	{
+		static_assert(count < 256, "Bound structs are limited to 255 fields.");
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			for (size_t j = i + 1; j < count; ++j)
+			{
+				if (names[i] == names[j])
+					throw std::logic_error("Bound fields must have unique names.");
+			}
+		}
+
+		for (uint32_t seed = 0; seed < 64; ++seed)
+		{
+			auto layout = FieldLayout<count>();
+
+			layout.seed = seed;
+
+			if (placeFields(layout, names))
+				return layout;
+		}
+
+		throw std::logic_error("Failed to find a perfect hash for the field names.");
+	}
+
+	template <typename T>
+	using FieldsOf = std::decay_t<decltype(Binding<T>::fields)>;
+
+	template <typename T, size_t... I>
+	constexpr std::array<std::string_view, sizeof...(I)> fieldNames(std::index_sequence<I...>)
+	{
+		return { std::get<I>(Binding<T>::fields).name... };
+	}
+
+	template <typename T, size_t I>
+	void readField(Token& token, T& out, size_t depth)
+	{
+		auto& member = out.*(std::get<I>(Binding<T>::fields).member);
+
+		Binder<std::remove_reference_t<decltype(member)>>::read(token, member, depth);
+	}
+
+	template <typename T, size_t... I>
+	constexpr auto fieldReaders(std::index_sequence<I...>)
+	{
+		return std::array<void (*)(Token&, T&, size_t), sizeof...(I)> { &readField<T, I>... };
+	}
+
+	template <typename T>
+	struct FieldTable
+	{
+		static constexpr size_t count = std::tuple_size_v<FieldsOf<T>>;
+		static constexpr auto names = fieldNames<T>(std::make_index_sequence<count>());
+		static constexpr auto layout = layoutFields(names);
+		static constexpr auto readers = fieldReaders<T>(std::make_index_sequence<count>());
+
+		// Index of the field with the given name, or count if there is none
+		static size_t find(std::string_view key)
+		{
+			auto slot = layout.slots[layout.slotOf(hashFieldName(key, layout.seed))];
+
+			if (slot == 0 || names[slot - 1] != key)
+				return count;
+
+			return slot - 1;
+		}
+	};
+
+	template <typename T>
+	struct IsOptional : std::false_type {};
+
+	template <typename T>
+	struct IsOptional<std::optional<T>> : std::true_type {};
+
+	template <bool minimized>
+	void writeKey(Writer& out, std::string_view key, size_t depth, bool& isFirst)
+	{
+		if (!isFirst)
+			out.put(',');
+
+		isFirst = false;
+
+		if constexpr (minimized == false)
+			out.newline(depth + 1);
+
+		writeEscaped(out, key);
+
+		if constexpr (minimized == false)
+			out.write(": ", 2);
+		else
+			out.put(':');
+	}
+
+	template <bool minimized>
+	void writeEnd(Writer& out, char close, size_t depth, bool isEmpty)
+	{
+		if constexpr (minimized == false)
+		{
+			if (!isEmpty)
+				out.newline(depth);
+		}
+
+		out.put(close);
+	}
+
+	template <bool minimized, typename T, typename Field>
+	void writeField(Writer& out, const T& value, const Field& field, size_t depth, bool& isFirst)
+	{
+		const auto& member = value.*(field.member);
+		using Member = std::decay_t<decltype(member)>;
+
+		if constexpr (IsOptional<Member>::value)
+		{
+			if (!member)
+				return;
+		}
+
+		writeKey<minimized>(out, field.name, depth, isFirst);
+		Binder<Member>::template write<minimized>(out, member, depth + 1);
+	}
+
+	template <bool minimized, typename T, size_t... I>
+	void writeFields(Writer& out, const T& value, size_t depth, std::index_sequence<I...>)
+	{
+		auto isFirst = true;
+
+		out.put('{');
+		(writeField<minimized>(out, value, std::get<I>(Binding<T>::fields), depth, isFirst), ...);
+		writeEnd<minimized>(out, '}', depth, isFirst);
+	}
+
+	template <typename T>
+	struct Binder<T, std::enable_if_t<IsBound<T>::value>>
+	{
+		static void read(Token& token, T& out, size_t depth)
+		{
+			using Table = FieldTable<T>;
+
+			auto buffer = std::string();
+
+			if (!enterContainer(token, TokenType::LeftBrace, depth))
+				return;
+
+			do
+			{
+				auto index = Table::find(readKey(token, buffer));
+
+				if (index < Table::count)
+					Table::readers[index](token, out, depth + 1);
+				else
+					skipValue(token, buffer, depth + 1);
+			}
+			while (nextInContainer(token, TokenType::RightBrace));
+		}
+
+		template <bool minimized>
+		static void write(Writer& out, const T& value, size_t depth)
+		{
+			writeFields<minimized>(out, value, depth, std::make_index_sequence<FieldTable<T>::count>());
+		}
+	};
+
+	template <>
+	struct Binder<bool>
+	{
+		static void read(Token& token, bool& out, size_t)
+		{
+			out = readBoolean(token);
+		}
+
+		template <bool minimized>
+		static void write(Writer& out, bool value, size_t)
+		{
+			if (value)
+				out.write("true", 4);
+			else
+				out.write("false", 5);
+		}
+	};
+
+	template <typename T>
+	struct Binder<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+	{
+		static void read(Token& token, T& out, size_t)
+		{
+			if constexpr (std::is_signed_v<T>)
+				out = (T)readInteger(token, std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+			else
+				out = (T)readUnsigned(token, std::numeric_limits<T>::max());
+		}
+
+		template <bool minimized>
+		static void write(Writer& out, T value, size_t)
+		{
+			if constexpr (std::is_signed_v<T>)
+				writeInteger(out, value);
+			else
+				writeUnsigned(out, value);
+		}
+	};
+
+	template <typename T>
+	struct Binder<T, std::enable_if_t<std::is_floating_point_v<T>>>
+	{
+		static void read(Token& token, T& out, size_t)
+		{
+			out = (T)readNumber(token);
+		}
+
+		template <bool minimized>
+		static void write(Writer& out, T value, size_t)
+		{
+			writeNumber(out, (double)value);
+		}
+	};
+
+	template <>
+	struct Binder<std::string>
+	{
+		static void read(Token& token, std::string& out, size_t)
+		{
+			readString(token, out);
+		}
+
+		template <bool minimized>
+		static void write(Writer& out, const std::string& value, size_t)
+		{
+			writeEscaped(out, value);
+		}
+	};
+
+	template <typename T>
+	struct Binder<std::optional<T>, std::enable_if_t<isBindable<T>>>
+	{
+		static void read(Token& token, std::optional<T>& out, size_t depth)
+		{
+			if (readNull(token))
+			{
+				out.reset();
+				return;
+			}
+
+			if (!out)
+				out.emplace();
+
+			Binder<T>::read(token, *out, depth);
+		}
+
+		template <bool minimized>
+		static void write(Writer& out, const std::optional<T>& value, size_t depth)
+		{
+			if (value)
+				Binder<T>::template write<minimized>(out, *value, depth);
+			else
+				out.write("null", 4);
+		}
+	};
+
+	template <typename T>
+	struct Binder<std::vector<T>, std::enable_if_t<isBindable<T>>>
+	{
+		// Elements are read into the vector in place, so reading into the same
+		// vector again reuses its capacity
+		static void read(Token& token, std::vector<T>& out, size_t depth)
+		{
+			out.clear();
+
+			if (!enterContainer(token, TokenType::LeftBracket, depth))
+				return;
+
+			do
+			{
+				if constexpr (std::is_same_v<T, bool>)
+				{
+					out.push_back(readBoolean(token));
+				}
+				else
+				{
+					out.emplace_back();
+					Binder<T>::read(token, out.back(), depth + 1);
+				}
+			}
+			while (nextInContainer(token, TokenType::RightBracket));
+		}
+
+		template <bool minimized>
+		static void write(Writer& out, const std::vector<T>& value, size_t depth)
+		{
+			out.put('[');
+
+			for (size_t i = 0; i < value.size(); ++i)
+			{
+				if (i > 0)
+					out.put(',');
+
+				if constexpr (minimized == false)
+					out.newline(depth + 1);
+
+				Binder<T>::template write<minimized>(out, value[i], depth + 1);
+			}
+
+			writeEnd<minimized>(out, ']', depth, value.empty());
+		}
+	};
+
+	template <typename Map>
+	struct MapBinder
+	{
+		using Mapped = typename Map::mapped_type;
+
+		static void read(Token& token, Map& out, size_t depth)
+		{
+			auto buffer = std::string();
+
+			out.clear();
+
+			if (!enterContainer(token, TokenType::LeftBrace, depth))
+				return;
+
+			do
+			{
+				auto& member = out[std::string(readKey(token, buffer))];
+
+				Binder<Mapped>::read(token, member, depth + 1);
+			}
+			while (nextInContainer(token, TokenType::RightBrace));
+		}
+
+		template <bool minimized>
+		static void write(Writer& out, const Map& value, size_t depth)
+		{
+			auto isFirst = true;
+
+			out.put('{');
+
+			for (const auto& pair : value)
+			{
+				writeKey<minimized>(out, pair.first, depth, isFirst);
+				Binder<Mapped>::template write<minimized>(out, pair.second, depth + 1);
+			}
+
+			writeEnd<minimized>(out, '}', depth, isFirst);
+		}
+	};
+
+	template <typename T>
+	struct Binder<std::map<std::string, T>, std::enable_if_t<isBindable<T>>> : MapBinder<std::map<std::string, T>> {};
+
+	template <typename T>
+	struct Binder<std::unordered_map<std::string, T>, std::enable_if_t<isBindable<T>>> : MapBinder<std::unordered_map<std::string, T>> {};
+
+	template <typename T>
+	std::enable_if_t<isBindable<T>> deserializeInto(const char* json, size_t length, T& out)
+	{
+		try
+		{
+			auto index = StructuralIndex();
+			auto token = Token::initialFor(json, length, index);
+
+			Binder<T>::read(token, out, 0);
+
+			if (token.type() != TokenType::EndOfFile)
+				throw std::runtime_error("Unexpected token: '" + token.text() + "'.");
+		}
+		catch (const std::exception& e)
+		{
+			throw std::runtime_error("Failed to deserialize JSON: " + std::string(e.what()));
+		}
+	}
+
+	template <typename T>
+	std::enable_if_t<isBindable<T>> deserializeInto(const char* json, T& out)
+	{
+		deserializeInto(json, std::strlen(json), out);
+	}
+
+	template <typename T>
+	std::enable_if_t<isBindable<T>> deserializeInto(const std::string& json, T& out)
+	{
+		deserializeInto(json.c_str(), json.length(), out);
+	}
+
+	template <typename T>
+	std::enable_if_t<isBindable<T>> serialize(Writer& out, const T& value, bool minimized = false)
+	{
+		if (minimized)
+		{
+			Binder<T>::template write<true>(out, value, 0);
+			return;
+		}
+
+		Binder<T>::template write<false>(out, value, 0);
+	}
+
+	template <typename T>
+	std::enable_if_t<isBindable<T>> serialize(std::ostream& out, const T& value, bool minimized = false)
+	{
+		auto writer = Writer(out);
+
+		serialize(writer, value, minimized);
+		writer.flush();
+	}
+
+	template <typename T>
+	std::enable_if_t<isBindable<T>, std::string> serialize(const T& value, bool minimized = false)
+	{
+		auto writer = Writer();
+
+		serialize(writer, value, minimized);
+
+		return writer.str();
+	}
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef HIRZEL_JSON_JSON_NUMBER_HPP
+#define HIRZEL_JSON_JSON_NUMBER_HPP
+
+#include <cstddef>
+
+namespace hirzel::json
+{
+	// Converts the JSON number in src[0, length) to the nearest double without
+	// allocating or consulting the locale. Returns false if the text is not
+	// exactly one JSON number.
+	bool parseNumber(const char* src, size_t length, double& out);
+
+	// Upper bound on what formatNumber writes, e.g. "-2.2250738585072014e-308"
+	static constexpr size_t maxNumberLength = 32;
+
+	// Writes the shortest text that parses back to exactly the same double and
+	// returns its length. JSON has no infinities or NaN, so those become null.
+	size_t formatNumber(double value, char* out);
+}
+
+#endif
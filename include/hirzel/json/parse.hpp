@@ -0,0 +1,205 @@
+#ifndef HIRZEL_JSON_JSON_PARSE_HPP
+#define HIRZEL_JSON_JSON_PARSE_HPP
+
+#include <hirzel/json/StructuralIndex.hpp>
+#include <hirzel/json/Token.hpp>
+#include <hirzel/json/string.hpp>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace hirzel::json
+{
+	/*
+	 * Walks a document once and reports it to a handler without building any
+	 * values. The handler is a template parameter so every event is a direct
+	 * call. It must provide:
+	 *
+	 *     onNull(), onBoolean(bool), onNumber(double), onString(std::string_view),
+	 *     onKey(std::string_view), onStartObject(), onEndObject(),
+	 *     onStartArray(), onEndArray()
+	 *
+	 * Strings and keys are decoded. They view the source buffer when they contain
+	 * no escapes and are only valid during the call either way.
+	 */
+	template <typename Handler>
+	class EventParser
+	{
+		Token _token;
+		Handler& _handler;
+		std::string _decoded;
+
+	private:
+
+		std::string_view stringContents(const Token& token)
+		{
+			auto text = std::string_view(token.src() + token.pos() + 1, token.length() - 2);
+
+			if (findEscape(text) == text.size())
+				return text;
+
+			unescape(text, _decoded);
+
+			return _decoded;
+		}
+
+		void parseObject(size_t depth)
+		{
+			_handler.onStartObject();
+			_token.seekNext();
+
+			if (_token.type() != TokenType::RightBrace)
+			{
+				while (true)
+				{
+					if (_token.type() != TokenType::String)
+						throw std::runtime_error("Expected label, got '" + _token.text() + "'.");
+
+					_handler.onKey(stringContents(_token));
+					_token.seekNext();
+
+					if (_token.type() != TokenType::Colon)
+						throw std::runtime_error("Expected ':' before '" + _token.text() + "'.");
+
+					_token.seekNext();
+					parseValue(depth);
+
+					if (_token.type() == TokenType::Comma)
+					{
+						_token.seekNext();
+						continue;
+					}
+
+					break;
+				}
+
+				if (_token.type() != TokenType::RightBrace)
+					throw std::runtime_error("Expected '}' before '" + _token.text() + "'.");
+			}
+
+			_handler.onEndObject();
+			_token.seekNext();
+		}
+
+		void parseArray(size_t depth)
+		{
+			_handler.onStartArray();
+			_token.seekNext();
+
+			if (_token.type() != TokenType::RightBracket)
+			{
+				while (true)
+				{
+					parseValue(depth);
+
+					if (_token.type() == TokenType::Comma)
+					{
+						_token.seekNext();
+						continue;
+					}
+
+					break;
+				}
+
+				if (_token.type() != TokenType::RightBracket)
+					throw std::runtime_error("Expected ']' before '" + _token.text() + "'.");
+			}
+
+			_handler.onEndArray();
+			_token.seekNext();
+		}
+
+		void parseValue(size_t depth)
+		{
+			switch (_token.type())
+			{
+				case TokenType::LeftBrace:
+				case TokenType::LeftBracket:
+					// Each level of nesting takes a frame, so the limit keeps the stack bounded
+					if (depth == maxParseDepth)
+						throw std::runtime_error(std::string(describe(ParseError::TooDeep)) + " at pos: " + std::to_string(_token.pos()) + ".");
+
+					if (_token.type() == TokenType::LeftBrace)
+						parseObject(depth + 1);
+					else
+						parseArray(depth + 1);
+
+					return;
+
+				case TokenType::String:
+					_handler.onString(stringContents(_token));
+					break;
+
+				case TokenType::Number:
+					_handler.onNumber(_token.number());
+					break;
+
+				case TokenType::True:
+					_handler.onBoolean(true);
+					break;
+
+				case TokenType::False:
+					_handler.onBoolean(false);
+					break;
+
+				case TokenType::Null:
+					_handler.onNull();
+					break;
+
+				case TokenType::EndOfFile:
+					throw std::runtime_error("Unexpected end of file.");
+
+				default:
+					throw std::runtime_error("Unexpected token: '" + _token.text() + "'.");
+			}
+
+			_token.seekNext();
+		}
+
+	public:
+
+		EventParser(const Token& token, Handler& handler) :
+			_token(token),
+			_handler(handler)
+		{}
+
+		void parse()
+		{
+			parseValue(0);
+
+			if (_token.type() != TokenType::EndOfFile)
+				throw std::runtime_error("Unexpected token: " + _token.text());
+		}
+	};
+
+	template <typename Handler>
+	void parse(const char* json, size_t length, Handler& handler)
+	{
+		try
+		{
+			auto index = StructuralIndex();
+			auto parser = EventParser<Handler>(Token::initialFor(json, length, index), handler);
+
+			parser.parse();
+		}
+		catch (const std::exception& e)
+		{
+			throw std::runtime_error("Failed to parse JSON: " + std::string(e.what()));
+		}
+	}
+
+	template <typename Handler>
+	void parse(const char* json, Handler& handler)
+	{
+		parse(json, std::strlen(json), handler);
+	}
+
+	template <typename Handler>
+	void parse(const std::string& json, Handler& handler)
+	{
+		parse(json.c_str(), json.length(), handler);
+	}
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef HIRZEL_JSON_JSON_STRING_HPP
+#define HIRZEL_JSON_JSON_STRING_HPP
+
+#include <hirzel/json/Writer.hpp>
+#include <hirzel/json/ParseError.hpp>
+#include <string>
+#include <string_view>
+
+namespace hirzel::json
+{
+	// Given the position just past an opening quote in a NUL-terminated buffer,
+	// returns the closing quote, or the terminator if the string never closes.
+	const char* skipString(const char* iter);
+
+	// Position of the first backslash in text, or text.size() if there is none.
+	size_t findEscape(std::string_view text);
+
+	// Decodes the escape sequences in the contents of a string token. Output is
+	// never longer than the input, so out needs room for text.size() bytes.
+	// Throws on malformed escapes; lone surrogates decode to U+FFFD.
+	size_t unescape(std::string_view text, char* out);
+	void unescape(std::string_view text, std::string& out);
+	// Reports malformed escapes and the offset of the backslash in text
+	// instead of throwing
+	ParseError tryUnescape(std::string_view text, std::string& out, size_t& errorOffset);
+
+	// Writes text as a quoted string, escaping quotes, backslashes and control
+	// characters.
+	void writeEscaped(Writer& out, std::string_view text);
+}
+
+#endif
@@ -0,0 +1,1290 @@
+#include <hirzel/json.hpp>
+#include <hirzel/file.hpp>
+#include <hirzel/json/number.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace hirzel::json;
+
+static volatile double sink;
+// Benchmarks with worker threads allocate from several threads at once
+static std::atomic<size_t> allocationCount = 0;
+
+// Kept out of line so that GCC does not pair an inlined free with the
+// operator new of the caller and warn about mismatched deallocation
+[[gnu::noinline]] void* operator new(size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+// The pmr containers allocate through the aligned overloads
+[[gnu::noinline]] void* operator new(size_t size, std::align_val_t alignment)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	auto align = std::max((size_t)alignment, sizeof(void*));
+
+	if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+	std::free(ptr);
+}
+
+template <typename Function>
+size_t countAllocations(Function function)
+{
+	auto before = allocationCount.load();
+
+	function();
+
+	return allocationCount.load() - before;
+}
+
+template <typename Function>
+double measureSeconds(Function function, size_t iterations)
+{
+	auto best = 1e30;
+
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		function();
+
+		auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (elapsed < best)
+			best = elapsed;
+	}
+
+	return best;
+}
+
+void report(const std::string& name, size_t bytes, double seconds)
+{
+	std::cout << std::left << std::setw(40) << name
+		<< std::right << std::fixed << std::setprecision(1) << std::setw(10) << (double)bytes / seconds / 1e6 << " MB/s"
+		<< std::endl;
+}
+
+std::vector<std::string> numberCorpus(const std::string& kind, size_t count)
+{
+	auto random = std::mt19937_64(42);
+	auto numbers = std::vector<std::string>();
+	auto real = std::uniform_real_distribution<double>(-1000.0, 1000.0);
+
+	numbers.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		char buffer[64];
+
+		if (kind == "integers")
+			std::snprintf(buffer, sizeof(buffer), "%lld", (long long)(random() % 2000000) - 1000000);
+		else if (kind == "telemetry")
+			std::snprintf(buffer, sizeof(buffer), "%.6f", real(random));
+		else
+			std::snprintf(buffer, sizeof(buffer), "%.17g", real(random) * std::pow(10.0, (int)(random() % 40) - 20));
+
+		numbers.emplace_back(buffer);
+	}
+
+	return numbers;
+}
+
+// What Token::number used to do: copy to a terminated buffer and call atof
+double parseWithAtof(const char* src, size_t length)
+{
+	char buffer[64];
+
+	std::memcpy(buffer, src, length);
+	buffer[length] = '\0';
+
+	return std::atof(buffer);
+}
+
+void benchNumbers()
+{
+	std::cout << "numbers" << std::endl;
+
+	for (const auto* kind : { "integers", "telemetry", "scientific" })
+	{
+		auto numbers = numberCorpus(kind, 1000000);
+		size_t bytes = 0;
+		auto json = std::string("[");
+
+		for (const auto& number : numbers)
+		{
+			bytes += number.length();
+			json += number;
+			json += ',';
+		}
+
+		json.back() = ']';
+
+		auto atofSeconds = measureSeconds([&]()
+		{
+			double total = 0.0;
+
+			for (const auto& number : numbers)
+				total += parseWithAtof(number.data(), number.length());
+
+			sink = total;
+		}, 5);
+
+		auto parseSeconds = measureSeconds([&]()
+		{
+			double total = 0.0;
+			double value;
+
+			for (const auto& number : numbers)
+			{
+				parseNumber(number.data(), number.length(), value);
+				total += value;
+			}
+
+			sink = total;
+		}, 5);
+
+		auto deserializeSeconds = measureSeconds([&]()
+		{
+			sink = (double)deserialize(json).length();
+		}, 5);
+
+		report(std::string("  ") + kind + " atof", bytes, atofSeconds);
+		report(std::string("  ") + kind + " parseNumber", bytes, parseSeconds);
+		report(std::string("  ") + kind + " deserialize", json.length(), deserializeSeconds);
+	}
+}
+
+void benchNumberFormatting()
+{
+	std::cout << "number formatting" << std::endl;
+
+	for (const auto* kind : { "integers", "telemetry", "scientific" })
+	{
+		auto numbers = numberCorpus(kind, 1000000);
+		auto values = std::vector<double>();
+		auto array = Array();
+
+		for (const auto& number : numbers)
+		{
+			double value;
+
+			parseNumber(number.data(), number.length(), value);
+			values.push_back(value);
+			array.emplace_back(value);
+		}
+
+		size_t fixedBytes = 0;
+		size_t shortestBytes = 0;
+
+		auto fixedSeconds = measureSeconds([&]()
+		{
+			auto out = std::ostringstream();
+
+			for (auto value : values)
+				out << std::fixed << value;
+
+			fixedBytes = out.str().length();
+		}, 3);
+
+		auto shortestSeconds = measureSeconds([&]()
+		{
+			char buffer[maxNumberLength];
+			size_t total = 0;
+
+			for (auto value : values)
+				total += formatNumber(value, buffer);
+
+			shortestBytes = total;
+		}, 3);
+
+		auto document = Value(std::move(array));
+		auto serializeSeconds = measureSeconds([&]()
+		{
+			sink = (double)serialize(document, true).length();
+		}, 3);
+
+		report(std::string("  ") + kind + " ostream fixed", fixedBytes, fixedSeconds);
+		report(std::string("  ") + kind + " formatNumber", shortestBytes, shortestSeconds);
+		report(std::string("  ") + kind + " serialize", (size_t)sink, serializeSeconds);
+		std::cout << "  " << kind << " output bytes fixed/shortest: " << fixedBytes << " / " << shortestBytes << std::endl;
+	}
+}
+
+Value apiResponse(size_t count)
+{
+	auto items = Array();
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto tags = Array();
+
+		tags.emplace_back("alpha");
+		tags.emplace_back("beta");
+
+		items.emplace_back(Object({
+			{ "id", Value(i) },
+			{ "name", Value("user name number " + std::to_string(i)) },
+			{ "email", Value("someone" + std::to_string(i) + "@example.com") },
+			{ "score", Value(i * 0.25) },
+			{ "active", Value(i % 2 == 0) },
+			{ "tags", Value(std::move(tags)) }
+		}));
+	}
+
+	return Value(std::move(items));
+}
+
+void benchSerializeParallel()
+{
+	std::cout << "parallel serialize" << std::endl;
+
+	auto document = apiResponse(500000);
+	auto threadCounts = std::vector<size_t>({ 2, 4 });
+	auto cores = (size_t)std::thread::hardware_concurrency();
+
+	if (cores > 4)
+		threadCounts.push_back(cores);
+
+	for (auto minimized : { false, true })
+	{
+		auto name = std::string(minimized ? "  minimized" : "  pretty");
+		size_t bytes = serialize(document, minimized).length();
+		auto writer = Writer();
+
+		auto sequentialSeconds = measureSeconds([&]()
+		{
+			writer.clear();
+			serialize(writer, document, minimized);
+			sink = (double)writer.length();
+		}, 3);
+
+		report(name + ", 1 thread", bytes, sequentialSeconds);
+
+		for (auto threadCount : threadCounts)
+		{
+			auto parallelSeconds = measureSeconds([&]()
+			{
+				writer.clear();
+				serializeParallel(writer, document, minimized, threadCount);
+				sink = (double)writer.length();
+			}, 3);
+
+			report(name + ", " + std::to_string(threadCount) + " threads", bytes, parallelSeconds);
+		}
+	}
+}
+
+void benchSerialize()
+{
+	std::cout << "serialize" << std::endl;
+
+	auto document = apiResponse(20000);
+
+	for (auto minimized : { false, true })
+	{
+		auto name = std::string(minimized ? "  minimized" : "  pretty");
+		size_t bytes = serialize(document, minimized).length();
+		auto writer = Writer();
+
+		auto stringSeconds = measureSeconds([&]()
+		{
+			sink = (double)serialize(document, minimized).length();
+		}, 5);
+
+		auto writerSeconds = measureSeconds([&]()
+		{
+			writer.clear();
+			serialize(writer, document, minimized);
+			sink = (double)writer.length();
+		}, 5);
+
+		auto streamSeconds = measureSeconds([&]()
+		{
+			auto out = std::ostringstream();
+
+			serialize(out, document, minimized);
+			sink = (double)out.tellp();
+		}, 5);
+
+		report(name + " to string", bytes, stringSeconds);
+		report(name + " to reused writer", bytes, writerSeconds);
+		report(name + " to ostream", bytes, streamSeconds);
+	}
+}
+
+std::string stringCorpus(size_t count)
+{
+	auto random = std::mt19937_64(5);
+	auto json = std::string("[");
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto text = std::string(8 + random() % 64, 'a');
+
+		for (auto& c : text)
+			c = (char)('a' + random() % 26);
+
+		// Roughly one string in ten carries an escape
+		if (random() % 10 == 0)
+			text.insert(random() % text.size(), random() % 2 ? "\\n" : "\\u00e9");
+
+		json += '"' + text + "\",";
+	}
+
+	json.back() = ']';
+
+	return json;
+}
+
+void benchStrings()
+{
+	std::cout << "strings" << std::endl;
+
+	auto json = stringCorpus(200000);
+	auto arena = Arena();
+	auto document = deserialize(json);
+
+	auto heapSeconds = measureSeconds([&]()
+	{
+		sink = (double)deserialize(json).length();
+	}, 5);
+
+	auto arenaSeconds = measureSeconds([&]()
+	{
+		arena.reset();
+		sink = (double)deserialize(json, arena).length();
+	}, 5);
+
+	auto viewSeconds = measureSeconds([&]()
+	{
+		arena.reset();
+		sink = (double)deserializeView(json, arena).length();
+	}, 5);
+
+	auto writer = Writer();
+	auto serializeSeconds = measureSeconds([&]()
+	{
+		writer.clear();
+		serialize(writer, document, true);
+		sink = (double)writer.length();
+	}, 5);
+
+	report("  deserialize", json.length(), heapSeconds);
+	report("  deserialize arena", json.length(), arenaSeconds);
+	report("  deserializeView arena", json.length(), viewSeconds);
+	report("  serialize", json.length(), serializeSeconds);
+}
+
+std::string recordCorpus(size_t count)
+{
+	static const char* statuses[] = { "active", "pending", "closed", "archived" };
+	auto random = std::mt19937_64(11);
+	auto json = std::string("[");
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		char buffer[256];
+
+		std::snprintf(buffer, sizeof(buffer),
+			"{\"id\":\"u%08llu\",\"status\":\"%s\",\"color\":\"#%06llx\",\"region\":\"eu-west-%d\",\"note\":\"a somewhat longer description string\"},",
+			(unsigned long long)i, statuses[random() % 4], (unsigned long long)(random() & 0xFFFFFF), (int)(random() % 3));
+
+		json += buffer;
+	}
+
+	json.back() = ']';
+
+	return json;
+}
+
+void benchShortStrings()
+{
+	std::cout << "short strings" << std::endl;
+
+	auto json = recordCorpus(50000);
+	auto document = deserialize(json);
+
+	auto parseSeconds = measureSeconds([&]()
+	{
+		sink = (double)deserialize(json).length();
+	}, 5);
+
+	auto copySeconds = measureSeconds([&]()
+	{
+		auto copy = document;
+
+		sink = (double)copy.length();
+	}, 5);
+
+	auto parseAllocations = countAllocations([&]()
+	{
+		sink = (double)deserialize(json).length();
+	});
+
+	auto copyAllocations = countAllocations([&]()
+	{
+		auto copy = document;
+
+		sink = (double)copy.length();
+	});
+
+	report("  deserialize", json.length(), parseSeconds);
+	report("  copy", json.length(), copySeconds);
+	std::cout << "  allocations per deserialize: " << parseAllocations
+		<< ", per copy: " << copyAllocations << std::endl;
+}
+
+void benchObjects()
+{
+	std::cout << "objects" << std::endl;
+
+	auto json = serialize(apiResponse(20000), true);
+	auto document = deserialize(json);
+	auto keys = std::vector<std::string>({ "id", "name", "email", "score", "active", "tags", "missing" });
+
+	auto parseSeconds = measureSeconds([&]()
+	{
+		sink = (double)deserialize(json).length();
+	}, 5);
+
+	auto lookupSeconds = measureSeconds([&]()
+	{
+		auto found = (size_t)0;
+
+		for (const auto& item : document.array())
+		{
+			for (const auto& key : keys)
+				found += item.at(key) != nullptr;
+		}
+
+		sink = (double)found;
+	}, 5);
+
+	auto parseAllocations = countAllocations([&]()
+	{
+		sink = (double)deserialize(json).length();
+	});
+
+	auto lookups = document.length() * keys.size();
+
+	report("  deserialize", json.length(), parseSeconds);
+	std::cout << std::left << std::setw(40) << "  lookup"
+		<< std::right << std::fixed << std::setprecision(1) << std::setw(10) << lookupSeconds * 1e9 / (double)lookups << " ns"
+		<< std::endl;
+	std::cout << "  allocations per deserialize: " << parseAllocations << std::endl;
+}
+
+void benchKeyPool()
+{
+	std::cout << "key pool" << std::endl;
+
+	auto messages = std::vector<std::string>();
+	auto bytes = (size_t)0;
+
+	for (size_t i = 0; i < 50000; ++i)
+	{
+		messages.push_back("{\"deviceIdentifier\":\"d" + std::to_string(i % 97)
+			+ "\",\"measurementTimestamp\":" + std::to_string(1700000000 + i)
+			+ ",\"temperatureCelsius\":21.5,\"relativeHumidity\":0.4,\"firmwareRevision\":\"1.2.3\"}");
+		bytes += messages.back().length();
+	}
+
+	auto keys = KeyPool();
+
+	auto plainSeconds = measureSeconds([&]()
+	{
+		for (const auto& message : messages)
+			sink = (double)deserialize(message).length();
+	}, 5);
+
+	auto pooledSeconds = measureSeconds([&]()
+	{
+		for (const auto& message : messages)
+			sink = (double)deserialize(message, keys).length();
+	}, 5);
+
+	auto plainAllocations = countAllocations([&]()
+	{
+		for (const auto& message : messages)
+			sink = (double)deserialize(message).length();
+	});
+
+	auto pooledAllocations = countAllocations([&]()
+	{
+		for (const auto& message : messages)
+			sink = (double)deserialize(message, keys).length();
+	});
+
+	report("  deserialize", bytes, plainSeconds);
+	report("  deserialize with key pool", bytes, pooledSeconds);
+	std::cout << "  allocations: " << plainAllocations << " without pool, " << pooledAllocations << " with pool" << std::endl;
+	std::cout << "  hit rate: " << std::setprecision(4) << keys.hitRate() << ", keys: " << keys.keyCount()
+		<< ", bytes stored: " << keys.bytesStored() << ", bytes saved: " << keys.bytesSaved() << std::endl;
+}
+
+void benchErrors()
+{
+	std::cout << "errors" << std::endl;
+
+	auto random = std::mt19937_64(3);
+	auto messages = std::vector<std::string>();
+	auto bytes = (size_t)0;
+
+	for (size_t i = 0; i < 50000; ++i)
+	{
+		auto message = std::string("{\"id\":") + std::to_string(i) + ",\"name\":\"item\",\"tags\":[1,2,3]}";
+
+		// Roughly 30% are truncated or corrupted somewhere
+		if (random() % 10 < 3)
+		{
+			if (random() % 2)
+				message.resize(random() % message.length());
+			else
+				message[random() % message.length()] = '#';
+		}
+
+		bytes += message.length();
+		messages.push_back(std::move(message));
+	}
+
+	auto failures = (size_t)0;
+
+	auto throwingSeconds = measureSeconds([&]()
+	{
+		failures = 0;
+
+		for (const auto& message : messages)
+		{
+			try
+			{
+				sink = (double)deserialize(message).length();
+			}
+			catch (const std::exception&)
+			{
+				failures += 1;
+			}
+		}
+	}, 5);
+
+	auto trySeconds = measureSeconds([&]()
+	{
+		for (const auto& message : messages)
+		{
+			auto result = tryDeserialize(message);
+
+			sink = result
+				? (double)result.value().length()
+				: (double)result.offset();
+		}
+	}, 5);
+
+	report("  deserialize with catch", bytes, throwingSeconds);
+	report("  tryDeserialize", bytes, trySeconds);
+	std::cout << "  malformed: " << failures << " of " << messages.size() << std::endl;
+}
+
+void benchPointers()
+{
+	std::cout << "pointers" << std::endl;
+
+	auto meta = Object();
+
+	for (int i = 0; i < 24; ++i)
+		meta["setting_number_" + std::to_string(i)] = i;
+
+	auto document = Value(Object({
+		{ "response", Object({ { "items", apiResponse(100) }, { "meta", Value(std::move(meta)) } }) }
+	}));
+	auto pointers = std::vector<Pointer>({
+		Pointer("/response/items/42/name"),
+		Pointer("/response/items/42/email"),
+		Pointer("/response/items/42/tags/1"),
+		Pointer("/response/items/7/score"),
+		Pointer("/response/meta/setting_number_17"),
+		Pointer("/response/meta/setting_number_3")
+	});
+	auto set = PointerSet(pointers);
+	auto found = std::vector<const Value*>(set.size());
+	const auto& root = document;
+	const size_t rounds = 200000;
+
+	auto chained = [&]()
+	{
+		auto count = (size_t)0;
+
+		count += root["response"]["items"][42]["name"].isString();
+		count += root["response"]["items"][42]["email"].isString();
+		count += root["response"]["items"][42]["tags"][1].isString();
+		count += root["response"]["items"][7]["score"].isNumber();
+		count += root["response"]["meta"]["setting_number_17"].isNumber();
+		count += root["response"]["meta"]["setting_number_3"].isNumber();
+
+		return count;
+	};
+
+	auto chainedSeconds = measureSeconds([&]()
+	{
+		auto count = (size_t)0;
+
+		for (size_t i = 0; i < rounds; ++i)
+			count += chained();
+
+		sink = (double)count;
+	}, 3);
+
+	auto pointerSeconds = measureSeconds([&]()
+	{
+		auto count = (size_t)0;
+
+		for (size_t i = 0; i < rounds; ++i)
+		{
+			for (const auto& pointer : pointers)
+				count += pointer.resolve(root) != nullptr;
+		}
+
+		sink = (double)count;
+	}, 3);
+
+	auto setSeconds = measureSeconds([&]()
+	{
+		auto count = (size_t)0;
+
+		for (size_t i = 0; i < rounds; ++i)
+		{
+			set.resolve(root, found.data());
+			count += found[5] != nullptr;
+		}
+
+		sink = (double)count;
+	}, 3);
+
+	auto chainedAllocations = countAllocations([&]() { sink = (double)chained(); });
+	auto pointerAllocations = countAllocations([&]() { sink = (double)(pointers[0].resolve(root) != nullptr); });
+	auto setAllocations = countAllocations([&]() { set.resolve(root, found.data()); });
+	auto lookups = (double)(rounds * pointers.size());
+
+	for (const auto& result : { std::make_pair("  operator[] chain", chainedSeconds),
+		std::make_pair("  Pointer::resolve", pointerSeconds), std::make_pair("  PointerSet::resolve", setSeconds) })
+	{
+		std::cout << std::left << std::setw(40) << result.first
+			<< std::right << std::fixed << std::setprecision(1) << std::setw(10) << result.second * 1e9 / lookups << " ns"
+			<< std::endl;
+	}
+
+	std::cout << "  allocations per batch: chain " << chainedAllocations << ", pointer "
+		<< pointerAllocations * pointers.size() << ", set " << setAllocations << std::endl;
+}
+
+std::string resultsCorpus(size_t count)
+{
+	auto random = std::mt19937_64(5);
+	auto json = std::string("{\"results\":[");
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		char buffer[512];
+
+		std::snprintf(buffer, sizeof(buffer),
+			"{\"id\":%llu,\"category\":\"%s\",\"history\":[%d,%d,%d,%d,%d,%d,%d,%d],"
+			"\"profile\":{\"name\":\"user %llu\",\"bio\":\"nothing much to say about this one\",\"tags\":[\"a\",\"b\",\"c\"]},"
+			"\"code\":{\"hex\":\"#%06llx\"}},",
+			(unsigned long long)i, random() % 4 == 0 ? "hue" : "value",
+			(int)(random() % 1000), (int)(random() % 1000), (int)(random() % 1000), (int)(random() % 1000),
+			(int)(random() % 1000), (int)(random() % 1000), (int)(random() % 1000), (int)(random() % 1000),
+			(unsigned long long)i, (unsigned long long)(random() & 0xFFFFFF));
+
+		json += buffer;
+	}
+
+	json.back() = ']';
+	json += '}';
+
+	return json;
+}
+
+void benchQueries()
+{
+	std::cout << "queries" << std::endl;
+
+	auto json = resultsCorpus(400000);
+
+	for (const auto* text : { "$.results[*].id", "$.results[?(@.category=='hue')].code.hex" })
+	{
+		auto query = Query(text);
+		auto matchCount = (size_t)0;
+
+		auto valueSeconds = measureSeconds([&]()
+		{
+			matchCount = query.select(deserialize(json)).size();
+		}, 3);
+
+		auto streamSeconds = measureSeconds([&]()
+		{
+			auto document = Document(json);
+
+			sink = (double)query.select(document).size();
+		}, 3);
+
+		std::cout << "  " << text << " (" << matchCount << " matches)" << std::endl;
+		report("    deserialize + select", json.length(), valueSeconds);
+		report("    Document + select", json.length(), streamSeconds);
+	}
+
+	auto tokenSeconds = measureSeconds([&]()
+	{
+		auto index = StructuralIndex();
+		auto token = Token::initialFor(json.c_str(), json.length(), index);
+		auto count = (size_t)0;
+
+		while (token.type() != TokenType::EndOfFile)
+		{
+			token.seekNext();
+			count += 1;
+		}
+
+		sink = (double)count;
+	}, 3);
+
+	report("  tokenize only", json.length(), tokenSeconds);
+}
+
+void benchBinary()
+{
+	std::cout << "binary" << std::endl;
+
+	auto corpora = std::vector<std::pair<std::string, Value>>();
+
+	corpora.emplace_back("api response", apiResponse(20000));
+	corpora.emplace_back("records", deserialize(recordCorpus(50000)));
+	corpora.emplace_back("results", deserialize(resultsCorpus(20000)));
+
+	for (const auto& corpus : corpora)
+	{
+		const auto& document = corpus.second;
+		auto json = serialize(document, true);
+		auto packed = toMessagePack(document);
+		auto cbor = toCbor(document);
+		auto arena = Arena();
+
+		auto timings = std::vector<std::tuple<std::string, size_t, double, double>>({
+			{ "json", json.size(),
+				measureSeconds([&]() { sink = (double)serialize(document, true).size(); }, 5),
+				measureSeconds([&]() { sink = (double)deserialize(json).length(); }, 5) },
+			{ "messagepack", packed.size(),
+				measureSeconds([&]() { sink = (double)toMessagePack(document).size(); }, 5),
+				measureSeconds([&]() { sink = (double)fromMessagePack(packed).length(); }, 5) },
+			{ "messagepack view", packed.size(), 0.0,
+				measureSeconds([&]() { arena.reset(); sink = (double)fromMessagePackView(packed, arena).length(); }, 5) },
+			{ "cbor", cbor.size(),
+				measureSeconds([&]() { sink = (double)toCbor(document).size(); }, 5),
+				measureSeconds([&]() { sink = (double)fromCbor(cbor).length(); }, 5) },
+			{ "cbor view", cbor.size(), 0.0,
+				measureSeconds([&]() { arena.reset(); sink = (double)fromCborView(cbor, arena).length(); }, 5) }
+		});
+
+		std::cout << "  " << corpus.first << std::endl;
+
+		for (const auto& timing : timings)
+		{
+			std::cout << "    " << std::left << std::setw(20) << std::get<0>(timing)
+				<< std::right << std::setw(10) << std::get<1>(timing) << " bytes"
+				<< std::fixed << std::setprecision(2);
+
+			// Views only differ from the plain decoders when reading
+			if (std::get<2>(timing) > 0)
+				std::cout << std::setw(10) << std::get<2>(timing) * 1e3 << " ms encode";
+			else
+				std::cout << std::setw(20) << "";
+
+			std::cout << std::setw(10) << std::get<3>(timing) * 1e3 << " ms decode" << std::endl;
+		}
+	}
+}
+
+struct ApiUser
+{
+	uint64_t id = 0;
+	std::string name;
+	std::string email;
+	double score = 0;
+	bool active = false;
+	std::vector<std::string> tags;
+};
+
+namespace hirzel::json
+{
+	template <>
+	struct Binding<ApiUser>
+	{
+		static constexpr auto fields = std::make_tuple(
+			field("id", &ApiUser::id),
+			field("name", &ApiUser::name),
+			field("email", &ApiUser::email),
+			field("score", &ApiUser::score),
+			field("active", &ApiUser::active),
+			field("tags", &ApiUser::tags));
+	};
+}
+
+void benchBinding()
+{
+	std::cout << "binding" << std::endl;
+
+	auto json = serialize(apiResponse(100000), true);
+
+	auto copyFields = [&](std::vector<ApiUser>& users)
+	{
+		auto document = deserialize(json);
+
+		users.clear();
+
+		for (const auto& item : document.array())
+		{
+			auto& user = users.emplace_back();
+
+			user.id = (uint64_t)item["id"].number();
+			user.name = std::string(item["name"].string());
+			user.email = std::string(item["email"].string());
+			user.score = item["score"].number();
+			user.active = item["active"].boolean();
+
+			for (const auto& tag : item["tags"].array())
+				user.tags.emplace_back(tag.string());
+		}
+	};
+
+	auto users = std::vector<ApiUser>();
+
+	auto valueSeconds = measureSeconds([&]()
+	{
+		copyFields(users);
+		sink = (double)users.size();
+	}, 5);
+
+	auto bindSeconds = measureSeconds([&]()
+	{
+		auto fresh = std::vector<ApiUser>();
+
+		deserializeInto(json, fresh);
+		sink = (double)fresh.size();
+	}, 5);
+
+	auto reuseSeconds = measureSeconds([&]()
+	{
+		deserializeInto(json, users);
+		sink = (double)users.size();
+	}, 5);
+
+	auto valueAllocations = countAllocations([&]() { copyFields(users); });
+	auto bindAllocations = countAllocations([&]()
+	{
+		auto fresh = std::vector<ApiUser>();
+
+		deserializeInto(json, fresh);
+	});
+
+	auto document = deserialize(json);
+
+	auto writeValueSeconds = measureSeconds([&]()
+	{
+		sink = (double)serialize(document, true).length();
+	}, 5);
+
+	auto writeBoundSeconds = measureSeconds([&]()
+	{
+		sink = (double)serialize(users, true).length();
+	}, 5);
+
+	report("  deserialize then copy fields", json.length(), valueSeconds);
+	report("  deserializeInto", json.length(), bindSeconds);
+	report("  deserializeInto reused", json.length(), reuseSeconds);
+	report("  serialize value", json.length(), writeValueSeconds);
+	report("  serialize structs", json.length(), writeBoundSeconds);
+	std::cout << "  allocations via value: " << valueAllocations
+		<< ", bound: " << bindAllocations << std::endl;
+}
+
+void benchValidation()
+{
+	std::cout << "validation" << std::endl;
+
+	auto json = serialize(apiResponse(100000), true);
+	auto document = deserialize(json);
+	auto validator = Validator("[{id:#[0,~),name:$,email:$,score:%[0,~),active:&,tags:[$...]}...]");
+
+	auto compileSeconds = measureSeconds([&]()
+	{
+		sink = (double)Validator("{id:#[0,~),name:$,email:$,score:%[0,~),active:&,tags:[$...]}").program().size();
+	}, 5);
+
+	auto valueSeconds = measureSeconds([&]()
+	{
+		sink = validator.isValid(document);
+	}, 5);
+
+	auto parseSeconds = measureSeconds([&]()
+	{
+		sink = validator.isValid(deserialize(json));
+	}, 5);
+
+	auto textSeconds = measureSeconds([&]()
+	{
+		sink = validator.isValidJson(json);
+	}, 5);
+
+	auto parseCheckedSeconds = measureSeconds([&]()
+	{
+		sink = (double)tryDeserialize(json, validator).isOk();
+	}, 5);
+
+	// Rejected near the start, by a string where the first id should be
+	auto invalid = json;
+
+	invalid.replace(invalid.find("\"id\":0"), 6, "\"id\":\"0\"");
+
+	auto rejectLateSeconds = measureSeconds([&]()
+	{
+		auto result = tryDeserialize(invalid);
+
+		sink = result.isOk() && validator.isValid(result.value());
+	}, 5);
+
+	auto rejectEarlySeconds = measureSeconds([&]()
+	{
+		sink = (double)tryDeserialize(invalid, validator).isOk();
+	}, 5);
+
+	auto allocations = countAllocations([&]() { sink = validator.isValid(document); });
+
+	report("  deserialize then validate", json.length(), parseSeconds);
+	report("  deserialize against format", json.length(), parseCheckedSeconds);
+	report("  validate value", json.length(), valueSeconds);
+	report("  validate text", json.length(), textSeconds);
+	std::cout << std::fixed << std::setprecision(3)
+		<< "  reject invalid, deserialize then validate  " << std::setw(10) << rejectLateSeconds * 1e3 << " ms" << std::endl
+		<< "  reject invalid, against format             " << std::setw(10) << rejectEarlySeconds * 1e3 << " ms" << std::endl;
+	std::cout << "  compile: " << std::fixed << std::setprecision(2) << compileSeconds * 1e6 << " us"
+		<< ", allocations per valid value: " << allocations << std::endl;
+}
+
+// Copies every container, as copying a value did before payloads were shared
+static Value deepCopy(const Value& value)
+{
+	switch (value.type())
+	{
+	case ValueType::Array:
+	{
+		auto out = Array();
+
+		out.reserve(value.length());
+
+		for (const auto& element : value.array())
+			out.push_back(deepCopy(element));
+
+		return out;
+	}
+
+	case ValueType::Object:
+	{
+		auto out = Object();
+
+		out.reserve(value.length());
+
+		for (const auto& member : value.object())
+			out.emplace(Key(member.first), deepCopy(member.second));
+
+		return out;
+	}
+
+	case ValueType::String:
+		return std::string(value.string());
+
+	default:
+		return value;
+	}
+}
+
+void benchCopy()
+{
+	std::cout << "copy" << std::endl;
+
+	auto json = serialize(apiResponse(100000), true);
+	auto document = deserialize(json);
+
+	auto deepSeconds = measureSeconds([&]()
+	{
+		sink = (double)deepCopy(document).length();
+	}, 5);
+
+	auto sharedSeconds = measureSeconds([&]()
+	{
+		auto copy = document;
+
+		sink = (double)copy.length();
+	}, 5);
+
+	// Only the top array and the one element on the way are copied
+	auto editSeconds = measureSeconds([&]()
+	{
+		auto copy = document;
+
+		copy[50000]["score"] = 0.0;
+		sink = (double)copy.length();
+	}, 5);
+
+	auto deepAllocations = countAllocations([&]() { sink = (double)deepCopy(document).length(); });
+	auto sharedAllocations = countAllocations([&]()
+	{
+		auto copy = document;
+
+		sink = (double)copy.length();
+	});
+
+	report("  deep copy", json.length(), deepSeconds);
+	report("  shared copy", json.length(), sharedSeconds);
+	report("  shared copy + one edit", json.length(), editSeconds);
+	std::cout << "  allocations per deep copy: " << deepAllocations
+		<< ", per shared copy: " << sharedAllocations << std::endl;
+}
+
+void benchReparse()
+{
+	std::cout << "reparse" << std::endl;
+
+	// Messages of the same shape with different contents, as a stream would carry
+	auto messages = std::vector<std::string>();
+	auto bytes = (size_t)0;
+
+	for (size_t k = 0; k < 8; ++k)
+	{
+		auto message = apiResponse(20);
+
+		for (size_t i = 0; i < message.length(); ++i)
+		{
+			message[i]["score"] = (double)(k * 20 + i) * 1.5;
+			message[i]["name"] = "user name number " + std::to_string(k * 20 + i);
+		}
+
+		messages.push_back(serialize(message, true));
+		bytes += messages.back().length();
+	}
+
+	auto rounds = (size_t)2000;
+
+	auto freshSeconds = measureSeconds([&]()
+	{
+		for (size_t i = 0; i < rounds; ++i)
+			for (const auto& message : messages)
+				sink = (double)deserialize(message).length();
+	}, 3);
+
+	auto value = Value();
+
+	auto intoSeconds = measureSeconds([&]()
+	{
+		for (size_t i = 0; i < rounds; ++i)
+		{
+			for (const auto& message : messages)
+			{
+				deserializeInto(message, value);
+				sink = (double)value.length();
+			}
+		}
+	}, 3);
+
+	auto parser = Parser();
+
+	auto parserSeconds = measureSeconds([&]()
+	{
+		for (size_t i = 0; i < rounds; ++i)
+		{
+			for (const auto& message : messages)
+			{
+				parser.parseInto(message, value);
+				sink = (double)value.length();
+			}
+		}
+	}, 3);
+
+	auto freshAllocations = countAllocations([&]() { sink = (double)deserialize(messages[1]).length(); });
+	auto intoAllocations = countAllocations([&]() { deserializeInto(messages[1], value); });
+	auto parserAllocations = countAllocations([&]() { parser.parseInto(messages[1], value); });
+
+	report("  deserialize", bytes * rounds, freshSeconds);
+	report("  deserializeInto", bytes * rounds, intoSeconds);
+	report("  Parser::parseInto", bytes * rounds, parserSeconds);
+	std::cout << "  allocations per message, deserialize: " << freshAllocations
+		<< ", deserializeInto: " << intoAllocations
+		<< ", Parser: " << parserAllocations << std::endl;
+}
+
+void benchTape()
+{
+	std::cout << "tape" << std::endl;
+
+	auto json = resultsCorpus(400000);
+	auto filepath = (std::filesystem::temp_directory_path() / "hirzel_json_bench_tape.bin").string();
+
+	auto parseSeconds = measureSeconds([&]()
+	{
+		sink = (double)deserialize(json).length();
+	}, 3);
+
+	auto buildSeconds = measureSeconds([&]()
+	{
+		sink = (double)Tape(json).wordCount();
+	}, 3);
+
+	Tape(json).save(filepath);
+
+	auto loadSeconds = measureSeconds([&]()
+	{
+		auto tape = Tape::load(filepath);
+
+		sink = tape.root()["results"][123456]["history"][3].number();
+	}, 3);
+
+	auto tape = Tape::load(filepath);
+	auto results = tape.root()["results"];
+	auto lookupSeconds = measureSeconds([&]()
+	{
+		auto sum = 0.0;
+
+		results.forEachElement([&](const TapeValue& result) { sum += result["id"].number(); });
+
+		sink = sum;
+	}, 3);
+
+	std::filesystem::remove(filepath);
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "  deserialize                   " << std::setw(10) << parseSeconds * 1e3 << " ms" << std::endl
+		<< "  build tape                    " << std::setw(10) << buildSeconds * 1e3 << " ms" << std::endl
+		<< "  load saved tape + one lookup  " << std::setw(10) << loadSeconds * 1e3 << " ms" << std::endl
+		<< "  scan ids of loaded tape       " << std::setw(10) << lookupSeconds * 1e3 << " ms" << std::endl;
+}
+
+void benchFiles()
+{
+	std::cout << "files" << std::endl;
+
+	auto json = recordCorpus(400000);
+	auto filepath = (std::filesystem::temp_directory_path() / "hirzel_json_bench_files.json").string();
+
+	std::ofstream(filepath, std::ios::binary) << json;
+
+	auto readSeconds = measureSeconds([&]()
+	{
+		sink = (double)deserialize(hirzel::file::read(filepath)).length();
+	}, 3);
+
+	auto streamSeconds = measureSeconds([&]()
+	{
+		auto file = std::ifstream(filepath, std::ios::binary);
+		auto text = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		sink = (double)deserialize(text).length();
+	}, 3);
+
+	auto mappedSeconds = measureSeconds([&]()
+	{
+		sink = (double)deserializeFile(filepath).length();
+	}, 3);
+
+	auto viewSeconds = measureSeconds([&]()
+	{
+		auto file = MappedFile(filepath);
+		auto arena = Arena();
+
+		sink = (double)deserializeView(file, arena).length();
+	}, 3);
+
+	std::filesystem::remove(filepath);
+
+	report("  file::read + deserialize", json.length(), readSeconds);
+	report("  ifstream + deserialize", json.length(), streamSeconds);
+	report("  deserializeFile", json.length(), mappedSeconds);
+	report("  MappedFile + deserializeView arena", json.length(), viewSeconds);
+}
+
+int main(int argc, char** argv)
+{
+	// Sections can be picked by name, e.g. `bench_json objects strings`
+	auto benchmarks = std::vector<std::pair<std::string, void (*)()>>({
+		{ "numbers", benchNumbers },
+		{ "formatting", benchNumberFormatting },
+		{ "serialize", benchSerialize },
+		{ "parallel-serialize", benchSerializeParallel },
+		{ "strings", benchStrings },
+		{ "short-strings", benchShortStrings },
+		{ "objects", benchObjects },
+		{ "key-pool", benchKeyPool },
+		{ "errors", benchErrors },
+		{ "files", benchFiles },
+		{ "pointers", benchPointers },
+		{ "queries", benchQueries },
+		{ "binary", benchBinary },
+		{ "copy", benchCopy },
+		{ "reparse", benchReparse },
+		{ "tape", benchTape },
+		{ "binding", benchBinding },
+		{ "validation", benchValidation }
+	});
+
+	for (const auto& benchmark : benchmarks)
+	{
+		auto isSelected = argc < 2;
+
+		for (int i = 1; i < argc; ++i)
+			isSelected = isSelected || benchmark.first == argv[i];
+
+		if (isSelected)
+			benchmark.second();
+	}
+
+	return 0;
+}
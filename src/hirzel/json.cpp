@@ -1,50 +1,205 @@
 #include "hirzel/json.hpp"
 #include "hirzel/json/Token.hpp"
+#include "hirzel/json/StructuralIndex.hpp"
+#include "hirzel/json/Arena.hpp"
+#include "hirzel/json/WorkerPool.hpp"
+#include "hirzel/json/number.hpp"
+#include "hirzel/json/string.hpp"
 #include "hirzel/file.hpp"
 #include "hirzel/json/ValueType.hpp"
 #include "hirzel/print.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <utility>
+#include <vector>
 #include <cassert>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 
 namespace hirzel::json
 {
-	static int xIndex = std::ios::xalloc();
+	struct Context
+	{
+		Arena* arena = nullptr;
+		KeyPool* keys = nullptr;
+		// Strings without escapes refer to the source instead of being copied
+		bool isViewing = false;
+		// Checks values as they are read and stops at the first one rejected
+		const Validator* validator = nullptr;
+	};
+
+	using Rule = Validator::Instruction;
+
+	/*
+	 * Parsing never throws for malformed input; the first error and where it
+	 * was found are recorded here and every function returns false from then
+	 * on, so the throwing API pays for an exception only once, at the top.
+	 */
+	struct ParseState
+	{
+		Token& token;
+		const Context& context;
+		// Escaped strings and keys are decoded here, one at a time
+		std::string& decoded;
+		size_t depth = 0;
+		size_t errorOffset = 0;
+		ParseError error = ParseError::None;
+
+		ParseState(Token& token, const Context& context, std::string& decoded) :
+			token(token),
+			context(context),
+			decoded(decoded)
+		{}
+
+		bool fail(ParseError error, size_t offset)
+		{
+			this->error = error;
+			errorOffset = offset;
+
+			return false;
+		}
+
+		// Running out of input is reported as such rather than as whatever
+		// token was expected instead
+		bool failExpected(ParseError error)
+		{
+			return token.type() == TokenType::EndOfFile
+				? fail(ParseError::UnexpectedEndOfFile, token.pos())
+				: fail(error, token.pos());
+		}
+
+		bool advance()
+		{
+			return token.trySeekNext() || fail(token.error(), token.pos());
+		}
+	};
+
+	static bool deserializeValue(ParseState& parser, Value& out, const Rule* rule);
 
-	static Value deserializeValue(Token& token);
+	static Key createKey(std::string_view label, const Context& context)
+	{
+		if (context.keys)
+			return context.keys->intern(label);
+
+		if (context.arena)
+			return context.arena->createKey(label);
+
+		return Key(label);
+	}
+
+	// Whether a container can be parsed into the one out already holds,
+	// keeping its capacity and that of everything in it
+	static bool isReusable(const Value& out, ValueType type, const Context& context)
+	{
+		return out.type() == type
+			&& !out.isBorrowed()
+			&& !out.isPooled()
+			&& !out.isShared()
+			&& context.arena == nullptr
+			&& context.keys == nullptr;
+	}
 
-	static Value deserializeObject(Token& token)
+	static bool deserializeObject(ParseState& parser, Value& out, const Rule* rule)
 	{
+		auto& token = parser.token;
+		const auto& context = parser.context;
+		auto seen = Validator::SeenMembers();
+
 		assert(token.type() == TokenType::LeftBrace);
 
-		token.seekNext();
+		if (!parser.advance())
+			return false;
+
+		if (!isReusable(out, ValueType::Object, context))
+		{
+			out = context.arena
+				? context.arena->createObject()
+				: context.keys
+					? KeyPool::createObject()
+					: Value(ValueType::Object);
+		}
 
-		auto object = Object();
+		auto& object = context.arena
+			? context.arena->objectToFill(out)
+			: out.object();
+		auto used = (size_t)0;
 
 		if (token.type() != TokenType::RightBrace)
 		{
 			while (true)
 			{
 				if (token.type() != TokenType::String)
-					throw std::runtime_error("Expected label, got '" + token.text() + "'.");
+					return parser.failExpected(ParseError::ExpectedKey);
 
-				auto label = std::string(token.src() + token.pos() + 1, token.length() - 2);
+				auto label = std::string_view(token.src() + token.pos() + 1, token.length() - 2);
 
-				token.seekNext();
+				if (findEscape(label) != label.size())
+				{
+					auto escapeOffset = (size_t)0;
+					auto error = tryUnescape(label, parser.decoded, escapeOffset);
+
+					if (error != ParseError::None)
+						return parser.fail(error, token.pos() + 1 + escapeOffset);
+
+					label = parser.decoded;
+				}
+
+				if (!parser.advance())
+					return false;
 
 				if (token.type() != TokenType::Colon)
-					throw std::runtime_error("Expected ':' before '" + token.text() + "'.");
+					return parser.failExpected(ParseError::ExpectedColon);
+
+				if (!parser.advance())
+					return false;
+
+				const Rule* memberRule = nullptr;
 
-				token.seekNext();
+				if (rule)
+				{
+					auto i = context.validator->findMember(*rule, label, Object::hash(label));
+
+					if (i < rule->childCount)
+					{
+						seen.mark(i);
+						memberRule = &context.validator->child(*rule, i);
+					}
+				}
 
-				auto value = deserializeValue(token);
+				// Members in the same place as in the object being reused are
+				// parsed into it. Past the first that is not, the rest are new.
+				if (used < object.size() && object.begin()[used].first == label)
+				{
+					if (!deserializeValue(parser, object.begin()[used].second, memberRule))
+						return false;
 
-				object.emplace(std::move(label), std::move(value));
+					used += 1;
+				}
+				else
+				{
+					// Made first, as label may be in the buffer the value decodes into
+					auto key = createKey(label, context);
+					auto value = Value();
+
+					object.truncate(used);
+
+					if (!deserializeValue(parser, value, memberRule))
+						return false;
+
+					object.emplace(std::move(key), std::move(value));
+					used = object.size();
+				}
 
 				if (token.type() == TokenType::Comma)
 				{
-					token.seekNext();
+					if (!parser.advance())
+						return false;
+
 					continue;
 				}
 
@@ -52,32 +207,68 @@ namespace hirzel::json
 			}
 
 			if (token.type() != TokenType::RightBrace)
-				throw std::runtime_error("Expected '}' before '" + token.text() + "'.");
+				return parser.failExpected(ParseError::ExpectedCommaOrBrace);
 		}
 
-		token.seekNext();
+		object.truncate(used);
+
+		if (rule && !seen.isComplete(*context.validator, *rule))
+			return parser.fail(ParseError::FormatMismatch, token.pos());
 
-		return object;
+		return parser.advance();
 	}
 
-	static Value deserializeArray(Token& token)
+	static bool deserializeArray(ParseState& parser, Value& out, const Rule* rule)
 	{
+		auto& token = parser.token;
+		const auto& context = parser.context;
+
 		assert(token.type() == TokenType::LeftBracket);
-		token.seekNext();
 
-		auto arr = Array();
+		if (!parser.advance())
+			return false;
+
+		if (!isReusable(out, ValueType::Array, context))
+		{
+			out = context.arena
+				? context.arena->createArray()
+				: context.keys
+					? KeyPool::createArray()
+					: Value(ValueType::Array);
+		}
+
+		auto& arr = context.arena
+			? context.arena->arrayToFill(out)
+			: out.array();
+		auto used = (size_t)0;
 
 		if (token.type() != TokenType::RightBracket)
 		{
 			while (true)
 			{
-				auto value = deserializeValue(token);
+				const Rule* elementRule = nullptr;
 
-				arr.emplace_back(std::move(value));
+				if (rule)
+				{
+					elementRule = context.validator->element(*rule, used);
+
+					if (elementRule == nullptr)
+						return parser.fail(ParseError::FormatMismatch, token.pos());
+				}
+
+				if (used == arr.size())
+					arr.emplace_back();
+
+				if (!deserializeValue(parser, arr[used], elementRule))
+					return false;
+
+				used += 1;
 
 				if (token.type() == TokenType::Comma)
 				{
-					token.seekNext();
+					if (!parser.advance())
+						return false;
+
 					continue;
 				}
 
@@ -85,238 +276,539 @@ namespace hirzel::json
 			}
 
 			if (token.type() != TokenType::RightBracket)
-				throw std::runtime_error("Expected ']' before '" + token.text() + "'.");
+				return parser.failExpected(ParseError::ExpectedCommaOrBracket);
 		}
 
-		token.seekNext();
+		arr.erase(arr.begin() + (ptrdiff_t)used, arr.end());
+
+		if (rule && arr.size() + (rule->isVariadic ? 1 : 0) < rule->childCount)
+			return parser.fail(ParseError::FormatMismatch, token.pos());
 
-		return arr;
+		return parser.advance();
 	}
 
-	static Value deserializeString(Token& token)
+	static bool createString(ParseState& parser, std::string_view text, Value& out)
 	{
-		assert(token.type() == TokenType::String);
+		auto* arena = parser.context.arena;
+
+		if (findEscape(text) == text.size())
+		{
+			if (arena == nullptr)
+				out.assign(text);
+			else if (parser.context.isViewing)
+				out = arena->viewString(text);
+			else
+				out = arena->createString(text);
 
-		auto text = std::string(token.src() + token.pos() + 1, token.length() - 2);
-		auto json = Value(std::move(text));
+			return true;
+		}
+
+		auto escapeOffset = (size_t)0;
+		auto error = tryUnescape(text, parser.decoded, escapeOffset);
+
+		if (error != ParseError::None)
+			return parser.fail(error, (size_t)(text.data() - parser.token.src()) + escapeOffset);
+
+		if (arena)
+			out = arena->createString(parser.decoded);
+		else
+			out.assign(parser.decoded);
+
+		return true;
+	}
 
-		token.seekNext();
+	static bool deserializeString(ParseState& parser, Value& out)
+	{
+		auto& token = parser.token;
+
+		assert(token.type() == TokenType::String);
 
-		return json;
+		return createString(parser, std::string_view(token.src() + token.pos() + 1, token.length() - 2), out)
+			&& parser.advance();
 	}
 
-	static Value deserializeNumber(Token& token)
+	static bool deserializeNumber(ParseState& parser, Value& out, const Rule* rule)
 	{
+		auto& token = parser.token;
+		auto number = 0.0;
+
 		assert(token.type() == TokenType::Number);
 
-		auto text = token.text();
-		auto value = atof(text.c_str());
-		auto json = Value(value);
+		if (!parseNumber(token.src() + token.pos(), token.length(), number))
+			return parser.fail(ParseError::InvalidNumber, token.pos());
 
-		token.seekNext();
+		if (rule)
+		{
+			auto isWhole = rule->check != Validator::Check::Integer || number == std::floor(number);
 
-		return json;
+			if (!isWhole || !Validator::isInRange(*rule, number))
+				return parser.fail(ParseError::FormatMismatch, token.pos());
+		}
+
+		out = Value(number);
+
+		return parser.advance();
 	}
 
-	static Value deserializeValue(Token& token)
+	// Whether the rule allows the kind of value the token starts. Syntax errors
+	// are let through, to be reported as such.
+	static bool isAllowed(const Rule& rule, TokenType type)
 	{
+		switch (type)
+		{
+		case TokenType::LeftBrace:
+			return rule.check == Validator::Check::Object;
+
+		case TokenType::LeftBracket:
+			return rule.check == Validator::Check::Array;
+
+		case TokenType::String:
+			return rule.check == Validator::Check::String;
+
+		case TokenType::Number:
+			return rule.check == Validator::Check::Integer || rule.check == Validator::Check::Number;
+
+		case TokenType::True:
+		case TokenType::False:
+			return rule.check == Validator::Check::Boolean;
+
+		case TokenType::Null:
+			return rule.isNullable;
+
+		default:
+			return true;
+		}
+	}
+
+	static bool deserializeValue(ParseState& parser, Value& out, const Rule* rule)
+	{
+		auto& token = parser.token;
+
+		// Checked before anything is built, so rejected values cost nothing more
+		if (rule && !isAllowed(*rule, token.type()))
+			return parser.fail(ParseError::FormatMismatch, token.pos());
+
 		switch (token.type())
 		{
 			case TokenType::LeftBrace:
-				return deserializeObject(token);
-
 			case TokenType::LeftBracket:
-				return deserializeArray(token);
+			{
+				if (parser.depth == maxParseDepth)
+					return parser.fail(ParseError::TooDeep, token.pos());
+
+				parser.depth += 1;
+
+				auto isParsed = token.type() == TokenType::LeftBrace
+					? deserializeObject(parser, out, rule)
+					: deserializeArray(parser, out, rule);
+
+				parser.depth -= 1;
+
+				return isParsed;
+			}
 
 			case TokenType::String:
-				return deserializeString(token);
+				return deserializeString(parser, out);
 
 			case TokenType::Number:
-				return deserializeNumber(token);
+				return deserializeNumber(parser, out, rule);
 
 			case TokenType::True:
-				token.seekNext();
-				return Value(true);
+				out = Value(true);
+				return parser.advance();
 
 			case TokenType::False:
-				token.seekNext();
-				return Value(false);
+				out = Value(false);
+				return parser.advance();
 
 			case TokenType::Null:
-				token.seekNext();
-				return Value();
+				out = Value();
+				return parser.advance();
 
 			case TokenType::EndOfFile:
-				throw std::runtime_error("Unexpected end of file.");
+				return parser.fail(ParseError::UnexpectedEndOfFile, token.pos());
+
+			case TokenType::Invalid:
+				return parser.fail(token.error(), token.pos());
 
 			default:
-				throw std::runtime_error("Unexpected token: '" + token.text() + "'.");
+				return parser.fail(ParseError::UnexpectedCharacter, token.pos());
 		}
 	}
-	
+
+	static void parseDocument(ParseState& parser, Value& out)
+	{
+		const auto& context = parser.context;
+		const auto* rule = context.validator
+			? &context.validator->root()
+			: nullptr;
+
+		if (deserializeValue(parser, out, rule) && parser.token.type() != TokenType::EndOfFile)
+			parser.fail(ParseError::TrailingContent, parser.token.pos());
+	}
+
+	static ParseResult parse(const char* json, size_t length, const Context& context)
+	{
+		auto index = StructuralIndex();
+		auto token = Token::tryInitialFor(json, length, index);
+		auto decoded = std::string();
+		auto parser = ParseState(token, context, decoded);
+		auto out = Value();
+
+		parseDocument(parser, out);
+
+		if (parser.error != ParseError::None)
+			return ParseResult(parser.error, json, parser.errorOffset);
+
+		return ParseResult(std::move(out));
+	}
+
+	static Value deserialize(const char* json, size_t length, const Context& context)
+	{
+		auto result = parse(json, length, context);
+
+		if (!result)
+			throw std::runtime_error("Failed to deserialize JSON: " + result.message());
+
+		return result.take();
+	}
+
+	static Value deserialize(Token& token, const Context& context)
+	{
+		auto decoded = std::string();
+		auto parser = ParseState(token, context, decoded);
+		auto out = Value();
+
+		if (!deserializeValue(parser, out, nullptr))
+			throw std::runtime_error(std::string(describe(parser.error)) + " at pos: " + std::to_string(parser.errorOffset) + ".");
+
+		return out;
+	}
+
+	static Context arenaContext(Arena& arena, bool isViewing = false)
+	{
+		auto context = Context();
+
+		context.arena = &arena;
+		context.isViewing = isViewing;
+
+		return context;
+	}
+
+	static Context keyPoolContext(KeyPool& keys)
+	{
+		auto context = Context();
+
+		context.keys = &keys;
+
+		return context;
+	}
+
+	static Context validatorContext(const Validator& validator)
+	{
+		auto context = Context();
+
+		context.validator = &validator;
+
+		return context;
+	}
+
 	Value deserialize(const char* json)
 	{
-		try
-		{
-			auto token = Token::initialFor(json);
-			auto out = deserializeValue(token);
+		return deserialize(json, std::strlen(json), Context());
+	}
 
-			if (token.type() != TokenType::EndOfFile)
-				throw std::runtime_error("Unexpected token: " + token.text());
+	Value deserialize(Token& token)
+	{
+		return deserialize(token, Context());
+	}
 
-			return out;
-		}
-		catch (const std::exception& e)
-		{
-			throw std::runtime_error("Failed to deserialize JSON: " + std::string(e.what()));
-		}
+	Value deserialize(Token& token, Arena& arena)
+	{
+		return deserialize(token, arenaContext(arena));
 	}
 
 	Value deserialize(const std::string& json)
 	{
-		return deserialize(json.c_str());
+		return deserialize(json.c_str(), json.length(), Context());
+	}
+
+	Value deserialize(const char* json, Arena& arena)
+	{
+		return deserialize(json, std::strlen(json), arenaContext(arena));
 	}
 
+	Value deserialize(const std::string& json, Arena& arena)
+	{
+		return deserialize(json.c_str(), json.length(), arenaContext(arena));
+	}
 
-	void indent(std::ostream& out)
+	Value deserialize(const char* json, KeyPool& keys)
 	{
-		auto index = out.iword(xIndex);
+		return deserialize(json, std::strlen(json), keyPoolContext(keys));
+	}
 
-		for (long i = 0; i < index; ++i)
-			out << "\t";
+	Value deserialize(const std::string& json, KeyPool& keys)
+	{
+		return deserialize(json.c_str(), json.length(), keyPoolContext(keys));
 	}
 
-	template <bool minimized>
-	void serializeValue(std::ostream& out, const Value& json);
+	Value deserializeView(const char* json, Arena& arena)
+	{
+		return deserialize(json, std::strlen(json), arenaContext(arena, true));
+	}
 
-	template <bool minimized>
-	void serializeArray(std::ostream& out, const Value& json)
+	Value deserializeView(const std::string& json, Arena& arena)
 	{
-		if (json.array().empty())
-		{
-			out << "[]";
-			return;
-		}
+		return deserialize(json.c_str(), json.length(), arenaContext(arena, true));
+	}
 
-		out << "[";
+	Value deserializeView(const MappedFile& file, Arena& arena)
+	{
+		return deserialize(file.data(), file.length(), arenaContext(arena, true));
+	}
 
-		auto isFirst = true;
-		auto& depth = out.iword(xIndex);
+	Value deserializeFile(const std::string& filepath)
+	{
+		auto file = MappedFile(filepath);
 
-		depth += 1;
+		return deserialize(file.data(), file.length(), Context());
+	}
 
-		for (const auto& item : json.array())
-		{
-			if (isFirst)
-			{
-				isFirst = false;
-			}
-			else
-			{
-				out << ",";
-			}
+	Value deserializeFile(const std::string& filepath, Arena& arena)
+	{
+		auto file = MappedFile(filepath);
 
-			if constexpr (minimized == false)
-			{
-				out << "\n";
-				indent(out);
-			}
+		return deserialize(file.data(), file.length(), arenaContext(arena));
+	}
 
-			serializeValue<minimized>(out, item);
-		}
+	ParseResult tryDeserialize(const char* json)
+	{
+		return parse(json, std::strlen(json), Context());
+	}
+
+	ParseResult tryDeserialize(const std::string& json)
+	{
+		return parse(json.c_str(), json.length(), Context());
+	}
 
-		depth -= 1;
+	ParseResult tryDeserialize(const char* json, Arena& arena)
+	{
+		return parse(json, std::strlen(json), arenaContext(arena));
+	}
+
+	ParseResult tryDeserialize(const std::string& json, Arena& arena)
+	{
+		return parse(json.c_str(), json.length(), arenaContext(arena));
+	}
+
+	ParseResult tryDeserialize(const char* json, KeyPool& keys)
+	{
+		return parse(json, std::strlen(json), keyPoolContext(keys));
+	}
+
+	ParseResult tryDeserialize(const std::string& json, KeyPool& keys)
+	{
+		return parse(json.c_str(), json.length(), keyPoolContext(keys));
+	}
+
+	ParseResult tryDeserialize(const char* json, size_t length)
+	{
+		return parse(json, length, Context());
+	}
+
+	ParseResult tryDeserialize(const char* json, size_t length, KeyPool& keys)
+	{
+		return parse(json, length, keyPoolContext(keys));
+	}
+
+	Value deserialize(const char* json, const Validator& validator)
+	{
+		return deserialize(json, std::strlen(json), validatorContext(validator));
+	}
+
+	Value deserialize(const std::string& json, const Validator& validator)
+	{
+		return deserialize(json.c_str(), json.length(), validatorContext(validator));
+	}
+
+	ParseResult tryDeserialize(const char* json, const Validator& validator)
+	{
+		return parse(json, std::strlen(json), validatorContext(validator));
+	}
+
+	ParseResult tryDeserialize(const std::string& json, const Validator& validator)
+	{
+		return parse(json.c_str(), json.length(), validatorContext(validator));
+	}
+
+	void deserializeInto(const char* json, Value& out)
+	{
+		Parser().parseInto(json, out);
+	}
+
+	void deserializeInto(const std::string& json, Value& out)
+	{
+		Parser().parseInto(json, out);
+	}
+
+	// Parser has no source file of its own, as it shares the parser above
+	bool Parser::tryParseInto(const char* json, size_t length, Value& out)
+	{
+		auto token = Token::tryInitialFor(json, length, _index);
+		auto context = Context();
+		auto parser = ParseState(token, context, _decoded);
+
+		parseDocument(parser, out);
+		_error = parser.error;
+		_errorOffset = parser.errorOffset;
+
+		return _error == ParseError::None;
+	}
+
+	bool Parser::tryParseInto(const char* json, Value& out)
+	{
+		return tryParseInto(json, std::strlen(json), out);
+	}
+
+	bool Parser::tryParseInto(const std::string& json, Value& out)
+	{
+		return tryParseInto(json.c_str(), json.length(), out);
+	}
+
+	void Parser::parseInto(const char* json, size_t length, Value& out)
+	{
+		if (!tryParseInto(json, length, out))
+			throw std::runtime_error("Failed to deserialize JSON: " + ParseResult(_error, json, _errorOffset).message());
+	}
+
+	void Parser::parseInto(const char* json, Value& out)
+	{
+		parseInto(json, std::strlen(json), out);
+	}
+
+	void Parser::parseInto(const std::string& json, Value& out)
+	{
+		parseInto(json.c_str(), json.length(), out);
+	}
+
+
+	template <bool minimized>
+	void serializeValue(Writer& out, const Value& json, size_t depth);
+
+	// Comma and indentation before a member or element of a container at depth
+	template <bool minimized>
+	static void writeSeparator(Writer& out, size_t depth, bool isFirst)
+	{
+		if (!isFirst)
+			out.put(',');
 
 		if constexpr (minimized == false)
-		{
-			out << "\n";
-			indent(out);
-		}
+			out.newline(depth + 1);
+	}
+
+	template <bool minimized>
+	static void writeLabel(Writer& out, std::string_view key)
+	{
+		writeEscaped(out, key);
 
-		out << "]";
+		if constexpr (minimized == false)
+			out.write(": ", 2);
+		else
+			out.put(':');
 	}
 
 	template <bool minimized>
-	void serializeObject(std::ostream& out, const Value& json)
+	void serializeArray(Writer& out, const Value& json, size_t depth)
 	{
-		if (json.object().empty())
+		const auto& array = json.array();
+
+		if (array.empty())
 		{
-			out << "{}";
+			out.write("[]", 2);
 			return;
 		}
 
-		out << "{";
-
-		auto& depth = out.iword(xIndex);
-
-		depth += 1;
+		out.put('[');
 
 		auto isFirst = true;
 
-		for (const auto& pair : json.object())
+		for (const auto& item : array)
 		{
-			if (isFirst)
-			{
-				isFirst = false;
-			}
-			else
-			{
-				out << ",";
-			}
-
-			if constexpr (minimized == false)
-			{
-				out << "\n";
+			writeSeparator<minimized>(out, depth, isFirst);
+			serializeValue<minimized>(out, item, depth + 1);
+			isFirst = false;
+		}
 
-				indent(out);
-			}
+		if constexpr (minimized == false)
+			out.newline(depth);
 
-			out << "\"" << pair.first << "\":";
+		out.put(']');
+	}
 
-			if constexpr (minimized == false)
-				out << " ";
+	template <bool minimized>
+	void serializeObject(Writer& out, const Value& json, size_t depth)
+	{
+		const auto& object = json.object();
 
-			serializeValue<minimized>(out, pair.second);
+		if (object.empty())
+		{
+			out.write("{}", 2);
+			return;
 		}
 
-		depth -= 1;
+		out.put('{');
 
-		if constexpr (minimized == false)
+		auto isFirst = true;
+
+		for (const auto& pair : object)
 		{
-			out << "\n";
-			indent(out);
+			writeSeparator<minimized>(out, depth, isFirst);
+			writeLabel<minimized>(out, pair.first);
+			serializeValue<minimized>(out, pair.second, depth + 1);
+			isFirst = false;
 		}
 
-		out << "}";
+		if constexpr (minimized == false)
+			out.newline(depth);
+
+		out.put('}');
 	}
 
 	template <bool minimized>
-	void serializeValue(std::ostream& out, const Value& json)
+	void serializeValue(Writer& out, const Value& json, size_t depth)
 	{
 		switch (json.type())
 		{
 		case ValueType::Null:
-			out << "null";
+			out.write("null", 4);
 			break;
 
 		case ValueType::Boolean:
-			out << json.boolean();
+			if (json.boolean())
+				out.write("true", 4);
+			else
+				out.write("false", 5);
 			break;
 
 		case ValueType::Number:
-			out << std::fixed << json.number();
+		{
+			char buffer[maxNumberLength];
+
+			out.write(buffer, formatNumber(json.number(), buffer));
 			break;
+		}
 
 		case ValueType::String:
-			out << "\"" << json.string() << "\"";
+			writeEscaped(out, json.string());
 			break;
 
 		case ValueType::Array:
-			serializeArray<minimized>(out, json);
+			serializeArray<minimized>(out, json, depth);
 			break;
 
 		case ValueType::Object:
-			serializeObject<minimized>(out, json);
+			serializeObject<minimized>(out, json, depth);
 			break;
 
 		default:
@@ -324,23 +816,243 @@ namespace hirzel::json
 		}
 	}
 
-	void serialize(std::ostream& out, const Value& json, bool minimized)
+	void serialize(Writer& out, const Value& json, bool minimized)
 	{
 		if (minimized)
 		{
-			serializeValue<true>(out, json);
+			serializeValue<true>(out, json, 0);
 			return;
 		}
 
-		serializeValue<false>(out, json);
+		serializeValue<false>(out, json, 0);
+	}
+
+	void serialize(std::ostream& out, const Value& json, bool minimized)
+	{
+		auto writer = Writer(out);
+
+		serialize(writer, json, minimized);
+		writer.flush();
 	}
 
 	std::string serialize(const Value& json, bool minimized)
 	{
-		std::ostringstream out;
+		auto writer = Writer();
+
+		serialize(writer, json, minimized);
+
+		return writer.str();
+	}
+
+	// Below this many members a container is not worth splitting
+	static constexpr size_t parallelSerializeLength = 1024;
+	// Bounds on the members in one chunk of a container serialized in parallel
+	static constexpr size_t minChunkLength = 256;
+	static constexpr size_t maxChunkLength = 16384;
+
+	/*
+	 * Serializes the members of a container in chunks on a pool of workers,
+	 * each chunk into a buffer of its own, and appends the buffers to out in
+	 * order on the calling thread. Workers stay at most a window of chunks
+	 * ahead of the appending, so only that many buffers exist at once and a
+	 * stream can be written while later chunks are still being serialized.
+	 */
+	template <typename Function>
+	static void serializeChunks(Writer& out, size_t count, size_t threadCount, const Function& serializeRange)
+	{
+		const auto chunkLength = std::clamp(count / (threadCount * 8), minChunkLength, maxChunkLength);
+		const auto chunkCount = (count + chunkLength - 1) / chunkLength;
+		const auto window = threadCount * 2;
+		auto buffers = std::vector<std::unique_ptr<Writer>>();
+		auto isDone = std::vector<bool>(window);
+		auto mutex = std::mutex();
+		auto changed = std::condition_variable();
+		size_t nextChunk = 0;
+		size_t appendedCount = 0;
+		bool isCancelled = false;
+
+		for (size_t i = 0; i < window; ++i)
+			buffers.emplace_back(std::make_unique<Writer>());
+
+		// Chunk i uses the buffer of chunk i - window, which has been appended by then
+		auto work = [&]()
+		{
+			while (true)
+			{
+				size_t i;
+
+				{
+					auto lock = std::unique_lock<std::mutex>(mutex);
+
+					changed.wait(lock, [&]() { return isCancelled || nextChunk >= chunkCount || nextChunk < appendedCount + window; });
+
+					if (isCancelled || nextChunk >= chunkCount)
+						return;
+
+					i = nextChunk;
+					nextChunk += 1;
+				}
+
+				auto& buffer = *buffers[i % window];
+				auto first = i * chunkLength;
+
+				buffer.clear();
+				serializeRange(buffer, first, std::min(first + chunkLength, count));
+
+				{
+					auto lock = std::lock_guard<std::mutex>(mutex);
+
+					isDone[i % window] = true;
+				}
+
+				changed.notify_all();
+			}
+		};
+
+		auto cancel = [&]()
+		{
+			{
+				auto lock = std::lock_guard<std::mutex>(mutex);
+
+				isCancelled = true;
+			}
+
+			changed.notify_all();
+		};
+
+		// Cancels and joins the workers if appending to out throws
+		auto pool = WorkerPool(threadCount, work, cancel);
+
+		for (size_t i = 0; i < chunkCount; ++i)
+		{
+			{
+				auto lock = std::unique_lock<std::mutex>(mutex);
+
+				changed.wait(lock, [&]() { return isCancelled || isDone[i % window]; });
+
+				// Only a worker that threw cancels before every chunk is appended
+				if (isCancelled)
+					break;
+			}
+
+			out.write(buffers[i % window]->view());
+
+			{
+				auto lock = std::lock_guard<std::mutex>(mutex);
+
+				isDone[i % window] = false;
+				appendedCount += 1;
+			}
+
+			changed.notify_all();
+		}
+
+		pool.join();
+	}
+
+	// Containers too small to split are walked on the calling thread, as
+	// they may still hold large ones
+	template <bool minimized>
+	static void serializeSplit(Writer& out, const Value& json, size_t depth, size_t threadCount)
+	{
+		if ((!json.isArray() && !json.isObject()) || json.length() == 0)
+		{
+			serializeValue<minimized>(out, json, depth);
+			return;
+		}
+
+		const auto count = json.length();
+
+		out.put(json.isArray() ? '[' : '{');
+
+		if (count < parallelSerializeLength)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				writeSeparator<minimized>(out, depth, i == 0);
+
+				if (json.isArray())
+				{
+					serializeSplit<minimized>(out, json.array()[i], depth + 1, threadCount);
+					continue;
+				}
+
+				const auto& member = json.object().begin()[i];
+
+				writeLabel<minimized>(out, member.first);
+				serializeSplit<minimized>(out, member.second, depth + 1, threadCount);
+			}
+		}
+		else if (json.isArray())
+		{
+			serializeChunks(out, count, threadCount, [&](Writer& buffer, size_t first, size_t last)
+			{
+				const auto& array = json.array();
+
+				for (size_t i = first; i < last; ++i)
+				{
+					writeSeparator<minimized>(buffer, depth, i == 0);
+					serializeValue<minimized>(buffer, array[i], depth + 1);
+				}
+			});
+		}
+		else
+		{
+			serializeChunks(out, count, threadCount, [&](Writer& buffer, size_t first, size_t last)
+			{
+				const auto& object = json.object();
+
+				for (size_t i = first; i < last; ++i)
+				{
+					const auto& member = object.begin()[i];
+
+					writeSeparator<minimized>(buffer, depth, i == 0);
+					writeLabel<minimized>(buffer, member.first);
+					serializeValue<minimized>(buffer, member.second, depth + 1);
+				}
+			});
+		}
+
+		if constexpr (minimized == false)
+			out.newline(depth);
+
+		out.put(json.isArray() ? ']' : '}');
+	}
+
+	void serializeParallel(Writer& out, const Value& json, bool minimized, size_t threadCount)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		if (threadCount == 1)
+		{
+			serialize(out, json, minimized);
+			return;
+		}
+
+		if (minimized)
+		{
+			serializeSplit<true>(out, json, 0, threadCount);
+			return;
+		}
+
+		serializeSplit<false>(out, json, 0, threadCount);
+	}
+
+	void serializeParallel(std::ostream& out, const Value& json, bool minimized, size_t threadCount)
+	{
+		auto writer = Writer(out);
+
+		serializeParallel(writer, json, minimized, threadCount);
+		writer.flush();
+	}
+
+	std::string serializeParallel(const Value& json, bool minimized, size_t threadCount)
+	{
+		auto writer = Writer();
 
-		serialize(out, json, minimized);
+		serializeParallel(writer, json, minimized, threadCount);
 
-		return out.str();
+		return writer.str();
 	}
 }
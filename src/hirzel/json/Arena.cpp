@@ -0,0 +1,197 @@
+#include <hirzel/json/Arena.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace hirzel::json
+{
+	static constexpr size_t maxBlockSize = 64 * 1024 * 1024;
+
+	static inline uintptr_t alignUp(uintptr_t address, size_t alignment)
+	{
+		return (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	}
+
+	Arena::Arena(size_t initialBlockSize) :
+		_blocks(nullptr),
+		_cursor(nullptr),
+		_end(nullptr),
+		_nextBlockSize(std::max(initialBlockSize, sizeof(Block) * 2)),
+		_allocationCount(0),
+		_bytesUsed(0),
+		_bytesReserved(0),
+		_blockCount(0),
+		_deallocationCount(0)
+	{}
+
+	Arena::~Arena()
+	{
+		while (_blocks)
+		{
+			auto* next = _blocks->next;
+
+			std::free(_blocks);
+			_blocks = next;
+		}
+	}
+
+	void* Arena::allocateBlock(size_t bytes, size_t alignment)
+	{
+		auto size = std::max(_nextBlockSize, sizeof(Block) + bytes + alignment);
+		auto* block = (Block*)std::malloc(size);
+
+		if (block == nullptr)
+			throw std::bad_alloc();
+
+		block->next = _blocks;
+		block->size = size;
+
+		_blocks = block;
+		_cursor = (char*)(block + 1);
+		_end = (char*)block + size;
+		_bytesReserved += size;
+		_blockCount += 1;
+
+		if (_nextBlockSize < maxBlockSize)
+			_nextBlockSize *= 2;
+
+		return (void*)alignUp((uintptr_t)_cursor, alignment);
+	}
+
+	void* Arena::do_allocate(size_t bytes, size_t alignment)
+	{
+		auto address = alignUp((uintptr_t)_cursor, alignment);
+
+		if (_cursor == nullptr || address + bytes > (uintptr_t)_end)
+			address = (uintptr_t)allocateBlock(bytes, alignment);
+
+		_cursor = (char*)(address + bytes);
+		_allocationCount += 1;
+		_bytesUsed += bytes;
+
+		return (void*)address;
+	}
+
+	void Arena::reset()
+	{
+		if (_blocks == nullptr)
+			return;
+
+		// The newest block is also the largest, so it is the one worth keeping
+		auto* kept = _blocks;
+
+		while (kept->next)
+		{
+			auto* next = kept->next->next;
+
+			std::free(kept->next);
+			kept->next = next;
+		}
+
+		_cursor = (char*)(kept + 1);
+		_end = (char*)kept + kept->size;
+		_allocationCount = 0;
+		_bytesUsed = 0;
+		_bytesReserved = kept->size;
+		_blockCount = 1;
+		_deallocationCount = 0;
+	}
+
+	// Arena values store their length in 32 bits, and containers filled from
+	// the arena are never walked to release heap copies of longer text
+	static void checkLength(std::string_view text)
+	{
+		if (text.size() > std::numeric_limits<uint32_t>::max())
+			throw std::length_error("Text of " + std::to_string(text.size()) + " bytes is too long for an arena.");
+	}
+
+	Value Arena::createString(std::string_view text)
+	{
+		if (text.size() <= Value::inlineCapacity)
+			return Value(std::string(text));
+
+		checkLength(text);
+
+		auto* chars = (char*)allocate(text.size(), 1);
+
+		std::memcpy(chars, text.data(), text.size());
+
+		auto out = Value();
+
+		out._data.type = ValueType::String;
+		out._data.storage = Value::Storage::Borrowed;
+		out._data.chars = chars;
+		out._data.length = (uint32_t)text.size();
+
+		return out;
+	}
+
+	Value Arena::viewString(std::string_view text)
+	{
+		checkLength(text);
+
+		auto out = Value();
+
+		out._data.type = ValueType::String;
+		out._data.storage = Value::Storage::Borrowed;
+		out._data.chars = text.data();
+		out._data.length = (uint32_t)text.size();
+
+		return out;
+	}
+
+	Key Arena::createKey(std::string_view text)
+	{
+		if (text.size() <= Key::inlineCapacity)
+			return Key(text);
+
+		checkLength(text);
+
+		auto* chars = (char*)allocate(text.size(), 1);
+
+		std::memcpy(chars, text.data(), text.size());
+
+		return Key::borrow(std::string_view(chars, text.size()));
+	}
+
+	Value Arena::createArray()
+	{
+		auto out = Value();
+
+		out._data.type = ValueType::Array;
+		out._data.storage = Value::Storage::Borrowed;
+		out._data.array = new (allocate(sizeof(Array), alignof(Array))) Array(this);
+
+		return out;
+	}
+
+	Value Arena::createObject()
+	{
+		auto out = Value();
+
+		out._data.type = ValueType::Object;
+		out._data.storage = Value::Storage::Borrowed;
+		out._data.object = new (allocate(sizeof(Object), alignof(Object))) Object(this);
+
+		return out;
+	}
+
+	Array& Arena::arrayToFill(Value& array)
+	{
+		assert(array.isArray() && array._data.storage == Value::Storage::Borrowed);
+
+		return *array._data.array;
+	}
+
+	Object& Arena::objectToFill(Value& object)
+	{
+		assert(object.isObject() && object._data.storage == Value::Storage::Borrowed);
+
+		return *object._data.object;
+	}
+}
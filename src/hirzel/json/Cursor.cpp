@@ -0,0 +1,224 @@
+#include <hirzel/json/Cursor.hpp>
+#include <hirzel/json/string.hpp>
+#include <hirzel/json.hpp>
+
+namespace hirzel::json
+{
+	Cursor::Cursor(const Token& token) :
+		_token(token)
+	{
+		switch (token.type())
+		{
+		case TokenType::LeftBrace:
+		case TokenType::LeftBracket:
+		case TokenType::String:
+		case TokenType::Number:
+		case TokenType::True:
+		case TokenType::False:
+		case TokenType::Null:
+			break;
+
+		case TokenType::EndOfFile:
+			throw std::runtime_error("Unexpected end of file.");
+
+		default:
+			throw std::runtime_error("Unexpected token: '" + token.text() + "'.");
+		}
+	}
+
+	ValueType Cursor::type() const
+	{
+		switch (_token.type())
+		{
+		case TokenType::LeftBrace:
+			return ValueType::Object;
+
+		case TokenType::LeftBracket:
+			return ValueType::Array;
+
+		case TokenType::String:
+			return ValueType::String;
+
+		case TokenType::Number:
+			return ValueType::Number;
+
+		case TokenType::True:
+		case TokenType::False:
+			return ValueType::Boolean;
+
+		default:
+			return ValueType::Null;
+		}
+	}
+
+	double Cursor::number() const
+	{
+		if (!isNumber())
+			throw std::runtime_error("Value is not a number.");
+
+		return _token.number();
+	}
+
+	bool Cursor::boolean() const
+	{
+		if (!isBoolean())
+			throw std::runtime_error("Value is not a boolean.");
+
+		return _token.type() == TokenType::True;
+	}
+
+	std::string_view Cursor::rawString() const
+	{
+		if (!isString())
+			throw std::runtime_error("Value is not a string.");
+
+		return std::string_view(_token.src() + _token.pos() + 1, _token.length() - 2);
+	}
+
+	std::string_view Cursor::string(std::string& buffer) const
+	{
+		auto text = rawString();
+
+		if (findEscape(text) == text.size())
+			return text;
+
+		unescape(text, buffer);
+
+		return buffer;
+	}
+
+	std::string Cursor::string() const
+	{
+		auto buffer = std::string();
+
+		return std::string(string(buffer));
+	}
+
+	Value Cursor::value() const
+	{
+		auto token = _token;
+
+		return deserialize(token);
+	}
+
+	std::string_view Cursor::raw() const
+	{
+		auto token = _token;
+		auto end = token.skipValue();
+
+		return std::string_view(_token.src() + _token.pos(), end - _token.pos());
+	}
+
+	Token Cursor::firstChild(TokenType open) const
+	{
+		if (_token.type() != open)
+			throw std::runtime_error(open == TokenType::LeftBrace
+				? "Value is not an object."
+				: "Value is not an array.");
+
+		auto token = _token;
+
+		token.seekNext();
+
+		return token;
+	}
+
+	void Cursor::seekSeparator(Token& token, TokenType close)
+	{
+		if (token.type() == TokenType::Comma)
+		{
+			token.seekNext();
+
+			if (token.type() == close)
+				throw std::runtime_error("Unexpected token: '" + token.text() + "'.");
+
+			return;
+		}
+
+		if (token.type() != close)
+			throw std::runtime_error(close == TokenType::RightBrace
+				? "Expected '}' before '" + token.text() + "'."
+				: "Expected ']' before '" + token.text() + "'.");
+	}
+
+	size_t Cursor::length() const
+	{
+		size_t length = 0;
+
+		if (isArray())
+			forEachElement([&](const Cursor&) { length += 1; });
+		else if (isObject())
+			forEachMember([&](std::string_view, const Cursor&) { length += 1; });
+		else if (isString())
+			length = string().length();
+
+		return length;
+	}
+
+	std::optional<Cursor> Cursor::at(size_t i) const
+	{
+		auto token = firstChild(TokenType::LeftBracket);
+
+		for (size_t index = 0; token.type() != TokenType::RightBracket; ++index)
+		{
+			auto element = Cursor(token);
+
+			if (index == i)
+				return element;
+
+			token.skipValue();
+			seekSeparator(token, TokenType::RightBracket);
+		}
+
+		return std::nullopt;
+	}
+
+	std::optional<Cursor> Cursor::at(std::string_view key) const
+	{
+		auto token = firstChild(TokenType::LeftBrace);
+		auto decodedLabel = std::string();
+
+		while (token.type() != TokenType::RightBrace)
+		{
+			if (token.type() != TokenType::String)
+				throw std::runtime_error("Expected label, got '" + token.text() + "'.");
+
+			auto label = Cursor(token).string(decodedLabel);
+
+			token.seekNext();
+
+			if (token.type() != TokenType::Colon)
+				throw std::runtime_error("Expected ':' before '" + token.text() + "'.");
+
+			token.seekNext();
+
+			if (label == key)
+				return Cursor(token);
+
+			token.skipValue();
+			seekSeparator(token, TokenType::RightBrace);
+		}
+
+		return std::nullopt;
+	}
+
+	Cursor Cursor::operator[](size_t i) const
+	{
+		auto element = at(i);
+
+		if (!element)
+			throw std::runtime_error("Index " + std::to_string(i) + " is out of bounds.");
+
+		return *element;
+	}
+
+	Cursor Cursor::operator[](std::string_view key) const
+	{
+		auto member = at(key);
+
+		if (!member)
+			throw std::runtime_error("No member with key '" + std::string(key) + "' exists.");
+
+		return *member;
+	}
+}
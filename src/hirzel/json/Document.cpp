@@ -0,0 +1,29 @@
+#include <hirzel/json/Document.hpp>
+#include <cstring>
+
+namespace hirzel::json
+{
+	Document::Document(const char* json) :
+		Document(json, std::strlen(json))
+	{}
+
+	Document::Document(const std::string& json) :
+		Document(json.c_str(), json.length())
+	{}
+
+	Document::Document(const char* json, size_t length) :
+		_src(json),
+		_length(length),
+		_index(),
+		_isIndexed(_index.build(json, length))
+	{}
+
+	Cursor Document::root() const
+	{
+		auto token = _isIndexed
+			? Token::initialFor(_src, _index)
+			: Token::initialFor(_src);
+
+		return Cursor(token);
+	}
+}
@@ -0,0 +1,120 @@
+#include <hirzel/json/Key.hpp>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace hirzel::json
+{
+	Key::Key() :
+		_inline()
+	{
+		_inline.storage = Storage::Inline;
+	}
+
+	Key::Key(std::string_view text) :
+		_inline()
+	{
+		init(text);
+	}
+
+	Key::Key(Key&& other) noexcept :
+		_inline()
+	{
+		if (other._data.storage == Storage::Inline)
+		{
+			_inline = other._inline;
+			return;
+		}
+
+		_data = other._data;
+		other._inline = InlineText();
+		other._inline.storage = Storage::Inline;
+	}
+
+	Key::Key(const Key& other) :
+		_inline()
+	{
+		if (other._data.storage == Storage::Inline)
+		{
+			_inline = other._inline;
+			return;
+		}
+
+		init(other.view());
+	}
+
+	void Key::init(std::string_view text)
+	{
+		if (text.length() <= inlineCapacity)
+		{
+			_inline.storage = Storage::Inline;
+			_inline.length = (uint8_t)text.length();
+
+			if (!text.empty())
+				std::memcpy(_inline.chars, text.data(), text.length());
+
+			return;
+		}
+
+		if (text.length() > std::numeric_limits<uint32_t>::max())
+			throw std::runtime_error("Key of length " + std::to_string(text.length()) + " is too long.");
+
+		auto* chars = new char[text.length()];
+
+		std::memcpy(chars, text.data(), text.length());
+
+		_data.storage = Storage::Owned;
+		_data.length = (uint32_t)text.length();
+		_data.chars = chars;
+	}
+
+	void Key::release()
+	{
+		if (_data.storage == Storage::Owned)
+			delete[] _data.chars;
+	}
+
+	Key Key::borrow(std::string_view text)
+	{
+		if (text.length() > std::numeric_limits<uint32_t>::max())
+			return Key(text);
+
+		auto out = Key();
+
+		out._data.storage = Storage::Borrowed;
+		out._data.length = (uint32_t)text.length();
+		out._data.chars = text.data();
+
+		return out;
+	}
+
+	Key& Key::operator=(Key&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		release();
+
+		if (other._data.storage == Storage::Inline)
+		{
+			_inline = other._inline;
+			return *this;
+		}
+
+		_data = other._data;
+		other._inline = InlineText();
+		other._inline.storage = Storage::Inline;
+
+		return *this;
+	}
+
+	Key& Key::operator=(const Key& other)
+	{
+		if (this == &other)
+			return *this;
+
+		auto copy = Key(other);
+
+		return *this = std::move(copy);
+	}
+}
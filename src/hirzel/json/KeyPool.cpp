@@ -0,0 +1,108 @@
+#include <hirzel/json/KeyPool.hpp>
+#include <cstring>
+#include <mutex>
+
+namespace hirzel::json
+{
+	KeyPool::KeyPool(size_t maxKeyLength, size_t maxBytes) :
+		_storage(4096),
+		_maxKeyLength(maxKeyLength),
+		_maxBytes(maxBytes),
+		_bytesStored(0),
+		_lookupCount(0),
+		_hitCount(0),
+		_bytesSaved(0)
+	{}
+
+	Key KeyPool::intern(std::string_view key)
+	{
+		// Inline keys are as cheap as borrowed ones, so the table is no help
+		if (key.length() <= Key::inlineCapacity)
+			return Key(key);
+
+		_lookupCount.fetch_add(1, std::memory_order_relaxed);
+
+		if (key.length() > _maxKeyLength)
+			return Key(key);
+
+		{
+			auto lock = std::shared_lock<std::shared_mutex>(_mutex);
+			auto iter = _keys.find(key);
+
+			if (iter != _keys.end())
+			{
+				_hitCount.fetch_add(1, std::memory_order_relaxed);
+				_bytesSaved.fetch_add(key.length(), std::memory_order_relaxed);
+
+				return Key::borrow(*iter);
+			}
+		}
+
+		auto lock = std::unique_lock<std::shared_mutex>(_mutex);
+		// Another thread may have added it between the two locks
+		auto iter = _keys.find(key);
+
+		if (iter != _keys.end())
+		{
+			_hitCount.fetch_add(1, std::memory_order_relaxed);
+			_bytesSaved.fetch_add(key.length(), std::memory_order_relaxed);
+
+			return Key::borrow(*iter);
+		}
+
+		if (_bytesStored + key.length() > _maxBytes)
+			return Key(key);
+
+		auto* chars = (char*)_storage.allocate(key.length(), 1);
+
+		std::memcpy(chars, key.data(), key.length());
+
+		auto stored = std::string_view(chars, key.length());
+
+		_keys.insert(stored);
+		_bytesStored += key.length();
+
+		return Key::borrow(stored);
+	}
+
+	Value KeyPool::createArray()
+	{
+		auto out = Value(ValueType::Array);
+
+		out._data.storage = Value::Storage::Pooled;
+
+		return out;
+	}
+
+	Value KeyPool::createObject()
+	{
+		auto out = Value(ValueType::Object);
+
+		out._data.storage = Value::Storage::Pooled;
+
+		return out;
+	}
+
+	size_t KeyPool::keyCount() const
+	{
+		auto lock = std::shared_lock<std::shared_mutex>(_mutex);
+
+		return _keys.size();
+	}
+
+	size_t KeyPool::bytesStored() const
+	{
+		auto lock = std::shared_lock<std::shared_mutex>(_mutex);
+
+		return _bytesStored;
+	}
+
+	double KeyPool::hitRate() const
+	{
+		auto lookups = lookupCount();
+
+		return lookups > 0
+			? (double)hitCount() / (double)lookups
+			: 0.0;
+	}
+}
@@ -0,0 +1,167 @@
+#include <hirzel/json/MappedFile.hpp>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HIRZEL_JSON_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace hirzel::json
+{
+	// Empty files share this instead of allocating a buffer of only padding
+	static const char emptyContents[MappedFile::padding] = {};
+
+	static std::runtime_error openError(const std::string& filepath)
+	{
+		return std::runtime_error("Failed to open file '" + filepath + "': " + std::strerror(errno) + ".");
+	}
+
+#ifdef HIRZEL_JSON_MMAP
+
+	MappedFile::MappedFile(const std::string& filepath, bool isSequential) :
+		_data(const_cast<char*>(emptyContents)),
+		_length(0),
+		_capacity(0)
+	{
+		auto fd = open(filepath.c_str(), O_RDONLY);
+
+		if (fd == -1)
+			throw openError(filepath);
+
+		struct stat info;
+
+		if (fstat(fd, &info) == -1)
+		{
+			auto error = openError(filepath);
+
+			close(fd);
+			throw error;
+		}
+
+		auto length = (size_t)info.st_size;
+
+		if (length == 0)
+		{
+			close(fd);
+			return;
+		}
+
+		auto pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		auto capacity = (length + padding + pageSize - 1) / pageSize * pageSize;
+
+		// Reserving the padded range as zeroed anonymous memory first and then
+		// mapping the file over its start keeps the padding valid even when the
+		// file ends exactly on a page boundary. Bytes past the end of the file
+		// within its last page are zero filled by the kernel.
+		auto* reserved = mmap(nullptr, capacity, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (reserved == MAP_FAILED)
+		{
+			auto error = openError(filepath);
+
+			close(fd);
+			throw error;
+		}
+
+		auto* mapped = mmap(reserved, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+		auto mapErrno = errno;
+
+		close(fd);
+
+		if (mapped == MAP_FAILED)
+		{
+			munmap(reserved, capacity);
+			errno = mapErrno;
+			throw openError(filepath);
+		}
+
+		// Parsing reads front to back once, so read ahead aggressively and let
+		// the kernel drop pages behind the parser under memory pressure
+		if (isSequential)
+			madvise(mapped, length, MADV_SEQUENTIAL);
+
+		_data = (char*)mapped;
+		_length = length;
+		_capacity = capacity;
+	}
+
+	void MappedFile::release()
+	{
+		if (_capacity > 0)
+			munmap(_data, _capacity);
+	}
+
+#else
+
+	MappedFile::MappedFile(const std::string& filepath, bool) :
+		_data(const_cast<char*>(emptyContents)),
+		_length(0),
+		_capacity(0)
+	{
+		auto file = std::ifstream(filepath, std::ios::binary | std::ios::ate);
+
+		if (!file.is_open())
+			throw openError(filepath);
+
+		auto length = (size_t)file.tellg();
+
+		if (length == 0)
+			return;
+
+		auto* data = new char[length + padding]();
+
+		file.seekg(0);
+
+		if (!file.read(data, length))
+		{
+			delete[] data;
+			throw std::runtime_error("Failed to read file '" + filepath + "'.");
+		}
+
+		_data = data;
+		_length = length;
+		_capacity = length + padding;
+	}
+
+	void MappedFile::release()
+	{
+		if (_capacity > 0)
+			delete[] _data;
+	}
+
+#endif
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept :
+		_data(other._data),
+		_length(other._length),
+		_capacity(other._capacity)
+	{
+		other._data = const_cast<char*>(emptyContents);
+		other._length = 0;
+		other._capacity = 0;
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		release();
+
+		_data = other._data;
+		_length = other._length;
+		_capacity = other._capacity;
+		other._data = const_cast<char*>(emptyContents);
+		other._length = 0;
+		other._capacity = 0;
+
+		return *this;
+	}
+}
@@ -0,0 +1,269 @@
+#include <hirzel/json/NdjsonReader.hpp>
+#include <hirzel/json/WorkerPool.hpp>
+#include <hirzel/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace hirzel::json
+{
+	struct LineChunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+		size_t firstLine = 0;
+		size_t lineCount = 0;
+		std::vector<NdjsonRecord> records;
+		bool isDone = false;
+	};
+
+	static std::vector<LineChunk> splitChunks(const char* src, size_t length, size_t chunkSize)
+	{
+		auto chunks = std::vector<LineChunk>();
+		const auto* iter = src;
+		const auto* end = src + length;
+
+		while (iter < end)
+		{
+			const auto* chunkEnd = iter + std::min(chunkSize, (size_t)(end - iter));
+
+			if (chunkEnd < end)
+			{
+				// Starting one back lets a chunk end on a newline it already contains
+				const auto* newline = (const char*)std::memchr(chunkEnd - 1, '\n', end - chunkEnd + 1);
+
+				chunkEnd = newline
+					? newline + 1
+					: end;
+			}
+
+			auto& chunk = chunks.emplace_back();
+
+			chunk.begin = iter;
+			chunk.end = chunkEnd;
+			iter = chunkEnd;
+		}
+
+		return chunks;
+	}
+
+	static void numberLines(std::vector<LineChunk>& chunks)
+	{
+		size_t line = 1;
+
+		for (auto& chunk : chunks)
+		{
+			chunk.firstLine = line;
+			line += chunk.lineCount;
+		}
+	}
+
+	static bool isBlank(const char* begin, const char* end)
+	{
+		for (const auto* iter = begin; iter < end; ++iter)
+		{
+			if ((unsigned char)*iter > ' ')
+				return false;
+		}
+
+		return true;
+	}
+
+	static std::vector<NdjsonRecord> parseChunk(const char* src, const LineChunk& chunk, KeyPool* keys)
+	{
+		auto records = std::vector<NdjsonRecord>();
+		auto line = chunk.firstLine;
+
+		for (const auto* lineStart = chunk.begin; lineStart < chunk.end; ++line)
+		{
+			const auto* newline = (const char*)std::memchr(lineStart, '\n', chunk.end - lineStart);
+			const auto* lineEnd = newline
+				? newline
+				: chunk.end;
+
+			if (!isBlank(lineStart, lineEnd))
+			{
+				auto record = NdjsonRecord();
+
+				record.line = line;
+				record.offset = lineStart - src;
+
+				// Parsed in place: the newline or terminator after it ends the text
+				auto length = (size_t)(lineEnd - lineStart);
+				auto result = keys
+					? tryDeserialize(lineStart, length, *keys)
+					: tryDeserialize(lineStart, length);
+
+				if (result)
+					record.value = result.take();
+				else
+					record.error = result.message();
+
+				records.emplace_back(std::move(record));
+			}
+
+			lineStart = lineEnd + 1;
+		}
+
+		return records;
+	}
+
+	NdjsonReader::NdjsonReader(size_t threadCount, bool isOrdered, size_t chunkSize) :
+		_threadCount(threadCount > 0 ? threadCount : std::max(std::thread::hardware_concurrency(), 1u)),
+		_chunkSize(std::max(chunkSize, (size_t)1)),
+		_keys(nullptr),
+		_isOrdered(isOrdered)
+	{}
+
+	void NdjsonReader::read(const char* src, size_t length, const Callback& callback) const
+	{
+		auto chunks = splitChunks(src, length, _chunkSize);
+
+		if (chunks.empty())
+			return;
+
+		auto threadCount = std::min(_threadCount, chunks.size());
+		// Workers stay at most this many chunks ahead of the callback
+		const auto window = threadCount * 2;
+		auto mutex = std::mutex();
+		auto changed = std::condition_variable();
+		auto finished = std::vector<size_t>();
+		auto nextCounted = std::atomic<size_t>(0);
+		size_t countingCount = threadCount;
+		size_t nextChunk = 0;
+		size_t deliveredCount = 0;
+		bool isNumbered = false;
+		bool isCancelled = false;
+
+		auto work = [&]()
+		{
+			// Every chunk needs its first line number before any is parsed, so
+			// the workers count lines together first
+			for (size_t i; (i = nextCounted++) < chunks.size();)
+				chunks[i].lineCount = std::count(chunks[i].begin, chunks[i].end, '\n');
+
+			{
+				auto lock = std::lock_guard<std::mutex>(mutex);
+
+				countingCount -= 1;
+
+				if (countingCount == 0)
+				{
+					numberLines(chunks);
+					isNumbered = true;
+				}
+			}
+
+			changed.notify_all();
+
+			while (true)
+			{
+				size_t i;
+
+				{
+					auto lock = std::unique_lock<std::mutex>(mutex);
+
+					changed.wait(lock, [&]() { return isCancelled || (isNumbered && (nextChunk >= chunks.size() || nextChunk < deliveredCount + window)); });
+
+					if (isCancelled || nextChunk >= chunks.size())
+						return;
+
+					i = nextChunk;
+					nextChunk += 1;
+				}
+
+				auto records = parseChunk(src, chunks[i], _keys);
+
+				{
+					auto lock = std::lock_guard<std::mutex>(mutex);
+
+					chunks[i].records = std::move(records);
+					chunks[i].isDone = true;
+
+					if (!_isOrdered)
+						finished.push_back(i);
+				}
+
+				changed.notify_all();
+			}
+		};
+
+		auto cancel = [&]()
+		{
+			{
+				auto lock = std::lock_guard<std::mutex>(mutex);
+
+				isCancelled = true;
+			}
+
+			changed.notify_all();
+		};
+
+		// Cancels and joins the workers if the callback throws
+		auto pool = WorkerPool(threadCount, work, cancel);
+		size_t nextOrdered = 0;
+
+		while (deliveredCount < chunks.size())
+		{
+			auto records = std::vector<NdjsonRecord>();
+
+			{
+				auto lock = std::unique_lock<std::mutex>(mutex);
+
+				changed.wait(lock, [&]() { return isCancelled || (_isOrdered ? chunks[nextOrdered].isDone : !finished.empty()); });
+
+				// Only a worker that threw cancels while records are still due
+				if (isCancelled)
+					break;
+
+				size_t i;
+
+				if (_isOrdered)
+				{
+					i = nextOrdered;
+					nextOrdered += 1;
+				}
+				else
+				{
+					i = finished.back();
+					finished.pop_back();
+				}
+
+				records = std::move(chunks[i].records);
+			}
+
+			for (auto& record : records)
+				callback(std::move(record));
+
+			{
+				auto lock = std::lock_guard<std::mutex>(mutex);
+
+				deliveredCount += 1;
+			}
+
+			changed.notify_all();
+		}
+
+		pool.join();
+	}
+
+	std::vector<NdjsonRecord> NdjsonReader::read(const char* src, size_t length) const
+	{
+		auto records = std::vector<NdjsonRecord>();
+
+		read(src, length, [&](NdjsonRecord&& record)
+		{
+			records.emplace_back(std::move(record));
+		});
+
+		return records;
+	}
+
+	std::vector<NdjsonRecord> NdjsonReader::read(const std::string& src) const
+	{
+		return read(src.c_str(), src.length());
+	}
+}
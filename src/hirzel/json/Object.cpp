@@ -0,0 +1,207 @@
+#include <hirzel/json/Object.hpp>
+#include <algorithm>
+#include <functional>
+
+namespace hirzel::json
+{
+	static constexpr size_t notFound = (size_t)-1;
+	static constexpr size_t minCapacity = 4;
+
+	static inline uint32_t hashKey(std::string_view key)
+	{
+		return (uint32_t)std::hash<std::string_view>()(key);
+	}
+
+	uint32_t Object::hash(std::string_view key)
+	{
+		return hashKey(key);
+	}
+
+	Object::Object(std::pmr::memory_resource* resource) :
+		_members(resource),
+		_slots(resource)
+	{}
+
+	Object::Object(std::initializer_list<Member> members)
+	{
+		_members.reserve(members.size());
+
+		for (const auto& member : members)
+			emplace(Key(member.first), Value(member.second));
+	}
+
+	size_t Object::indexOf(std::string_view key) const
+	{
+		return indexOf(key, _slots.empty() ? 0 : hashKey(key));
+	}
+
+	size_t Object::indexOf(std::string_view key, uint32_t hash) const
+	{
+		if (_slots.empty())
+		{
+			for (size_t i = 0; i < _members.size(); ++i)
+			{
+				if (_members[i].first == key)
+					return i;
+			}
+
+			return notFound;
+		}
+
+		auto mask = _slots.size() - 1;
+
+		for (auto i = hash & mask; _slots[i].position != 0; i = (i + 1) & mask)
+		{
+			const auto& slot = _slots[i];
+
+			if (slot.hash == hash && _members[slot.position - 1].first == key)
+				return slot.position - 1;
+		}
+
+		return notFound;
+	}
+
+	void Object::addSlot(uint32_t hash, size_t index)
+	{
+		auto mask = _slots.size() - 1;
+		auto i = hash & mask;
+
+		while (_slots[i].position != 0)
+			i = (i + 1) & mask;
+
+		_slots[i].hash = hash;
+		_slots[i].position = (uint32_t)(index + 1);
+	}
+
+	void Object::rebuildIndex()
+	{
+		// Keeping the load factor at or below one half keeps probe runs short
+		auto capacity = (size_t)16;
+
+		while (capacity < _members.size() * 2)
+			capacity *= 2;
+
+		_slots.assign(capacity, Slot());
+
+		for (size_t i = 0; i < _members.size(); ++i)
+			addSlot(hashKey(_members[i].first), i);
+	}
+
+	std::pair<Object::iterator, bool> Object::emplace(Key&& key, Value&& value)
+	{
+		auto index = indexOf(key);
+
+		if (index != notFound)
+			return { _members.begin() + index, false };
+
+		// Skips the first doublings, which almost every parsed object would hit
+		if (_members.capacity() == 0)
+			_members.reserve(minCapacity);
+
+		auto hash = _slots.empty()
+			? 0
+			: hashKey(key);
+
+		_members.emplace_back(std::move(key), std::move(value));
+
+		if (_slots.empty())
+		{
+			if (_members.size() > indexThreshold)
+				rebuildIndex();
+		}
+		else if (_members.size() * 2 > _slots.size())
+		{
+			rebuildIndex();
+		}
+		else
+		{
+			addSlot(hash, _members.size() - 1);
+		}
+
+		return { _members.end() - 1, true };
+	}
+
+	Value& Object::operator[](std::string_view key)
+	{
+		auto index = indexOf(key);
+
+		if (index != notFound)
+			return _members[index].second;
+
+		return emplace(Key(key), Value()).first->second;
+	}
+
+	Object::iterator Object::find(std::string_view key)
+	{
+		auto index = indexOf(key);
+
+		return index != notFound
+			? _members.begin() + index
+			: _members.end();
+	}
+
+	Object::const_iterator Object::find(std::string_view key) const
+	{
+		auto index = indexOf(key);
+
+		return index != notFound
+			? _members.begin() + index
+			: _members.end();
+	}
+
+	Object::iterator Object::find(std::string_view key, uint32_t hash)
+	{
+		auto index = indexOf(key, hash);
+
+		return index != notFound
+			? _members.begin() + index
+			: _members.end();
+	}
+
+	Object::const_iterator Object::find(std::string_view key, uint32_t hash) const
+	{
+		auto index = indexOf(key, hash);
+
+		return index != notFound
+			? _members.begin() + index
+			: _members.end();
+	}
+
+	size_t Object::erase(std::string_view key)
+	{
+		auto index = indexOf(key);
+
+		if (index == notFound)
+			return 0;
+
+		// Rotating only ever move-assigns into moved-from members
+		std::rotate(_members.begin() + index, _members.begin() + index + 1, _members.end());
+		_members.pop_back();
+
+		if (_members.size() > indexThreshold)
+			rebuildIndex();
+		else
+			_slots.clear();
+
+		return 1;
+	}
+
+	void Object::truncate(size_t size)
+	{
+		if (size >= _members.size())
+			return;
+
+		_members.erase(_members.begin() + size, _members.end());
+
+		if (_members.size() > indexThreshold)
+			rebuildIndex();
+		else
+			_slots.clear();
+	}
+
+	void Object::clear()
+	{
+		_members.clear();
+		_slots.clear();
+	}
+}
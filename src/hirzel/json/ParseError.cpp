@@ -0,0 +1,57 @@
+#include <hirzel/json/ParseError.hpp>
+
+namespace hirzel::json
+{
+	const char* describe(ParseError error)
+	{
+		switch (error)
+		{
+		case ParseError::None:
+			return "No error";
+
+		case ParseError::UnexpectedEndOfFile:
+			return "Unexpected end of file";
+
+		case ParseError::UnexpectedCharacter:
+			return "Unexpected character";
+
+		case ParseError::InvalidLiteral:
+			return "Invalid literal";
+
+		case ParseError::UnterminatedString:
+			return "Unterminated string";
+
+		case ParseError::InvalidNumber:
+			return "Invalid number format";
+
+		case ParseError::InvalidEscape:
+			return "Invalid escape sequence";
+
+		case ParseError::InvalidUnicodeEscape:
+			return "Invalid unicode escape sequence";
+
+		case ParseError::ExpectedKey:
+			return "Expected key";
+
+		case ParseError::ExpectedColon:
+			return "Expected ':' after key";
+
+		case ParseError::ExpectedCommaOrBrace:
+			return "Expected ',' or '}'";
+
+		case ParseError::ExpectedCommaOrBracket:
+			return "Expected ',' or ']'";
+
+		case ParseError::TrailingContent:
+			return "Unexpected content after value";
+
+		case ParseError::TooDeep:
+			return "Nesting is too deep";
+
+		case ParseError::FormatMismatch:
+			return "Value does not match the format";
+		}
+
+		return "Unknown error";
+	}
+}
@@ -0,0 +1,66 @@
+#include <hirzel/json/ParseResult.hpp>
+#include <cstring>
+
+namespace hirzel::json
+{
+	ParseResult::ParseResult(Value&& value) :
+		_value(std::move(value)),
+		_src(nullptr),
+		_offset(0),
+		_line(0),
+		_column(0),
+		_error(ParseError::None)
+	{}
+
+	ParseResult::ParseResult(ParseError error, const char* src, size_t offset) :
+		_src(src),
+		_offset(offset),
+		_line(0),
+		_column(0),
+		_error(error)
+	{}
+
+	void ParseResult::locate() const
+	{
+		if (_line != 0 || _src == nullptr)
+			return;
+
+		const auto* lineStart = _src;
+		const auto* end = _src + _offset;
+
+		_line = 1;
+
+		while (const auto* newline = (const char*)std::memchr(lineStart, '\n', end - lineStart))
+		{
+			_line += 1;
+			lineStart = newline + 1;
+		}
+
+		_column = end - lineStart + 1;
+	}
+
+	size_t ParseResult::line() const
+	{
+		locate();
+
+		return _line;
+	}
+
+	size_t ParseResult::column() const
+	{
+		locate();
+
+		return _column;
+	}
+
+	std::string ParseResult::message() const
+	{
+		if (isOk())
+			return describe(_error);
+
+		return std::string(describe(_error))
+			+ " at line " + std::to_string(line())
+			+ ", column " + std::to_string(column())
+			+ " (offset " + std::to_string(_offset) + ").";
+	}
+}
@@ -0,0 +1,155 @@
+#include <hirzel/json/Pointer.hpp>
+#include <stdexcept>
+
+namespace hirzel::json
+{
+	// Keeps indices well inside size_t so they cannot overflow
+	static constexpr size_t maxIndexDigits = 18;
+
+	static size_t parseIndex(std::string_view token)
+	{
+		if (token.empty() || token.length() > maxIndexDigits)
+			return Pointer::notAnIndex;
+
+		// Leading zeros are not allowed, so "01" can only name an object member
+		if (token[0] == '0' && token.length() > 1)
+			return Pointer::notAnIndex;
+
+		size_t index = 0;
+
+		for (auto c : token)
+		{
+			if (c < '0' || c > '9')
+				return Pointer::notAnIndex;
+
+			index = index * 10 + (size_t)(c - '0');
+		}
+
+		return index;
+	}
+
+	static std::runtime_error invalidPointer(std::string_view text, const char* reason)
+	{
+		return std::runtime_error("Invalid JSON pointer '" + std::string(text) + "': " + reason + ".");
+	}
+
+	Pointer::Pointer(std::string_view text) :
+		_text(text)
+	{
+		if (text.empty())
+			return;
+
+		if (text[0] != '/')
+			throw invalidPointer(text, "must be empty or start with '/'");
+
+		_keys.reserve(text.length());
+
+		for (size_t i = 1; i <= text.length(); ++i)
+		{
+			auto segment = Segment();
+
+			segment.offset = (uint32_t)_keys.length();
+
+			for (; i < text.length() && text[i] != '/'; ++i)
+			{
+				if (text[i] != '~')
+				{
+					_keys += text[i];
+					continue;
+				}
+
+				i += 1;
+
+				if (i < text.length() && text[i] == '0')
+					_keys += '~';
+				else if (i < text.length() && text[i] == '1')
+					_keys += '/';
+				else
+					throw invalidPointer(text, "'~' must be followed by '0' or '1'");
+			}
+
+			segment.length = (uint32_t)(_keys.length() - segment.offset);
+
+			auto token = std::string_view(_keys).substr(segment.offset, segment.length);
+
+			segment.hash = Object::hash(token);
+			segment.index = parseIndex(token);
+
+			_segments.push_back(segment);
+		}
+	}
+
+	const Value* Pointer::step(const Value& value, size_t i) const
+	{
+		const auto& segment = _segments[i];
+
+		switch (value.type())
+		{
+		case ValueType::Object:
+		{
+			const auto& object = value.object();
+			auto iter = object.find(key(i), segment.hash);
+
+			return iter != object.end()
+				? &iter->second
+				: nullptr;
+		}
+
+		case ValueType::Array:
+			return segment.index < value.array().size()
+				? &value.array()[segment.index]
+				: nullptr;
+
+		default:
+			return nullptr;
+		}
+	}
+
+	// Goes through the non-const accessors so that containers shared with
+	// copies are unshared on the way down
+	Value* Pointer::step(Value& value, size_t i) const
+	{
+		const auto& segment = _segments[i];
+
+		switch (value.type())
+		{
+		case ValueType::Object:
+		{
+			auto& object = value.object();
+			auto iter = object.find(key(i), segment.hash);
+
+			return iter != object.end()
+				? &iter->second
+				: nullptr;
+		}
+
+		case ValueType::Array:
+			return segment.index < value.length()
+				? &value.array()[segment.index]
+				: nullptr;
+
+		default:
+			return nullptr;
+		}
+	}
+
+	const Value* Pointer::resolve(const Value& root) const
+	{
+		const auto* value = &root;
+
+		for (size_t i = 0; i < _segments.size() && value != nullptr; ++i)
+			value = step(*value, i);
+
+		return value;
+	}
+
+	Value* Pointer::resolve(Value& root) const
+	{
+		auto* value = &root;
+
+		for (size_t i = 0; i < _segments.size() && value != nullptr; ++i)
+			value = step(*value, i);
+
+		return value;
+	}
+}
@@ -0,0 +1,111 @@
+#include <hirzel/json/PointerSet.hpp>
+#include <algorithm>
+
+namespace hirzel::json
+{
+	// Deeper sets keep their path on the heap
+	static constexpr size_t inlinePathLength = 32;
+
+	static size_t sharedSegments(const Pointer& a, const Pointer& b)
+	{
+		auto depth = std::min(a.depth(), b.depth());
+		size_t i = 0;
+
+		while (i < depth && a.key(i) == b.key(i))
+			i += 1;
+
+		return i;
+	}
+
+	static bool isOrderedBefore(const Pointer& a, const Pointer& b)
+	{
+		auto shared = sharedSegments(a, b);
+
+		if (shared == a.depth() || shared == b.depth())
+			return a.depth() < b.depth();
+
+		return a.key(shared) < b.key(shared);
+	}
+
+	PointerSet::PointerSet(std::vector<Pointer> pointers) :
+		_pointers(std::move(pointers)),
+		_order(_pointers.size()),
+		_shared(_pointers.size()),
+		_maxDepth(0)
+	{
+		for (size_t i = 0; i < _order.size(); ++i)
+			_order[i] = i;
+
+		std::sort(_order.begin(), _order.end(), [&](size_t a, size_t b)
+		{
+			return isOrderedBefore(_pointers[a], _pointers[b]);
+		});
+
+		for (size_t i = 0; i < _order.size(); ++i)
+		{
+			const auto& pointer = _pointers[_order[i]];
+
+			_shared[i] = i > 0
+				? sharedSegments(_pointers[_order[i - 1]], pointer)
+				: 0;
+			_maxDepth = std::max(_maxDepth, pointer.depth());
+		}
+	}
+
+	void PointerSet::resolve(const Value& root, const Value** out) const
+	{
+		const Value* inlinePath[inlinePathLength];
+		auto heapPath = std::vector<const Value*>();
+		auto** path = inlinePath;
+
+		if (_maxDepth >= inlinePathLength)
+		{
+			heapPath.resize(_maxDepth + 1);
+			path = heapPath.data();
+		}
+
+		// path[0, resolved) holds the values along the previous pointer, which
+		// stops short of its full depth if one of its segments was missing
+		path[0] = &root;
+		size_t resolved = 1;
+
+		for (size_t i = 0; i < _order.size(); ++i)
+		{
+			const auto& pointer = _pointers[_order[i]];
+			auto shared = _shared[i];
+
+			// The prefix shared with the previous pointer is known to be missing
+			if (shared >= resolved)
+			{
+				out[_order[i]] = nullptr;
+				continue;
+			}
+
+			const auto* value = path[shared];
+
+			resolved = shared + 1;
+
+			for (auto depth = shared; depth < pointer.depth(); ++depth)
+			{
+				value = pointer.step(*value, depth);
+
+				if (value == nullptr)
+					break;
+
+				path[depth + 1] = value;
+				resolved = depth + 2;
+			}
+
+			out[_order[i]] = value;
+		}
+	}
+
+	std::vector<const Value*> PointerSet::resolve(const Value& root) const
+	{
+		auto out = std::vector<const Value*>(_pointers.size());
+
+		resolve(root, out.data());
+
+		return out;
+	}
+}
@@ -0,0 +1,587 @@
+#include <hirzel/json/Query.hpp>
+#include <hirzel/json/ParseError.hpp>
+#include <hirzel/json/number.hpp>
+#include <cstring>
+#include <stdexcept>
+
+namespace hirzel::json
+{
+	// Keeps indices well inside size_t so they cannot overflow
+	static constexpr size_t maxIndexDigits = 18;
+	// Passed as the index of object members
+	static constexpr size_t noIndex = (size_t)-1;
+
+	class Query::Parser
+	{
+		std::string_view _text;
+		size_t _pos;
+
+	public:
+
+		Parser(std::string_view text) :
+			_text(text),
+			_pos(0)
+		{}
+
+		[[noreturn]] void fail(const char* reason) const
+		{
+			throw std::runtime_error("Invalid JSONPath '" + std::string(_text) + "' at pos: "
+				+ std::to_string(_pos) + ": " + reason + ".");
+		}
+
+		bool isDone() const { return _pos == _text.length(); }
+		char peek() const { return isDone() ? '\0' : _text[_pos]; }
+
+		bool accept(char c)
+		{
+			if (peek() != c)
+				return false;
+
+			_pos += 1;
+
+			return true;
+		}
+
+		void expect(char c, const char* reason)
+		{
+			if (!accept(c))
+				fail(reason);
+		}
+
+		void skipSpaces()
+		{
+			while (peek() == ' ' || peek() == '\t')
+				_pos += 1;
+		}
+
+		std::string name()
+		{
+			auto start = _pos;
+
+			while (!isDone() && std::strchr(".[]()=!<> \t", _text[_pos]) == nullptr)
+				_pos += 1;
+
+			if (_pos == start)
+				fail("expected a name");
+
+			return std::string(_text.substr(start, _pos - start));
+		}
+
+		std::string quoted()
+		{
+			auto quote = peek();
+			auto out = std::string();
+
+			_pos += 1;
+
+			while (!accept(quote))
+			{
+				if (isDone())
+					fail("unterminated string");
+
+				// Escapes are taken literally, which covers escaped quotes
+				if (accept('\\') && isDone())
+					fail("unterminated string");
+
+				out += _text[_pos];
+				_pos += 1;
+			}
+
+			return out;
+		}
+
+		size_t index()
+		{
+			auto start = _pos;
+			size_t index = 0;
+
+			while (peek() >= '0' && peek() <= '9')
+			{
+				index = index * 10 + (size_t)(peek() - '0');
+				_pos += 1;
+			}
+
+			if (_pos == start)
+				fail("expected an index");
+
+			if (_pos - start > maxIndexDigits)
+				fail("index is too large");
+
+			return index;
+		}
+
+		bool isQuote() const { return peek() == '\'' || peek() == '\"'; }
+
+		void setName(Step& step, std::string&& name)
+		{
+			step.type = StepType::Name;
+			step.hash = Object::hash(name);
+			step.name = std::move(name);
+		}
+
+		// Member or element selector inside brackets, past the '['
+		void selector(Step& step)
+		{
+			skipSpaces();
+
+			if (isQuote())
+			{
+				setName(step, quoted());
+			}
+			else
+			{
+				step.type = StepType::Index;
+				step.index = index();
+			}
+
+			skipSpaces();
+			expect(']', "expected ']'");
+		}
+
+		Comparison comparison()
+		{
+			if (accept('='))
+			{
+				expect('=', "expected '=='");
+				return Comparison::Equal;
+			}
+
+			if (accept('!'))
+			{
+				expect('=', "expected '!='");
+				return Comparison::NotEqual;
+			}
+
+			if (accept('<'))
+				return accept('=') ? Comparison::LessEqual : Comparison::Less;
+
+			if (accept('>'))
+				return accept('=') ? Comparison::GreaterEqual : Comparison::Greater;
+
+			fail("expected a comparison");
+		}
+
+		bool acceptWord(std::string_view word)
+		{
+			if (_text.substr(_pos, word.length()) != word)
+				return false;
+
+			_pos += word.length();
+
+			return true;
+		}
+
+		Value literal()
+		{
+			if (isQuote())
+				return Value(quoted());
+
+			if (acceptWord("true"))
+				return Value(true);
+
+			if (acceptWord("false"))
+				return Value(false);
+
+			if (acceptWord("null"))
+				return Value();
+
+			auto start = _pos;
+
+			while (!isDone() && std::strchr("+-.eE0123456789", _text[_pos]) != nullptr)
+				_pos += 1;
+
+			auto number = 0.0;
+
+			if (_pos == start || !parseNumber(_text.data() + start, _pos - start, number))
+			{
+				_pos = start;
+				fail("expected a literal");
+			}
+
+			return Value(number);
+		}
+
+		// Filter expression, past the '?'
+		Filter filter()
+		{
+			auto filter = Filter();
+
+			skipSpaces();
+			expect('(', "expected '('");
+			skipSpaces();
+			expect('@', "expected '@'");
+
+			while (peek() == '.' || peek() == '[')
+			{
+				auto step = Step();
+
+				step.isRecursive = false;
+
+				if (accept('.'))
+					setName(step, name());
+				else if (accept('['))
+					selector(step);
+
+				filter.path.push_back(std::move(step));
+			}
+
+			skipSpaces();
+
+			if (peek() == ')')
+			{
+				filter.comparison = Comparison::Exists;
+			}
+			else
+			{
+				filter.comparison = comparison();
+				skipSpaces();
+				filter.literal = literal();
+				skipSpaces();
+			}
+
+			expect(')', "expected ')'");
+
+			return filter;
+		}
+	};
+
+	Query::Query(std::string_view text) :
+		_text(text)
+	{
+		auto parser = Parser(text);
+
+		parser.expect('$', "expected '$'");
+
+		while (!parser.isDone())
+		{
+			auto step = Step();
+
+			step.isRecursive = false;
+
+			if (parser.accept('.'))
+			{
+				step.isRecursive = parser.accept('.');
+
+				if (parser.accept('*'))
+				{
+					step.type = StepType::Wildcard;
+					_steps.push_back(std::move(step));
+					continue;
+				}
+
+				if (!step.isRecursive || parser.peek() != '[')
+				{
+					parser.setName(step, parser.name());
+					_steps.push_back(std::move(step));
+					continue;
+				}
+			}
+
+			parser.expect('[', "expected '.' or '['");
+			parser.skipSpaces();
+
+			if (parser.accept('*'))
+			{
+				step.type = StepType::Wildcard;
+				parser.skipSpaces();
+				parser.expect(']', "expected ']'");
+			}
+			else if (parser.accept('?'))
+			{
+				step.type = StepType::Filter;
+				step.index = _filters.size();
+				_filters.push_back(parser.filter());
+				parser.skipSpaces();
+				parser.expect(']', "expected ']'");
+			}
+			else
+			{
+				parser.selector(step);
+			}
+
+			_steps.push_back(std::move(step));
+		}
+	}
+
+	/*
+	 * Values and cursors are navigated through these overloads, so that
+	 * selection is written once for both. Lookups on cursors scan the
+	 * container and skip the subtrees they pass over.
+	 */
+
+	static const Value* childOf(const Value& value, const Query::Step& step)
+	{
+		if (step.type == Query::StepType::Index)
+			return value.isArray() && step.index < value.array().size()
+				? &value.array()[step.index]
+				: nullptr;
+
+		if (!value.isObject())
+			return nullptr;
+
+		auto iter = value.object().find(step.name, step.hash);
+
+		return iter != value.object().end()
+			? &iter->second
+			: nullptr;
+	}
+
+	static std::optional<Cursor> childOf(const Cursor& cursor, const Query::Step& step)
+	{
+		if (step.type == Query::StepType::Index)
+			return cursor.isArray()
+				? cursor.at(step.index)
+				: std::nullopt;
+
+		return cursor.isObject()
+			? cursor.at(step.name)
+			: std::nullopt;
+	}
+
+	// Calls callback(child, key, index) for each element or member in order
+	template <typename Callback>
+	static void forEachChild(const Value& value, Callback&& callback)
+	{
+		if (value.isArray())
+		{
+			const auto& array = value.array();
+
+			for (size_t i = 0; i < array.size(); ++i)
+				callback(array[i], std::string_view(), i);
+		}
+		else if (value.isObject())
+		{
+			for (const auto& member : value.object())
+				callback(member.second, member.first.view(), noIndex);
+		}
+	}
+
+	template <typename Callback>
+	static void forEachChild(const Cursor& cursor, Callback&& callback)
+	{
+		if (cursor.isArray())
+		{
+			size_t i = 0;
+
+			cursor.forEachElement([&](const Cursor& element) { callback(element, std::string_view(), i++); });
+		}
+		else if (cursor.isObject())
+		{
+			cursor.forEachMember([&](std::string_view key, const Cursor& member) { callback(member, key, noIndex); });
+		}
+	}
+
+	static const Value* resolve(const Value& value, const std::vector<Query::Step>& path)
+	{
+		const auto* current = &value;
+
+		for (size_t i = 0; i < path.size() && current != nullptr; ++i)
+			current = childOf(*current, path[i]);
+
+		return current;
+	}
+
+	static std::optional<Cursor> resolve(const Cursor& cursor, const std::vector<Query::Step>& path)
+	{
+		auto current = std::optional<Cursor>(cursor);
+
+		// Tokens cannot be assigned, so each step replaces the cursor in place
+		for (size_t i = 0; i < path.size() && current; ++i)
+		{
+			auto child = childOf(*current, path[i]);
+
+			current.reset();
+
+			if (child)
+				current.emplace(*child);
+		}
+
+		return current;
+	}
+
+	static std::string_view stringOf(const Value& value, std::string&)
+	{
+		return value.string();
+	}
+
+	static std::string_view stringOf(const Cursor& cursor, std::string& buffer)
+	{
+		return cursor.string(buffer);
+	}
+
+	static void addMatch(const Value& value, std::vector<const Value*>& out)
+	{
+		out.push_back(&value);
+	}
+
+	static void addMatch(const Cursor& cursor, std::vector<Cursor>& out)
+	{
+		out.push_back(cursor);
+	}
+
+	template <typename T>
+	static bool compare(const T& a, const T& b, Query::Comparison comparison)
+	{
+		switch (comparison)
+		{
+		case Query::Comparison::Equal:
+			return a == b;
+
+		case Query::Comparison::NotEqual:
+			return a != b;
+
+		case Query::Comparison::Less:
+			return a < b;
+
+		case Query::Comparison::LessEqual:
+			return a <= b;
+
+		case Query::Comparison::Greater:
+			return a > b;
+
+		case Query::Comparison::GreaterEqual:
+			return a >= b;
+
+		default:
+			return true;
+		}
+	}
+
+	template <typename Node>
+	bool Query::matches(const Node& node, const Filter& filter, std::string& buffer) const
+	{
+		auto target = resolve(node, filter.path);
+
+		if (!target)
+			return false;
+
+		if (filter.comparison == Comparison::Exists)
+			return true;
+
+		// Values of different types are only ever unequal
+		if (target->type() != filter.literal.type())
+			return filter.comparison == Comparison::NotEqual;
+
+		switch (filter.literal.type())
+		{
+		case ValueType::Number:
+			return compare((double)target->number(), filter.literal.number(), filter.comparison);
+
+		case ValueType::String:
+			return compare(stringOf(*target, buffer), filter.literal.string(), filter.comparison);
+
+		case ValueType::Boolean:
+			return compare((bool)target->boolean(), filter.literal.boolean(), filter.comparison);
+
+		default:
+			return compare(0, 0, filter.comparison);
+		}
+	}
+
+	template <typename Node>
+	bool Query::isMatch(const Step& step, const Node& child, std::string_view key, size_t index, std::string& buffer) const
+	{
+		switch (step.type)
+		{
+		case StepType::Name:
+			return index == noIndex && key == step.name;
+
+		case StepType::Index:
+			return index == step.index;
+
+		case StepType::Filter:
+			return matches(child, _filters[step.index], buffer);
+
+		default:
+			return true;
+		}
+	}
+
+	template <typename Node, typename Match>
+	void Query::applyStep(const Node& node, size_t step, size_t depth, std::vector<Match>& out) const
+	{
+		const auto& current = _steps[step];
+
+		if (current.type == StepType::Name || current.type == StepType::Index)
+		{
+			auto child = childOf(node, current);
+
+			if (child)
+				selectFrom(*child, step + 1, depth + 1, out);
+
+			return;
+		}
+
+		auto buffer = std::string();
+
+		forEachChild(node, [&](const Node& child, std::string_view key, size_t index)
+		{
+			if (isMatch(current, child, key, index, buffer))
+				selectFrom(child, step + 1, depth + 1, out);
+		});
+	}
+
+	// Walks every descendant once, in document order, selecting from those
+	// the step matches before going into them
+	template <typename Node, typename Match>
+	void Query::selectDescendants(const Node& node, size_t step, size_t depth, std::vector<Match>& out) const
+	{
+		// Each level of nesting takes a few frames, so the limit keeps the stack bounded
+		if (depth > maxParseDepth)
+			throw std::runtime_error(std::string(describe(ParseError::TooDeep)) + " for JSONPath '" + _text + "'.");
+
+		const auto& current = _steps[step];
+		auto buffer = std::string();
+
+		forEachChild(node, [&](const Node& child, std::string_view key, size_t index)
+		{
+			if (isMatch(current, child, key, index, buffer))
+				selectFrom(child, step + 1, depth + 1, out);
+
+			selectDescendants(child, step, depth + 1, out);
+		});
+	}
+
+	template <typename Node, typename Match>
+	void Query::selectFrom(const Node& node, size_t step, size_t depth, std::vector<Match>& out) const
+	{
+		if (step == _steps.size())
+		{
+			addMatch(node, out);
+			return;
+		}
+
+		if (_steps[step].isRecursive)
+			selectDescendants(node, step, depth, out);
+		else
+			applyStep(node, step, depth, out);
+	}
+
+	void Query::select(const Value& root, std::vector<const Value*>& out) const
+	{
+		selectFrom(root, 0, 0, out);
+	}
+
+	void Query::select(const Cursor& root, std::vector<Cursor>& out) const
+	{
+		selectFrom(root, 0, 0, out);
+	}
+
+	std::vector<const Value*> Query::select(const Value& root) const
+	{
+		auto out = std::vector<const Value*>();
+
+		select(root, out);
+
+		return out;
+	}
+
+	std::vector<Cursor> Query::select(const Cursor& root) const
+	{
+		auto out = std::vector<Cursor>();
+
+		select(root, out);
+
+		return out;
+	}
+}
@@ -0,0 +1,413 @@
+#include <hirzel/json/StructuralIndex.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HIRZEL_JSON_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+#ifdef HIRZEL_JSON_X86_DISPATCH
+#define HIRZEL_JSON_TARGET(isa) __attribute__((target(isa), flatten))
+#endif
+
+namespace hirzel::json
+{
+	struct BlockMasks
+	{
+		uint64_t quote;
+		uint64_t backslash;
+		uint64_t whitespace;
+		uint64_t op;
+		uint64_t slash;
+	};
+
+	static constexpr size_t blockSize = 64;
+	// Input indexed between checks that the positions buffer has room, so
+	// that it grows with the tokens found rather than with the input
+	static constexpr size_t chunkSize = 64 * 1024;
+
+	static inline int trailingZeroes(uint64_t bits)
+	{
+#if defined(__GNUC__)
+		return __builtin_ctzll(bits);
+#else
+		int count = 0;
+
+		while (!(bits & 1))
+		{
+			bits >>= 1;
+			count += 1;
+		}
+
+		return count;
+#endif
+	}
+
+	static inline int popCount(uint64_t bits)
+	{
+#if defined(__GNUC__)
+		return __builtin_popcountll(bits);
+#else
+		int count = 0;
+
+		for (; bits; bits &= bits - 1)
+			count += 1;
+
+		return count;
+#endif
+	}
+
+	static inline uint64_t prefixXor(uint64_t bits)
+	{
+		bits ^= bits << 1;
+		bits ^= bits << 2;
+		bits ^= bits << 4;
+		bits ^= bits << 8;
+		bits ^= bits << 16;
+		bits ^= bits << 32;
+
+		return bits;
+	}
+
+	static inline BlockMasks classifyScalar(const char* block)
+	{
+		auto masks = BlockMasks{};
+
+		for (size_t i = 0; i < blockSize; ++i)
+		{
+			auto c = (unsigned char)block[i];
+			auto bit = uint64_t(1) << i;
+
+			switch (c)
+			{
+			case '\"':
+				masks.quote |= bit;
+				break;
+
+			case '\\':
+				masks.backslash |= bit;
+				break;
+
+			case '/':
+				masks.slash |= bit;
+				break;
+
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ',':
+			case ':':
+				masks.op |= bit;
+				break;
+
+			default:
+				if (c <= ' ')
+					masks.whitespace |= bit;
+				break;
+			}
+		}
+
+		return masks;
+	}
+
+#ifdef HIRZEL_JSON_X86_DISPATCH
+
+	__attribute__((target("sse4.2,popcnt")))
+	static inline BlockMasks classifySse42(const char* block)
+	{
+		const auto quote = _mm_set1_epi8('\"');
+		const auto backslash = _mm_set1_epi8('\\');
+		const auto slash = _mm_set1_epi8('/');
+		const auto space = _mm_set1_epi8(' ');
+		const auto lowerCase = _mm_set1_epi8(0x20);
+		const auto openBrace = _mm_set1_epi8('{');
+		const auto closeBrace = _mm_set1_epi8('}');
+		const auto comma = _mm_set1_epi8(',');
+		const auto colon = _mm_set1_epi8(':');
+
+		auto masks = BlockMasks{};
+
+		for (size_t i = 0; i < blockSize; i += 16)
+		{
+			auto in = _mm_loadu_si128((const __m128i*)(block + i));
+			// '[' and ']' differ from '{' and '}' only by bit 5
+			auto folded = _mm_or_si128(in, lowerCase);
+			auto op = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(folded, openBrace), _mm_cmpeq_epi8(folded, closeBrace)),
+				_mm_or_si128(_mm_cmpeq_epi8(in, comma), _mm_cmpeq_epi8(in, colon)));
+			auto whitespace = _mm_cmpeq_epi8(_mm_min_epu8(in, space), in);
+
+			masks.quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(in, quote)) << i;
+			masks.backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(in, backslash)) << i;
+			masks.slash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(in, slash)) << i;
+			masks.whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(whitespace) << i;
+			masks.op |= (uint64_t)(uint16_t)_mm_movemask_epi8(op) << i;
+		}
+
+		return masks;
+	}
+
+	__attribute__((target("avx2,bmi,popcnt")))
+	static inline BlockMasks classifyAvx2(const char* block)
+	{
+		const auto quote = _mm256_set1_epi8('\"');
+		const auto backslash = _mm256_set1_epi8('\\');
+		const auto slash = _mm256_set1_epi8('/');
+		const auto space = _mm256_set1_epi8(' ');
+		const auto lowerCase = _mm256_set1_epi8(0x20);
+		const auto openBrace = _mm256_set1_epi8('{');
+		const auto closeBrace = _mm256_set1_epi8('}');
+		const auto comma = _mm256_set1_epi8(',');
+		const auto colon = _mm256_set1_epi8(':');
+
+		auto masks = BlockMasks{};
+
+		for (size_t i = 0; i < blockSize; i += 32)
+		{
+			auto in = _mm256_loadu_si256((const __m256i*)(block + i));
+			auto folded = _mm256_or_si256(in, lowerCase);
+			auto op = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(folded, openBrace), _mm256_cmpeq_epi8(folded, closeBrace)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(in, comma), _mm256_cmpeq_epi8(in, colon)));
+			auto whitespace = _mm256_cmpeq_epi8(_mm256_min_epu8(in, space), in);
+
+			masks.quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, quote)) << i;
+			masks.backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, backslash)) << i;
+			masks.slash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, slash)) << i;
+			masks.whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(whitespace) << i;
+			masks.op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << i;
+		}
+
+		return masks;
+	}
+
+#endif
+
+	class BlockScanner
+	{
+		uint64_t _prevEndsOddBackslash = 0;
+		uint64_t _prevInString = 0;
+		uint64_t _prevIsScalar = 0;
+
+		// Marks characters that follow an odd-length run of backslashes.
+		uint64_t escaped(uint64_t backslash)
+		{
+			const uint64_t evenBits = 0x5555555555555555ULL;
+			const uint64_t oddBits = ~evenBits;
+
+			auto startEdges = backslash & ~(backslash << 1);
+			auto evenStartMask = evenBits ^ _prevEndsOddBackslash;
+			auto evenStarts = startEdges & evenStartMask;
+			auto oddStarts = startEdges & ~evenStartMask;
+			auto evenCarries = backslash + evenStarts;
+			auto oddCarries = backslash + oddStarts;
+			auto endsOdd = oddCarries < backslash;
+
+			oddCarries |= _prevEndsOddBackslash;
+			_prevEndsOddBackslash = endsOdd ? 1 : 0;
+
+			auto evenCarryEnds = evenCarries & ~backslash;
+			auto oddCarryEnds = oddCarries & ~backslash;
+
+			return (evenCarryEnds & oddBits) | (oddCarryEnds & evenBits);
+		}
+
+	public:
+
+		bool scan(const BlockMasks& masks, uint64_t& structurals)
+		{
+			auto quotes = masks.quote & ~escaped(masks.backslash);
+			auto inString = prefixXor(quotes) ^ _prevInString;
+
+			_prevInString = (uint64_t)((int64_t)inString >> 63);
+
+			// Comments are only understood by the scanning tokenizer
+			if (masks.slash & ~inString)
+				return false;
+
+			auto scalar = ~(masks.op | masks.whitespace | quotes | inString);
+			auto scalarStarts = scalar & ~((scalar << 1) | _prevIsScalar);
+
+			_prevIsScalar = scalar >> 63;
+			structurals = (masks.op & ~inString) | (quotes & inString) | scalarStarts;
+
+			return true;
+		}
+	};
+
+	using Indexer = bool (*)(const char* src, size_t length, uint32_t offset, BlockScanner& scanner, uint32_t* out, size_t& count);
+
+	// Writes in unconditional groups of eight so that the common case costs no
+	// branch mispredictions. The output buffer has a block worth of slack.
+	static inline void flatten(uint64_t bits, uint32_t base, uint32_t* out, size_t& count)
+	{
+		auto* iter = out + count;
+		auto n = popCount(bits);
+
+		// Setting the top bit keeps trailingZeroes defined once bits runs out
+		const auto guard = uint64_t(1) << 63;
+
+		for (int i = 0; i < 8; ++i)
+		{
+			iter[i] = base + trailingZeroes(bits | guard);
+			bits &= bits - 1;
+		}
+
+		if (n > 8)
+		{
+			for (int i = 8; i < 16; ++i)
+			{
+				iter[i] = base + trailingZeroes(bits | guard);
+				bits &= bits - 1;
+			}
+
+			for (int i = 16; bits; ++i)
+			{
+				iter[i] = base + trailingZeroes(bits);
+				bits &= bits - 1;
+			}
+		}
+
+		count += n;
+	}
+
+	// Positions are written relative to src plus offset
+	template <BlockMasks (*classify)(const char*)>
+	static inline bool indexBlocks(const char* src, size_t length, uint32_t offset, BlockScanner& scanner, uint32_t* out, size_t& count)
+	{
+		uint64_t structurals;
+		size_t base = 0;
+
+		for (; base + blockSize <= length; base += blockSize)
+		{
+			if (!scanner.scan(classify(src + base), structurals))
+				return false;
+
+			flatten(structurals, offset + (uint32_t)base, out, count);
+		}
+
+		if (base < length)
+		{
+			char padded[blockSize];
+
+			std::memset(padded, ' ', blockSize);
+			std::memcpy(padded, src + base, length - base);
+
+			if (!scanner.scan(classify(padded), structurals))
+				return false;
+
+			flatten(structurals, offset + (uint32_t)base, out, count);
+		}
+
+		return true;
+	}
+
+	static bool indexScalar(const char* src, size_t length, uint32_t offset, BlockScanner& scanner, uint32_t* out, size_t& count)
+	{
+		return indexBlocks<classifyScalar>(src, length, offset, scanner, out, count);
+	}
+
+#ifdef HIRZEL_JSON_X86_DISPATCH
+
+	HIRZEL_JSON_TARGET("sse4.2,popcnt")
+	static bool indexSse42(const char* src, size_t length, uint32_t offset, BlockScanner& scanner, uint32_t* out, size_t& count)
+	{
+		return indexBlocks<classifySse42>(src, length, offset, scanner, out, count);
+	}
+
+	HIRZEL_JSON_TARGET("avx2,bmi,popcnt")
+	static bool indexAvx2(const char* src, size_t length, uint32_t offset, BlockScanner& scanner, uint32_t* out, size_t& count)
+	{
+		return indexBlocks<classifyAvx2>(src, length, offset, scanner, out, count);
+	}
+
+#endif
+
+	static Indexer selectIndexer()
+	{
+#ifdef HIRZEL_JSON_X86_DISPATCH
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") && __builtin_cpu_supports("popcnt"))
+			return indexAvx2;
+
+		if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+			return indexSse42;
+#endif
+		return indexScalar;
+	}
+
+	static Indexer indexer()
+	{
+		static const auto selected = selectIndexer();
+
+		return selected;
+	}
+
+	bool StructuralIndex::build(const char* src, size_t length)
+	{
+		_count = 0;
+
+		if (length >= std::numeric_limits<uint32_t>::max() - blockSize)
+			return false;
+
+		auto index = indexer();
+		auto scanner = BlockScanner();
+
+		for (size_t base = 0; base < length; base += chunkSize)
+		{
+			auto chunkLength = std::min(chunkSize, length - base);
+
+			// Every byte of the chunk could start a token, plus slack for
+			// flatten and the NUL
+			reserve(_count + chunkLength + blockSize + 1);
+
+			if (!index(src + base, chunkLength, (uint32_t)base, scanner, _positions.get(), _count))
+			{
+				_count = 0;
+				return false;
+			}
+		}
+
+		reserve(_count + 1);
+		_positions[_count] = (uint32_t)length;
+		_count += 1;
+
+		return true;
+	}
+
+	void StructuralIndex::reserve(size_t capacity)
+	{
+		if (_capacity >= capacity)
+			return;
+
+		auto grown = std::max(capacity, _capacity * 2);
+		auto positions = std::unique_ptr<uint32_t[]>(new uint32_t[grown]);
+
+		if (_count > 0)
+			std::memcpy(positions.get(), _positions.get(), _count * sizeof(uint32_t));
+
+		_positions = std::move(positions);
+		_capacity = grown;
+	}
+
+	const char* StructuralIndex::implementationName()
+	{
+		auto selected = indexer();
+
+#ifdef HIRZEL_JSON_X86_DISPATCH
+		if (selected == indexAvx2)
+			return "avx2";
+
+		if (selected == indexSse42)
+			return "sse4.2";
+#endif
+
+		return selected == indexScalar
+			? "scalar"
+			: "unknown";
+	}
+}
@@ -0,0 +1,239 @@
+#include <hirzel/json/Tape.hpp>
+#include <hirzel/json/TapeValue.hpp>
+#include <hirzel/json/parse.hpp>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace hirzel::json
+{
+	struct TapeHeader
+	{
+		char magic[8];
+		uint32_t version;
+		// Reads back as something else on a machine of the other byte order
+		uint32_t byteOrder;
+		uint64_t wordCount;
+		uint64_t stringLength;
+	};
+
+	static constexpr char tapeMagic[8] = { 'H', 'J', 'S', 'O', 'N', 'T', 'A', 'P' };
+	static constexpr uint32_t tapeByteOrder = 0x01020304;
+
+	static uint64_t makeWord(Tape::Tag tag, uint64_t payload)
+	{
+		return ((uint64_t)tag << 56) | payload;
+	}
+
+	/*
+	 * Appends to the tape as the event parser walks the document. Container
+	 * start words are written as placeholders and completed at their end,
+	 * once their size and extent are known.
+	 */
+	class TapeBuilder
+	{
+		struct Container
+		{
+			size_t start;
+			uint64_t count;
+		};
+
+		std::vector<uint64_t>& _words;
+		std::vector<char>& _strings;
+		std::vector<Container> _open;
+
+	private:
+
+		void addElement()
+		{
+			if (!_open.empty() && Tape::tagOf(_words[_open.back().start]) == Tape::Tag::StartArray)
+				_open.back().count += 1;
+		}
+
+		void addString(std::string_view text)
+		{
+			if (text.size() > std::numeric_limits<uint32_t>::max())
+				throw std::runtime_error("String is too long to store in a tape.");
+
+			auto offset = _strings.size();
+			auto length = (uint32_t)text.size();
+
+			_strings.resize(offset + sizeof(length) + text.size() + 1);
+			std::memcpy(&_strings[offset], &length, sizeof(length));
+			std::memcpy(&_strings[offset + sizeof(length)], text.data(), text.size());
+			_strings.back() = '\0';
+			_words.push_back(makeWord(Tape::Tag::String, offset));
+		}
+
+		void start(Tape::Tag tag)
+		{
+			addElement();
+			_open.push_back({ _words.size(), 0 });
+			_words.push_back(makeWord(tag, 0));
+		}
+
+		void end(Tape::Tag tag)
+		{
+			auto container = _open.back();
+
+			_open.pop_back();
+			_words.push_back(makeWord(tag, container.start));
+
+			if (_words.size() > std::numeric_limits<uint32_t>::max())
+				throw std::runtime_error("Document is too large to store in a tape.");
+
+			auto count = std::min(container.count, Tape::maxCount);
+
+			_words[container.start] |= (count << 32) | _words.size();
+		}
+
+	public:
+
+		TapeBuilder(std::vector<uint64_t>& words, std::vector<char>& strings) :
+			_words(words),
+			_strings(strings)
+		{}
+
+		void onNull()
+		{
+			addElement();
+			_words.push_back(makeWord(Tape::Tag::Null, 0));
+		}
+
+		void onBoolean(bool value)
+		{
+			addElement();
+			_words.push_back(makeWord(value ? Tape::Tag::True : Tape::Tag::False, 0));
+		}
+
+		void onNumber(double value)
+		{
+			uint64_t bits;
+
+			std::memcpy(&bits, &value, sizeof(bits));
+			addElement();
+			_words.push_back(makeWord(Tape::Tag::Number, 0));
+			_words.push_back(bits);
+		}
+
+		void onString(std::string_view value)
+		{
+			addElement();
+			addString(value);
+		}
+
+		void onKey(std::string_view key)
+		{
+			_open.back().count += 1;
+			addString(key);
+		}
+
+		void onStartObject() { start(Tape::Tag::StartObject); }
+		void onEndObject() { end(Tape::Tag::EndObject); }
+		void onStartArray() { start(Tape::Tag::StartArray); }
+		void onEndArray() { end(Tape::Tag::EndArray); }
+	};
+
+	Tape::Tape() :
+		_words(nullptr),
+		_wordCount(0),
+		_strings(nullptr),
+		_stringLength(0)
+	{}
+
+	Tape::Tape(const char* json) :
+		Tape(json, std::strlen(json))
+	{}
+
+	Tape::Tape(const std::string& json) :
+		Tape(json.c_str(), json.length())
+	{}
+
+	Tape::Tape(const char* json, size_t length) :
+		Tape()
+	{
+		// Rough upper bounds for typical documents, to avoid most regrowth
+		_wordStorage.reserve(length / 4 + 1);
+		_stringStorage.reserve(length / 2 + 1);
+
+		auto builder = TapeBuilder(_wordStorage, _stringStorage);
+
+		parse(json, length, builder);
+
+		_words = _wordStorage.data();
+		_wordCount = _wordStorage.size();
+		_strings = _stringStorage.data();
+		_stringLength = _stringStorage.size();
+	}
+
+	Tape Tape::load(const std::string& filepath)
+	{
+		auto tape = Tape();
+		auto& file = tape._file.emplace(filepath, false);
+		auto header = TapeHeader();
+
+		if (file.length() < sizeof(header))
+			throw std::runtime_error("File '" + filepath + "' is not a tape.");
+
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		if (std::memcmp(header.magic, tapeMagic, sizeof(tapeMagic)) != 0)
+			throw std::runtime_error("File '" + filepath + "' is not a tape.");
+
+		if (header.byteOrder != tapeByteOrder)
+			throw std::runtime_error("Tape '" + filepath + "' was written with a different byte order.");
+
+		if (header.version != version)
+			throw std::runtime_error("Tape '" + filepath + "' has unsupported version " + std::to_string(header.version) + ".");
+
+		auto wordBytes = header.wordCount * sizeof(uint64_t);
+
+		if (header.wordCount == 0
+			|| header.wordCount > std::numeric_limits<uint32_t>::max()
+			|| file.length() != sizeof(header) + wordBytes + header.stringLength)
+			throw std::runtime_error("Tape '" + filepath + "' is truncated or corrupt.");
+
+		// The header keeps the words 8-byte aligned within the page-aligned file
+		tape._words = (const uint64_t*)(file.data() + sizeof(header));
+		tape._wordCount = (size_t)header.wordCount;
+		tape._strings = file.data() + sizeof(header) + wordBytes;
+		tape._stringLength = (size_t)header.stringLength;
+
+		return tape;
+	}
+
+	void Tape::write(std::ostream& out) const
+	{
+		auto header = TapeHeader();
+
+		std::memcpy(header.magic, tapeMagic, sizeof(tapeMagic));
+		header.version = version;
+		header.byteOrder = tapeByteOrder;
+		header.wordCount = _wordCount;
+		header.stringLength = _stringLength;
+
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)_words, (std::streamsize)(_wordCount * sizeof(uint64_t)));
+		out.write(_strings, (std::streamsize)_stringLength);
+	}
+
+	void Tape::save(const std::string& filepath) const
+	{
+		auto file = std::ofstream(filepath, std::ios::binary);
+
+		if (!file.is_open())
+			throw std::runtime_error("Failed to open file '" + filepath + "' for writing.");
+
+		write(file);
+		file.close();
+
+		if (!file)
+			throw std::runtime_error("Failed to write tape to '" + filepath + "'.");
+	}
+
+	TapeValue Tape::root() const
+	{
+		return TapeValue(*this, 0);
+	}
+}
@@ -0,0 +1,204 @@
+#include <hirzel/json/TapeValue.hpp>
+#include <cstring>
+
+namespace hirzel::json
+{
+	TapeValue::TapeValue(const Tape& tape, size_t index) :
+		_tape(&tape),
+		_index(index)
+	{}
+
+	size_t TapeValue::next() const
+	{
+		switch (tag())
+		{
+		case Tape::Tag::Number:
+			return _index + 2;
+
+		case Tape::Tag::StartArray:
+		case Tape::Tag::StartObject:
+			return (size_t)(Tape::payloadOf(word()) & 0xFFFFFFFF);
+
+		default:
+			return _index + 1;
+		}
+	}
+
+	ValueType TapeValue::type() const
+	{
+		switch (tag())
+		{
+		case Tape::Tag::StartObject:
+			return ValueType::Object;
+
+		case Tape::Tag::StartArray:
+			return ValueType::Array;
+
+		case Tape::Tag::String:
+			return ValueType::String;
+
+		case Tape::Tag::Number:
+			return ValueType::Number;
+
+		case Tape::Tag::True:
+		case Tape::Tag::False:
+			return ValueType::Boolean;
+
+		default:
+			return ValueType::Null;
+		}
+	}
+
+	double TapeValue::number() const
+	{
+		if (!isNumber())
+			throw std::runtime_error("Value is not a number.");
+
+		auto bits = (*_tape)[_index + 1];
+		double value;
+
+		std::memcpy(&value, &bits, sizeof(value));
+
+		return value;
+	}
+
+	bool TapeValue::boolean() const
+	{
+		if (!isBoolean())
+			throw std::runtime_error("Value is not a boolean.");
+
+		return tag() == Tape::Tag::True;
+	}
+
+	std::string_view TapeValue::string() const
+	{
+		if (!isString())
+			throw std::runtime_error("Value is not a string.");
+
+		return _tape->stringAt(Tape::payloadOf(word()));
+	}
+
+	size_t TapeValue::length() const
+	{
+		if (isString())
+			return string().length();
+
+		if (!isArray() && !isObject())
+			return 0;
+
+		auto count = Tape::payloadOf(word()) >> 32;
+
+		if (count < Tape::maxCount)
+			return (size_t)count;
+
+		// Saturated, so the container has to be counted
+		size_t length = 0;
+
+		if (isArray())
+			forEachElement([&](const TapeValue&) { length += 1; });
+		else
+			forEachMember([&](std::string_view, const TapeValue&) { length += 1; });
+
+		return length;
+	}
+
+	Value TapeValue::value() const
+	{
+		switch (tag())
+		{
+		case Tape::Tag::Number:
+			return Value(number());
+
+		case Tape::Tag::True:
+			return Value(true);
+
+		case Tape::Tag::False:
+			return Value(false);
+
+		case Tape::Tag::String:
+			return Value(std::string(string()));
+
+		case Tape::Tag::StartArray:
+		{
+			auto out = Array();
+
+			out.reserve(length());
+			forEachElement([&](const TapeValue& element) { out.emplace_back(element.value()); });
+
+			return out;
+		}
+
+		case Tape::Tag::StartObject:
+		{
+			auto out = Object();
+
+			out.reserve(length());
+			forEachMember([&](std::string_view key, const TapeValue& member) { out.emplace(Key(key), member.value()); });
+
+			return out;
+		}
+
+		default:
+			return Value();
+		}
+	}
+
+	std::optional<TapeValue> TapeValue::at(size_t i) const
+	{
+		if (!isArray())
+			throw std::runtime_error("Value is not an array.");
+
+		auto end = (size_t)(Tape::payloadOf(word()) & 0xFFFFFFFF) - 1;
+		auto element = TapeValue(*_tape, _index + 1);
+
+		for (size_t index = 0; element._index < end; ++index)
+		{
+			if (index == i)
+				return element;
+
+			element._index = element.next();
+		}
+
+		return std::nullopt;
+	}
+
+	std::optional<TapeValue> TapeValue::at(std::string_view key) const
+	{
+		if (!isObject())
+			throw std::runtime_error("Value is not an object.");
+
+		auto end = (size_t)(Tape::payloadOf(word()) & 0xFFFFFFFF) - 1;
+
+		for (auto index = _index + 1; index < end; )
+		{
+			auto member = TapeValue(*_tape, index + 1);
+
+			if (_tape->stringAt(Tape::payloadOf((*_tape)[index])) == key)
+				return member;
+
+			index = member.next();
+		}
+
+		return std::nullopt;
+	}
+
+	TapeValue TapeValue::operator[](size_t i) const
+	{
+		auto element = at(i);
+
+		if (!element)
+			throw std::runtime_error("Index " + std::to_string(i) + " is out of bounds.");
+
+		return *element;
+	}
+
+	TapeValue TapeValue::operator[](std::string_view key) const
+	{
+		auto member = at(key);
+
+		if (!member)
+			throw std::runtime_error("No member with key '" + std::string(key) + "' exists.");
+
+		return *member;
+	}
+}
@@ -1,24 +1,44 @@
 #include "hirzel/print.hpp"
 #include <hirzel/json/Token.hpp>
+#include <hirzel/json/StructuralIndex.hpp>
+#include <hirzel/json/number.hpp>
+#include <hirzel/json/string.hpp>
 #include <string>
 #include <stdexcept>
 #include <cassert>
 #include <cctype>
+#include <cstdint>
+#include <cstring>
 
 namespace hirzel::json
 {
+	// Below this size building the index costs more than it saves
+	static constexpr size_t minIndexedLength = 256;
+
 	Token::Token(const char* src, size_t pos, size_t length, TokenType type) :
 	_src(src),
+	_structural(nullptr),
 	_pos(pos),
 	_length(length),
-	_type(type)
+	_srcLength(SIZE_MAX),
+	_type(type),
+	_error(ParseError::None)
 	{}
 
-	static size_t endOfLineCommentPos(const char* src, size_t pos)
+	Token Token::invalid(const char* src, size_t pos, ParseError error)
+	{
+		auto token = Token(src, pos, 0, TokenType::Invalid);
+
+		token._error = error;
+
+		return token;
+	}
+
+	static size_t endOfLineCommentPos(const char* src, size_t pos, size_t end)
 	{
 		size_t i;
 
-		for (i = pos; src[i]; ++i)
+		for (i = pos; i < end && src[i]; ++i)
 		{
 			if (src[i] == '\n')
 			{
@@ -30,11 +50,11 @@ namespace hirzel::json
 		return i;
 	}
 
-	static size_t endOfBlockCommentPos(const char* src, size_t pos)
+	static size_t endOfBlockCommentPos(const char* src, size_t pos, size_t end)
 	{
 		size_t i;
 
-		for (i = pos; src[i]; ++i)
+		for (i = pos; i < end && src[i]; ++i)
 		{
 			if (src[i] == '*' && src[i + 1] == '/')
 			{
@@ -46,13 +66,15 @@ namespace hirzel::json
 		return i;
 	}
 
-	static size_t nextTokenPos(const char* src, size_t pos)
+	static size_t nextTokenPos(const char* src, size_t pos, size_t end)
 	{
 		size_t i;
 
-		for (i = pos; src[i]; ++i)
+		for (i = pos; i < end && src[i]; ++i)
 		{
-			auto c = src[i];
+			// Unsigned, as in the structural index, so bytes past ASCII are not
+			// taken for whitespace
+			auto c = (unsigned char)src[i];
 
 			if (c <= ' ')
 				continue;
@@ -62,11 +84,11 @@ namespace hirzel::json
 				switch (src[i + 1])
 				{
 				case '/':
-					i = endOfLineCommentPos(src, i + 2) - 1;
+					i = endOfLineCommentPos(src, i + 2, end) - 1;
 					continue;
 
 				case '*':
-					i = endOfBlockCommentPos(src, i + 2) - 1;
+					i = endOfBlockCommentPos(src, i + 2, end) - 1;
 					continue;
 
 				default:
@@ -80,38 +102,16 @@ namespace hirzel::json
 		return i;
 	}
 
-	static std::runtime_error unexpectedToken(const char* src, size_t startPos)
-	{
-		size_t i = startPos;
-
-		while (isalpha(src[i]))
-			i += 1;
-
-		throw std::runtime_error("Unexpected token '"
-			+ std::string(src, i - startPos)
-			+ "' at pos: "
-			+ std::to_string(startPos)
-			+ ".");
-	}
-
-	static Token parseStringToken(const char* src, const size_t startPos)
+	static Token parseStringToken(const char* src, const size_t startPos, size_t srcLength)
 	{
 		assert(src[startPos] == '\"');
 
-		size_t i = startPos + 1;
-
-		while (true)
-		{
-			if (src[i] == '\"')
-				break;
-
-			if (src[i] == '\0')
-				throw std::runtime_error("Unterminated string: " + std::string(src, i - startPos) + ".");
+		const auto* end = skipString(src + startPos + 1);
 
-			i += 1;
-		}
+		if (*end == '\0' || (size_t)(end - src) >= srcLength)
+			return Token::invalid(src, startPos, ParseError::UnterminatedString);
 
-		i += 1;
+		auto i = (size_t)(end - src) + 1;
 
 		return Token(src, startPos, i - startPos, TokenType::String);
 	}
@@ -137,7 +137,7 @@ namespace hirzel::json
 			i += 1;
 
 			if (!isdigit(src[i]))
-				throw std::runtime_error("Expected number after '-'.");
+				return Token::invalid(src, start, ParseError::InvalidNumber);
 		}
 
 		i += numberLength(&src[i]);
@@ -149,7 +149,7 @@ namespace hirzel::json
 			auto fractionLength = numberLength(&src[i]);
 
 			if (fractionLength == 0)
-				throw std::runtime_error("Expected fractional part of number after '.'.");
+				return Token::invalid(src, start, ParseError::InvalidNumber);
 
 			i += fractionLength;
 		}
@@ -157,22 +157,25 @@ namespace hirzel::json
 		switch (src[i])
 		{
 		case '.':
-			throw std::runtime_error("Invalid number format.");
+			return Token::invalid(src, start, ParseError::InvalidNumber);
 
 		case 'e':
 		case 'E':
 		{
 			i += 1;
 
+			if (src[i] == '+' || src[i] == '-')
+				i += 1;
+
 			auto exponentLength = numberLength(&src[i]);
 
 			if (exponentLength == 0)
-				throw std::runtime_error("Number is missing exponent at pos: " + std::to_string(i) + ".");
+				return Token::invalid(src, start, ParseError::InvalidNumber);
 
 			i += exponentLength;
 
 			if (src[i] == '.')
-				throw std::runtime_error("Exponents must be integers.");
+				return Token::invalid(src, start, ParseError::InvalidNumber);
 			break;
 		}
 
@@ -193,7 +196,7 @@ namespace hirzel::json
 		if (src[pos + 1] == 'r' && src[pos + 2] == 'u' && src[pos + 3] == 'e' && !isalpha(src[pos + 4]))
 			return Token(src, pos, 4, TokenType::True);
 
-		throw unexpectedToken(src, pos);
+		return Token::invalid(src, pos, ParseError::InvalidLiteral);
 	}
 
 	static Token parseFalseToken(const char* src, size_t pos)
@@ -203,7 +206,7 @@ namespace hirzel::json
 		if (src[pos + 1] == 'a' && src[pos + 2] == 'l' && src[pos + 3] == 's' && src[pos + 4] == 'e' && !isalpha(src[pos + 5]))
 			return Token(src, pos, 5, TokenType::False);
 
-		throw unexpectedToken(src, pos);
+		return Token::invalid(src, pos, ParseError::InvalidLiteral);
 	}
 
 	static Token parseNullToken(const char* src, size_t pos)
@@ -213,11 +216,14 @@ namespace hirzel::json
 		if (src[pos + 1] == 'u' && src[pos + 2] == 'l' && src[pos + 3] == 'l' && !isalpha(src[pos + 4]))
 			return Token(src, pos, 4, TokenType::Null);
 
-		throw unexpectedToken(src, pos);
+		return Token::invalid(src, pos, ParseError::InvalidLiteral);
 	}
 
-	static Token parseToken(const char* src, size_t pos)
+	static Token parseToken(const char* src, size_t pos, size_t srcLength)
 	{
+		if (pos >= srcLength)
+			return Token(src, pos, 1, TokenType::EndOfFile);
+
 		auto c = src[pos];
 
 		switch (c)
@@ -244,7 +250,7 @@ namespace hirzel::json
 			return Token(src, pos, 1, TokenType::Colon);
 
 		case '\"':
-			return parseStringToken(src, pos);
+			return parseStringToken(src, pos, srcLength);
 
 		case '0':
 		case '1':
@@ -269,28 +275,304 @@ namespace hirzel::json
 			return parseNullToken(src, pos);
 
 		default:
-			throw std::runtime_error(std::string("Unexpected token '") + src[pos] + "' at pos: " + std::to_string(pos));
+			return Token::invalid(src, pos, ParseError::UnexpectedCharacter);
 		}
 	}
 
+	static Token firstToken(const char* src, size_t length)
+	{
+		return parseToken(src, nextTokenPos(src, 0, length), length);
+	}
+
+	static Token firstToken(const char* src, size_t length, const StructuralIndex& index)
+	{
+		assert(!index.isEmpty());
+
+		return parseToken(src, *index.positions(), length);
+	}
+
 	Token Token::initialFor(const char* src)
 	{
-		auto pos = nextTokenPos(src, 0);
-		auto token = parseToken(src, pos);
+		auto token = firstToken(src, SIZE_MAX);
+
+		token.throwIfInvalid();
+
+		return token;
+	}
+
+	Token Token::initialFor(const char* src, const StructuralIndex& index)
+	{
+		auto token = firstToken(src, SIZE_MAX, index);
+
+		token.throwIfInvalid();
+		token._structural = index.positions() + 1;
+
+		return token;
+	}
+
+	Token Token::initialFor(const char* src, size_t length, StructuralIndex& index)
+	{
+		auto token = tryInitialFor(src, length, index);
+
+		token.throwIfInvalid();
+
+		return token;
+	}
+
+	Token Token::tryInitialFor(const char* src, size_t length, StructuralIndex& index)
+	{
+		if (length < minIndexedLength || !index.build(src, length))
+		{
+			auto token = firstToken(src, length);
+
+			token._srcLength = length;
+
+			return token;
+		}
+
+		auto token = firstToken(src, length, index);
+
+		token._srcLength = length;
+		token._structural = index.positions() + 1;
 
 		return token;
 	}
 
 	void Token::seekNext()
 	{
-		auto pos = nextTokenPos(_src, _pos + _length);
-		auto token = parseToken(_src, pos);
+		if (!trySeekNext())
+			throwIfInvalid();
+	}
+
+	bool Token::trySeekNext()
+	{
+		if (_type == TokenType::Invalid)
+			return false;
+
+		auto srcLength = _srcLength;
+
+		if (_structural == nullptr)
+		{
+			auto pos = nextTokenPos(_src, _pos + _length, srcLength);
+			auto token = parseToken(_src, pos, srcLength);
+
+			new(this) auto(std::move(token));
+			_srcLength = srcLength;
+
+			return _type != TokenType::Invalid;
+		}
+
+		if (_type == TokenType::EndOfFile)
+			return true;
+
+		auto end = _pos + _length;
+		auto pos = (size_t)*_structural;
+
+		// The index only records where runs of non-whitespace start, so a token
+		// that stops short of the next run must be followed by whitespace.
+		if (pos < end || (pos != end && (unsigned char)_src[end] > ' '))
+		{
+			new(this) auto(Token::invalid(_src, end, ParseError::UnexpectedCharacter));
+			return false;
+		}
+
+		auto structural = _structural + 1;
+		auto token = parseToken(_src, pos, srcLength);
 
 		new(this) auto(std::move(token));
+		_srcLength = srcLength;
+		_structural = structural;
+
+		return _type != TokenType::Invalid;
+	}
+
+	void Token::throwIfInvalid() const
+	{
+		if (_type != TokenType::Invalid)
+			return;
+
+		auto message = std::string(describe(_error));
+
+		if (_error == ParseError::UnexpectedCharacter)
+			message += std::string(" '") + _src[_pos] + "'";
+
+		throw std::runtime_error(message + " at pos: " + std::to_string(_pos) + ".");
+	}
+
+	size_t Token::skipValue()
+	{
+		if (_type != TokenType::LeftBrace && _type != TokenType::LeftBracket)
+		{
+			auto end = _pos + _length;
+
+			seekNext();
+
+			return end;
+		}
+
+		size_t depth = 1;
+
+		if (_structural == nullptr)
+		{
+			while (depth > 0)
+			{
+				seekNext();
+
+				switch (_type)
+				{
+				case TokenType::LeftBrace:
+				case TokenType::LeftBracket:
+					depth += 1;
+					break;
+
+				case TokenType::RightBrace:
+				case TokenType::RightBracket:
+					depth -= 1;
+					break;
+
+				case TokenType::EndOfFile:
+					throw std::runtime_error("Unexpected end of file.");
+
+				default:
+					break;
+				}
+			}
+
+			auto end = _pos + _length;
+
+			seekNext();
+
+			return end;
+		}
+
+		// Only the first byte of each indexed token is needed to match brackets
+		auto structural = _structural;
+
+		while (depth > 0)
+		{
+			// The last entry is the end of the text, which need not be a terminator
+			if (*structural >= _srcLength)
+				throw std::runtime_error("Unexpected end of file.");
+
+			switch (_src[*structural])
+			{
+			case '{':
+			case '[':
+				depth += 1;
+				break;
+
+			case '}':
+			case ']':
+				depth -= 1;
+				break;
+
+			case '\0':
+				throw std::runtime_error("Unexpected end of file.");
+
+			default:
+				break;
+			}
+
+			structural += 1;
+		}
+
+		auto end = (size_t)structural[-1] + 1;
+		auto srcLength = _srcLength;
+		auto token = parseToken(_src, *structural, srcLength);
+
+		new(this) auto(std::move(token));
+		_srcLength = srcLength;
+		_structural = structural + 1;
+		throwIfInvalid();
+
+		return end;
+	}
+
+	bool Token::trySkipValidValue(std::string& buffer, size_t depth)
+	{
+		switch (_type)
+		{
+		case TokenType::String:
+		{
+			auto text = std::string_view(_src + _pos + 1, _length - 2);
+			auto escapeOffset = (size_t)0;
+
+			if (findEscape(text) != text.size() && tryUnescape(text, buffer, escapeOffset) != ParseError::None)
+				return false;
+
+			return trySeekNext();
+		}
+
+		case TokenType::Number:
+		{
+			auto number = 0.0;
+
+			return parseNumber(_src + _pos, _length, number) && trySeekNext();
+		}
+
+		case TokenType::True:
+		case TokenType::False:
+		case TokenType::Null:
+			return trySeekNext();
+
+		case TokenType::LeftBrace:
+		case TokenType::LeftBracket:
+			break;
+
+		default:
+			return false;
+		}
+
+		if (depth >= maxParseDepth)
+			return false;
+
+		auto isObject = _type == TokenType::LeftBrace;
+		auto close = isObject
+			? TokenType::RightBrace
+			: TokenType::RightBracket;
+
+		if (!trySeekNext())
+			return false;
+
+		if (_type == close)
+			return trySeekNext();
+
+		while (true)
+		{
+			if (isObject)
+			{
+				if (_type != TokenType::String || !trySkipValidValue(buffer, depth + 1))
+					return false;
+
+				if (_type != TokenType::Colon || !trySeekNext())
+					return false;
+			}
+
+			if (!trySkipValidValue(buffer, depth + 1))
+				return false;
+
+			if (_type == close)
+				return trySeekNext();
+
+			if (_type != TokenType::Comma || !trySeekNext())
+				return false;
+		}
 	}
 
 	std::string Token::text() const
 	{
 		return std::string(&_src[_pos], _length);
 	}
+
+	double Token::number() const
+	{
+		assert(_type == TokenType::Number);
+
+		double out;
+
+		if (!parseNumber(&_src[_pos], _length, out))
+			throw std::runtime_error("Invalid number format: '" + text() + "'.");
+
+		return out;
+	}
 }
@@ -0,0 +1,768 @@
+#include <hirzel/json/Validator.hpp>
+#include <hirzel/json/StructuralIndex.hpp>
+#include <hirzel/json/number.hpp>
+#include <hirzel/json/string.hpp>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace hirzel::json
+{
+	// Limits of the integer type, which the bounds of # default to
+	static constexpr double minInteger = -9223372036854775808.0;
+	static constexpr double maxInteger = 9223372036854775808.0;
+
+	class Validator::Parser
+	{
+		std::string_view _text;
+		size_t _pos;
+		size_t _depth;
+		std::vector<Instruction>& _program;
+		std::vector<uint32_t>& _children;
+
+	public:
+
+		Parser(std::string_view text, std::vector<Instruction>& program, std::vector<uint32_t>& children) :
+			_text(text),
+			_pos(0),
+			_depth(0),
+			_program(program),
+			_children(children)
+		{}
+
+		[[noreturn]] void fail(const char* reason) const
+		{
+			throw std::runtime_error("Invalid format '" + std::string(_text) + "' at pos: "
+				+ std::to_string(_pos) + ": " + reason + ".");
+		}
+
+		bool isDone() const { return _pos == _text.length(); }
+		char peek() const { return isDone() ? '\0' : _text[_pos]; }
+
+		bool accept(char c)
+		{
+			if (peek() != c)
+				return false;
+
+			_pos += 1;
+
+			return true;
+		}
+
+		void expect(char c, const char* reason)
+		{
+			if (!accept(c))
+				fail(reason);
+		}
+
+		void skipSpaces()
+		{
+			while (peek() == ' ' || peek() == '\t' || peek() == '\n' || peek() == '\r')
+				_pos += 1;
+		}
+
+		std::string key()
+		{
+			if (peek() == '\'' || peek() == '\"')
+			{
+				auto quote = peek();
+				auto start = _pos + 1;
+
+				_pos = _text.find(quote, start);
+
+				if (_pos == std::string_view::npos)
+				{
+					_pos = _text.length();
+					fail("unterminated key");
+				}
+
+				_pos += 1;
+
+				return std::string(_text.substr(start, _pos - start - 1));
+			}
+
+			auto start = _pos;
+
+			while (!isDone() && (std::isalnum((unsigned char)peek()) || peek() == '_' || peek() == '-'))
+				_pos += 1;
+
+			if (_pos == start)
+				fail("expected a key");
+
+			return std::string(_text.substr(start, _pos - start));
+		}
+
+		double bound(double limit)
+		{
+			skipSpaces();
+
+			if (accept('~'))
+				return limit;
+
+			auto start = _pos;
+			auto number = 0.0;
+
+			while (!isDone() && std::strchr("+-.0123456789eE", peek()) != nullptr)
+				_pos += 1;
+
+			if (_pos == start || !parseNumber(_text.data() + start, _pos - start, number))
+				fail("expected a bound");
+
+			skipSpaces();
+
+			return number;
+		}
+
+		void range(Instruction& instruction)
+		{
+			if (peek() != '[' && peek() != '(')
+				return;
+
+			instruction.isMinExclusive = peek() == '(';
+			_pos += 1;
+			instruction.min = bound(instruction.min);
+			expect(',', "expected ','");
+			instruction.max = bound(instruction.max);
+
+			if (accept(')'))
+				instruction.isMaxExclusive = true;
+			else
+				expect(']', "expected ']' or ')'");
+
+			if (instruction.min > instruction.max)
+				fail("lower bound is above upper bound");
+		}
+
+		void members(std::vector<uint32_t>& children)
+		{
+			skipSpaces();
+
+			if (accept('}'))
+				return;
+
+			while (true)
+			{
+				skipSpaces();
+
+				auto name = key();
+
+				skipSpaces();
+				expect(':', "expected ':'");
+
+				auto member = type();
+
+				for (auto sibling : children)
+				{
+					if (_program[sibling].key == name)
+						fail("duplicate key");
+				}
+
+				_program[member].hash = Object::hash(name);
+				_program[member].key = std::move(name);
+				children.push_back((uint32_t)member);
+				skipSpaces();
+
+				if (accept(','))
+					continue;
+
+				expect('}', "expected ',' or '}'");
+				break;
+			}
+		}
+
+		void elements(size_t index, std::vector<uint32_t>& children)
+		{
+			skipSpaces();
+
+			if (accept(']'))
+				return;
+
+			while (true)
+			{
+				children.push_back((uint32_t)type());
+				skipSpaces();
+
+				if (_text.substr(_pos, 3) == "...")
+				{
+					_pos += 3;
+					_program[index].isVariadic = true;
+					skipSpaces();
+					expect(']', "only the last element may repeat");
+					break;
+				}
+
+				if (accept(','))
+					continue;
+
+				expect(']', "expected ',' or ']'");
+				break;
+			}
+		}
+
+		size_t type()
+		{
+			skipSpaces();
+
+			if (_depth == maxParseDepth)
+				fail("nesting is too deep");
+
+			auto index = _program.size();
+			auto& instruction = _program.emplace_back();
+
+			instruction.isNullable = false;
+			instruction.isMinExclusive = false;
+			instruction.isMaxExclusive = false;
+			instruction.isVariadic = false;
+			instruction.min = -DBL_MAX;
+			instruction.max = DBL_MAX;
+			instruction.firstChild = 0;
+			instruction.childCount = 0;
+			instruction.hash = 0;
+
+			switch (peek())
+			{
+			case '#':
+				_pos += 1;
+				instruction.check = Check::Integer;
+				instruction.min = minInteger;
+				instruction.max = maxInteger;
+				range(instruction);
+				break;
+
+			case '%':
+				_pos += 1;
+				instruction.check = Check::Number;
+				range(instruction);
+				break;
+
+			case '$':
+				_pos += 1;
+				instruction.check = Check::String;
+				break;
+
+			case '&':
+				_pos += 1;
+				instruction.check = Check::Boolean;
+				break;
+
+			case '{':
+			case '[':
+			{
+				auto isObject = peek() == '{';
+				auto children = std::vector<uint32_t>();
+
+				_pos += 1;
+				_depth += 1;
+				instruction.check = isObject ? Check::Object : Check::Array;
+
+				if (isObject)
+					members(children);
+				else
+					elements(index, children);
+
+				_depth -= 1;
+				// Children are listed once complete, so those of nested
+				// containers never interleave with them
+				_program[index].firstChild = (uint32_t)_children.size();
+				_program[index].childCount = (uint32_t)children.size();
+				_children.insert(_children.end(), children.begin(), children.end());
+				break;
+			}
+
+			default:
+				fail("expected a type");
+			}
+
+			skipSpaces();
+
+			if (accept('?'))
+				_program[index].isNullable = true;
+
+			return index;
+		}
+
+		void parse()
+		{
+			type();
+			skipSpaces();
+
+			if (!isDone())
+				fail("unexpected character");
+		}
+	};
+
+	struct Validator::Report
+	{
+		std::vector<std::string>& errors;
+		std::string path;
+
+		bool reject(const std::string& reason)
+		{
+			errors.push_back((path.empty() ? std::string("root") : path) + ": " + reason + ".");
+
+			return false;
+		}
+
+		// Appends a JSON pointer segment and returns the previous length
+		size_t push(std::string_view segment)
+		{
+			auto length = path.length();
+
+			path += '/';
+
+			for (auto c : segment)
+			{
+				if (c == '~')
+					path += "~0";
+				else if (c == '/')
+					path += "~1";
+				else
+					path += c;
+			}
+
+			return length;
+		}
+	};
+
+	static std::string numberText(double number)
+	{
+		char buffer[maxNumberLength];
+
+		return std::string(buffer, formatNumber(number, buffer));
+	}
+
+	Validator::Validator(std::string_view format) :
+		_format(format)
+	{
+		auto parser = Parser(_format, _program, _children);
+
+		parser.parse();
+	}
+
+	const char* Validator::describe(Check check)
+	{
+		switch (check)
+		{
+		case Check::Integer:
+			return "integer";
+
+		case Check::Number:
+			return "number";
+
+		case Check::String:
+			return "string";
+
+		case Check::Boolean:
+			return "boolean";
+
+		case Check::Object:
+			return "object";
+
+		case Check::Array:
+			return "array";
+		}
+
+		return "value";
+	}
+
+	bool Validator::isInRange(const Instruction& instruction, double number)
+	{
+		auto isAboveMin = instruction.isMinExclusive
+			? number > instruction.min
+			: number >= instruction.min;
+		auto isBelowMax = instruction.isMaxExclusive
+			? number < instruction.max
+			: number <= instruction.max;
+
+		return isAboveMin && isBelowMax;
+	}
+
+	const Validator::Instruction* Validator::element(const Instruction& array, size_t i) const
+	{
+		if (i < array.childCount)
+			return &child(array, i);
+
+		if (array.isVariadic)
+			return &child(array, array.childCount - 1);
+
+		return nullptr;
+	}
+
+	size_t Validator::findMember(const Instruction& object, std::string_view key, uint32_t hash) const
+	{
+		for (size_t i = 0; i < object.childCount; ++i)
+		{
+			const auto& member = child(object, i);
+
+			if (member.hash == hash && member.key == key)
+				return i;
+		}
+
+		return object.childCount;
+	}
+
+	void Validator::SeenMembers::mark(size_t i)
+	{
+		if (i < 64)
+		{
+			_mask |= (uint64_t)1 << i;
+			return;
+		}
+
+		if (_rest.size() <= i - 64)
+			_rest.resize(i - 63);
+
+		_rest[i - 64] = true;
+	}
+
+	bool Validator::SeenMembers::isComplete(const Validator& validator, const Instruction& object) const
+	{
+		for (size_t i = 0; i < object.childCount; ++i)
+		{
+			auto isSeen = i < 64
+				? ((_mask >> i) & 1) != 0
+				: i - 64 < _rest.size() && _rest[i - 64];
+
+			if (!isSeen && !validator.child(object, i).isNullable)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool Validator::checkValue(const Instruction& instruction, const Value& value, Report* report) const
+	{
+		if (value.isNull())
+		{
+			if (instruction.isNullable)
+				return true;
+
+			return report ? report->reject(std::string("expected ") + describe(instruction.check) + ", got null") : false;
+		}
+
+		switch (instruction.check)
+		{
+		case Check::Integer:
+		case Check::Number:
+		{
+			if (!value.isNumber())
+				break;
+
+			auto number = value.number();
+
+			if (instruction.check == Check::Integer && number != std::floor(number))
+				return report ? report->reject("expected integer, got " + numberText(number)) : false;
+
+			if (!isInRange(instruction, number))
+				return report ? report->reject(numberText(number) + " is out of range") : false;
+
+			return true;
+		}
+
+		case Check::String:
+			if (!value.isString())
+				break;
+
+			return true;
+
+		case Check::Boolean:
+			if (!value.isBoolean())
+				break;
+
+			return true;
+
+		case Check::Array:
+		{
+			if (!value.isArray())
+				break;
+
+			const auto& array = value.array();
+			auto isValid = true;
+
+			if (instruction.isVariadic ? array.size() + 1 < instruction.childCount : array.size() != instruction.childCount)
+			{
+				if (!report)
+					return false;
+
+				isValid = report->reject("expected " + std::string(instruction.isVariadic ? "at least " : "")
+					+ std::to_string(instruction.isVariadic ? instruction.childCount - 1 : instruction.childCount)
+					+ " elements, got " + std::to_string(array.size()));
+			}
+
+			for (size_t i = 0; i < array.size(); ++i)
+			{
+				const auto* element = this->element(instruction, i);
+
+				if (element == nullptr)
+					break;
+
+				if (!report)
+				{
+					if (!checkValue(*element, array[i], nullptr))
+						return false;
+
+					continue;
+				}
+
+				auto length = report->push(std::to_string(i));
+
+				isValid = checkValue(*element, array[i], report) && isValid;
+				report->path.resize(length);
+			}
+
+			return isValid;
+		}
+
+		case Check::Object:
+		{
+			if (!value.isObject())
+				break;
+
+			const auto& object = value.object();
+			auto isValid = true;
+
+			for (size_t i = 0; i < instruction.childCount; ++i)
+			{
+				const auto& member = child(instruction, i);
+				auto iter = object.find(member.key, member.hash);
+
+				if (iter == object.end())
+				{
+					if (member.isNullable)
+						continue;
+
+					if (!report)
+						return false;
+
+					isValid = report->reject("missing member '" + member.key + "'");
+					continue;
+				}
+
+				if (!report)
+				{
+					if (!checkValue(member, iter->second, nullptr))
+						return false;
+
+					continue;
+				}
+
+				auto length = report->push(member.key);
+
+				isValid = checkValue(member, iter->second, report) && isValid;
+				report->path.resize(length);
+			}
+
+			return isValid;
+		}
+		}
+
+		return report ? report->reject(std::string("expected ") + describe(instruction.check) + ", got " + value.typeName()) : false;
+	}
+
+	bool Validator::checkToken(const Instruction& instruction, Token& token, std::string& buffer) const
+	{
+		if (token.type() == TokenType::Null)
+		{
+			token.seekNext();
+
+			return instruction.isNullable;
+		}
+
+		switch (instruction.check)
+		{
+		case Check::Integer:
+		case Check::Number:
+		{
+			if (token.type() != TokenType::Number)
+				return false;
+
+			auto number = token.number();
+
+			if (instruction.check == Check::Integer && number != std::floor(number))
+				return false;
+
+			token.seekNext();
+
+			return isInRange(instruction, number);
+		}
+
+		case Check::String:
+		{
+			if (token.type() != TokenType::String)
+				return false;
+
+			auto text = std::string_view(token.src() + token.pos() + 1, token.length() - 2);
+			size_t errorOffset = 0;
+
+			if (findEscape(text) != text.size() && tryUnescape(text, buffer, errorOffset) != ParseError::None)
+				return false;
+
+			token.seekNext();
+
+			return true;
+		}
+
+		case Check::Boolean:
+		{
+			auto isBoolean = token.type() == TokenType::True || token.type() == TokenType::False;
+
+			token.seekNext();
+
+			return isBoolean;
+		}
+
+		case Check::Array:
+		{
+			if (token.type() != TokenType::LeftBracket)
+				return false;
+
+			size_t count = 0;
+
+			token.seekNext();
+
+			if (token.type() != TokenType::RightBracket)
+			{
+				while (true)
+				{
+					const auto* element = this->element(instruction, count);
+
+					if (element == nullptr || !checkToken(*element, token, buffer))
+						return false;
+
+					count += 1;
+
+					if (token.type() == TokenType::Comma)
+					{
+						token.seekNext();
+						continue;
+					}
+
+					if (token.type() != TokenType::RightBracket)
+						return false;
+
+					break;
+				}
+			}
+
+			token.seekNext();
+
+			return instruction.isVariadic
+				? count + 1 >= instruction.childCount
+				: count == instruction.childCount;
+		}
+
+		case Check::Object:
+		{
+			if (token.type() != TokenType::LeftBrace)
+				return false;
+
+			auto seen = SeenMembers();
+
+			token.seekNext();
+
+			if (token.type() != TokenType::RightBrace)
+			{
+				while (true)
+				{
+					if (token.type() != TokenType::String)
+						return false;
+
+					auto key = std::string_view(token.src() + token.pos() + 1, token.length() - 2);
+					size_t errorOffset = 0;
+
+					if (findEscape(key) != key.size())
+					{
+						if (tryUnescape(key, buffer, errorOffset) != ParseError::None)
+							return false;
+
+						key = buffer;
+					}
+
+					auto i = findMember(instruction, key, Object::hash(key));
+
+					token.seekNext();
+
+					if (token.type() != TokenType::Colon)
+						return false;
+
+					token.seekNext();
+
+					// Members the format does not mention are skipped, but must still be valid
+					if (i < instruction.childCount)
+					{
+						seen.mark(i);
+
+						if (!checkToken(child(instruction, i), token, buffer))
+							return false;
+					}
+					else if (!token.trySkipValidValue(buffer))
+					{
+						return false;
+					}
+
+					if (token.type() == TokenType::Comma)
+					{
+						token.seekNext();
+						continue;
+					}
+
+					if (token.type() != TokenType::RightBrace)
+						return false;
+
+					break;
+				}
+			}
+
+			token.seekNext();
+
+			return seen.isComplete(*this, instruction);
+		}
+		}
+
+		return false;
+	}
+
+	bool Validator::isValid(const Value& value) const
+	{
+		return checkValue(root(), value, nullptr);
+	}
+
+	bool Validator::isValidJson(const char* json, size_t length) const
+	{
+		try
+		{
+			auto index = StructuralIndex();
+			auto token = Token::initialFor(json, length, index);
+			auto buffer = std::string();
+
+			return checkToken(root(), token, buffer) && token.type() == TokenType::EndOfFile;
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+
+	bool Validator::isValidJson(const char* json) const
+	{
+		return isValidJson(json, std::strlen(json));
+	}
+
+	bool Validator::isValidJson(const std::string& json) const
+	{
+		return isValidJson(json.c_str(), json.length());
+	}
+
+	std::vector<std::string> Validator::errors(const Value& value) const
+	{
+		auto errors = std::vector<std::string>();
+		auto report = Report { errors, std::string() };
+
+		checkValue(root(), value, &report);
+
+		return errors;
+	}
+}
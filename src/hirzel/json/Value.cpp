@@ -2,39 +2,65 @@
 #include "hirzel/json/ValueType.hpp"
 #include <hirzel/json/Value.hpp>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
+#include <utility>
 
 namespace hirzel::json
 {
+	template <typename T, typename... Arguments>
+	T* Value::createShared(Arguments&&... arguments)
+	{
+		auto* block = (char*)::operator new(referencesSize + sizeof(T));
+
+		new (block) References(1);
+
+		try
+		{
+			return new (block + referencesSize) T(std::forward<Arguments>(arguments)...);
+		}
+		catch (...)
+		{
+			::operator delete(block);
+			throw;
+		}
+	}
+
+	template <typename T>
+	void Value::release(T* payload)
+	{
+		auto& references = referencesOf(payload);
+
+		// Whoever lets go last sees every write made through the other values
+		if (references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return;
+
+		payload->~T();
+		references.~References();
+		::operator delete((char*)payload - referencesSize);
+	}
+
 	Value::Value() :
-		_type(ValueType::Null),
-		_number(0)
+		_data()
 	{}
 
 	Value::Value(ValueType type) :
-		_type(type),
-		_number(0)
+		_data()
 	{
+		_data.type = type;
+
 		switch (type)
 		{
-			case ValueType::Number:
-				_number = 0.0;
-				break;
-
-			case ValueType::Boolean:
-				_boolean = false;
-				break;
-
 			case ValueType::String:
-				_string = new std::string();
+				initString(std::string_view());
 				break;
 
 			case ValueType::Array:
-				_array = new Array();
+				_data.array = createShared<Array>();
 				break;
 
 			case ValueType::Object:
-				_object = new Object();
+				_data.object = createShared<Object>();
 				break;
 
 			default:
@@ -43,206 +69,362 @@ namespace hirzel::json
 	}
 
 	Value::Value(short i) :
-		_type(ValueType::Number),
-		_number(i)
+		Value((double)i)
 	{}
 
 	Value::Value(int i) :
-		_type(ValueType::Number),
-		_number(i)
+		Value((double)i)
 	{}
 
 	Value::Value(long i) :
-		_type(ValueType::Number),
-		_number(i)
+		Value((double)i)
 	{}
 
 	Value::Value(long long i) :
-		_type(ValueType::Number),
-		_number(i)
+		Value((double)i)
 	{}
 
 	Value::Value(unsigned short i) :
-		_type(ValueType::Number),
-		_number(i)
+		Value((double)i)
 	{}
 
 	Value::Value(unsigned int i) :
-		_type(ValueType::Number),
-		_number(i)
+		Value((double)i)
 	{}
 
 	Value::Value(unsigned long i) :
-		_type(ValueType::Number),
-		_number(i)
+		Value((double)i)
 	{}
 
 	Value::Value(unsigned long long i) :
-		_type(ValueType::Number),
-		_number(i)
+		Value((double)i)
 	{}
 
 	Value::Value(float d) :
-		_type(ValueType::Number),
-		_number(d)
+		Value((double)d)
 	{}
 
 	Value::Value(double d) :
-		_type(ValueType::Number),
-		_number(d)
-	{}
+		_data()
+	{
+		_data.type = ValueType::Number;
+		_data.number = d;
+	}
 
 	Value::Value(bool b) :
-		_type(ValueType::Boolean),
-		_boolean(b)
-	{}
+		_data()
+	{
+		_data.type = ValueType::Boolean;
+		_data.boolean = b;
+	}
 
 	Value::Value(std::string&& s) :
-		_type(ValueType::String),
-		_string(new std::string(std::move(s)))
-	{}
+		_data()
+	{
+		if (s.length() <= inlineCapacity)
+		{
+			initString(s);
+			return;
+		}
+
+		_data.type = ValueType::String;
+		_data.string = createShared<std::string>(std::move(s));
+	}
 
 	Value::Value(const std::string& s) :
-		_type(ValueType::String),
-		_string(new std::string(s))
-	{}
+		_data()
+	{
+		initString(s);
+	}
 
 	Value::Value(char* s) :
-		_type(ValueType::String),
-		_string(new std::string(s))
-	{}
+		_data()
+	{
+		initString(s);
+	}
 
 	Value::Value(const char* s) :
-		_type(ValueType::String),
-		_string(new std::string(s))
-	{}
+		_data()
+	{
+		initString(s);
+	}
 
 	Value::Value(Array&& array) :
-		_type(ValueType::Array),
-		_array(new Array(std::move(array)))
-	{}
+		_data()
+	{
+		_data.type = ValueType::Array;
+		_data.array = createShared<Array>(std::move(array));
+	}
 
 	Value::Value(const Array& array) :
-		_type(ValueType::Array),
-		_array(new Array(array))
-	{}
+		_data()
+	{
+		_data.type = ValueType::Array;
+		_data.array = createShared<Array>(array);
+	}
 
 	Value::Value(Object&& object) :
-		_type(ValueType::Object),
-		_object(new Object(std::move(object)))
-	{}
+		_data()
+	{
+		_data.type = ValueType::Object;
+		_data.object = createShared<Object>(std::move(object));
+	}
 
 	Value::Value(const Object& object) :
-		_type(ValueType::Object),
-		_object(new Object(object))
-	{}
+		_data()
+	{
+		_data.type = ValueType::Object;
+		_data.object = createShared<Object>(object);
+	}
 
 	Value::Value(Value&& other) noexcept :
-		_type(other._type),
-		_number(0)
+		_data()
+	{
+		if (other._data.storage == Storage::Inline)
+		{
+			_inline = other._inline;
+		}
+		else
+		{
+			_data = other._data;
+		}
+
+		other._data = Data();
+	}
+
+	Value::Value(const Value& other) :
+		_data()
 	{
-		switch (_type)
+		if (other._data.storage == Storage::Inline)
+		{
+			_inline = other._inline;
+			return;
+		}
+
+		switch (other._data.type)
 		{
 		case ValueType::Null:
 			break;
 
 		case ValueType::Number:
-			_number = other._number;
-			break;
-
 		case ValueType::Boolean:
-			_boolean = other._boolean;
+			_data = other._data;
 			break;
 
 		case ValueType::String:
-			_string = other._string;
-			other._string = nullptr;
+			if (other._data.storage == Storage::Owned)
+			{
+				referencesOf(other._data.string).fetch_add(1, std::memory_order_relaxed);
+				_data = other._data;
+				break;
+			}
+
+			initString(other.string());
 			break;
 
+		// Borrowed and pooled payloads depend on storage the copy may outlive
 		case ValueType::Array:
-			_array = other._array;
-			other._array = nullptr;
+			if (other._data.storage == Storage::Owned)
+			{
+				referencesOf(other._data.array).fetch_add(1, std::memory_order_relaxed);
+				_data = other._data;
+				break;
+			}
+
+			_data.type = ValueType::Array;
+			_data.array = createShared<Array>(*other._data.array);
 			break;
 
 		case ValueType::Object:
-			_object = other._object;
-			other._object = nullptr;
+			if (other._data.storage == Storage::Owned)
+			{
+				referencesOf(other._data.object).fetch_add(1, std::memory_order_relaxed);
+				_data = other._data;
+				break;
+			}
+
+			_data.type = ValueType::Object;
+			_data.object = createShared<Object>(*other._data.object);
 			break;
 		}
-
-		other._type = ValueType::Null;
 	}
 
-	Value::Value(const Value& other) :
-		_type(other._type),
-		_number(0)
+	Value::~Value()
 	{
-		switch (_type)
+		// The arena frees the memory of its containers, but values put in them
+		// through non-const accessors may own memory of their own
+		if (_data.storage == Storage::Adopting)
 		{
-		case ValueType::Null:
-			_number = 0;
-			break;
+			if (_data.type == ValueType::Array)
+				_data.array->~Array();
+			else if (_data.type == ValueType::Object)
+				_data.object->~Object();
 
-		case ValueType::Number:
-			_number = other._number;
-			break;
+			return;
+		}
 
-		case ValueType::Boolean:
-			_boolean = other._boolean;
-			break;
+		if (_data.storage != Storage::Owned && _data.storage != Storage::Pooled)
+			return;
 
+		switch (_data.type)
+		{
 		case ValueType::String:
-			_string = new std::string(*other._string);
+			release(_data.string);
 			break;
 
 		case ValueType::Array:
-			_array = new Array(*other._array);
+			release(_data.array);
 			break;
 
 		case ValueType::Object:
-			_object = new Object(*other._object);
+			release(_data.object);
+			break;
+
+		default:
 			break;
 		}
 	}
 
-	Value::~Value()
+	void Value::unshareSlow()
 	{
-		switch (_type)
+		switch (_data.type)
 		{
 		case ValueType::String:
-			delete _string;
+		{
+			auto* copy = createShared<std::string>(*_data.string);
+
+			release(_data.string);
+			_data.string = copy;
 			break;
+		}
 
 		case ValueType::Array:
-			delete _array;
+		{
+			auto* copy = createShared<Array>(*_data.array);
+
+			release(_data.array);
+			_data.array = copy;
 			break;
+		}
 
 		case ValueType::Object:
-			delete _object;
+		{
+			auto* copy = createShared<Object>(*_data.object);
+
+			release(_data.object);
+			_data.object = copy;
 			break;
+		}
 
 		default:
 			break;
 		}
 	}
 
+	std::string& Value::string()
+	{
+		assert(_data.type == ValueType::String);
+
+		if (_data.storage == Storage::Inline || _data.storage == Storage::Borrowed)
+		{
+			auto* owned = createShared<std::string>(std::as_const(*this).string());
+
+			_data.storage = Storage::Owned;
+			_data.string = owned;
+		}
+		else
+		{
+			unshare(_data.string);
+		}
+
+		return *_data.string;
+	}
+
+	bool Value::isShared() const
+	{
+		if (_data.storage != Storage::Owned)
+			return false;
+
+		switch (_data.type)
+		{
+		case ValueType::String:
+			return referencesOf(_data.string).load(std::memory_order_acquire) > 1;
+
+		case ValueType::Array:
+			return referencesOf(_data.array).load(std::memory_order_acquire) > 1;
+
+		case ValueType::Object:
+			return referencesOf(_data.object).load(std::memory_order_acquire) > 1;
+
+		default:
+			return false;
+		}
+	}
+
+	void Value::initString(std::string_view text)
+	{
+		if (text.length() <= inlineCapacity)
+		{
+			_inline.type = ValueType::String;
+			_inline.storage = Storage::Inline;
+			_inline.length = (uint8_t)text.length();
+
+			if (!text.empty())
+				std::memcpy(_inline.chars, text.data(), text.length());
+
+			return;
+		}
+
+		_data.type = ValueType::String;
+		_data.storage = Storage::Owned;
+		_data.string = createShared<std::string>(text);
+	}
+
 	Value& Value::operator=(Value&& other)
 	{
-		new (this) auto(std::move(other));
+		if (this == &other)
+			return *this;
+
+		// Released last, as other may be part of what this value held
+		auto old = Value(std::move(*this));
+
+		new (this) Value(std::move(other));
 
 		return *this;
 	}
 
 	Value& Value::operator=(const Value& other)
 	{
-		new (this) auto(other);
+		auto copy = Value(other);
+		auto old = Value(std::move(*this));
+
+		new (this) Value(std::move(copy));
 
 		return *this;
 	}
 
+	void Value::assign(std::string_view text)
+	{
+		auto isReusable = _data.type == ValueType::String
+			&& _data.storage == Storage::Owned
+			&& text.length() > inlineCapacity
+			&& referencesOf(_data.string).load(std::memory_order_acquire) == 1;
+
+		if (isReusable)
+		{
+			_data.string->assign(text.data(), text.length());
+			return;
+		}
+
+		auto replacement = Value();
+
+		replacement.initString(text);
+		*this = std::move(replacement);
+	}
+
 	const char* Value::typeName() const noexcept
 	{
-		switch (_type)
+		switch (_data.type)
 		{
 		case ValueType::Null:
 			return "null";
@@ -269,11 +451,12 @@ namespace hirzel::json
 
 	Value *Value::at(const std::string& key)
 	{
-		if (_type != ValueType::Object)
+		if (_data.type != ValueType::Object)
 			return nullptr;
 
-		auto iter = _object->find(key);
-		auto *ptr = iter != _object->end()
+		auto& object = this->object();
+		auto iter = object.find(key);
+		auto *ptr = iter != object.end()
 			? &iter->second
 			: nullptr;
 
@@ -282,63 +465,74 @@ namespace hirzel::json
 
 	const Value *Value::at(const std::string& key) const
 	{
-		if (_type != ValueType::Object)
+		if (_data.type != ValueType::Object)
 			return nullptr;
 
-		auto iter = _object->find(key);
-		auto *ptr = iter != _object->end()
+		auto iter = _data.object->find(key);
+		auto *ptr = iter != _data.object->end()
 			? &iter->second
 			: nullptr;
 
 		return ptr;
 	}
 
+	Value *Value::at(const Pointer& pointer)
+	{
+		return pointer.resolve(*this);
+	}
+
+	const Value *Value::at(const Pointer& pointer) const
+	{
+		return pointer.resolve(*this);
+	}
+
 	Value *Value::at(size_t i)
 	{
-		if (_type != ValueType::Array || i >= _array->size())
+		if (_data.type != ValueType::Array || i >= _data.array->size())
 			return nullptr;
 
-		return &(*_array)[i];
+		return &array()[i];
 	}
 
 	const Value *Value::at(size_t i) const
 	{
-		if (_type != ValueType::Array || i >= _array->size())
+		if (_data.type != ValueType::Array || i >= _data.array->size())
 			return nullptr;
 
-		return &(*_array)[i];
+		return &(*_data.array)[i];
 	}
 
 	Value& Value::operator[](size_t i)
 	{
-		if (_type != ValueType::Array)
+		if (_data.type != ValueType::Array)
 			throw std::runtime_error("Value is not an array.");
 
-		if (i >= _array->size())
+		if (i >= _data.array->size())
 			throw std::runtime_error("Index " + std::to_string(i) + " is out of bounds.");
 
-		return (*_array)[i];
+		return array()[i];
 	}
 
 	const Value& Value::operator[](size_t i) const
 	{
-		if (_type != ValueType::Array)
+		if (_data.type != ValueType::Array)
 			throw std::runtime_error("Value is not an array.");
 
-		if (i >= _array->size())
+		if (i >= _data.array->size())
 			throw std::runtime_error("Index " + std::to_string(i) + " is out of bounds.");
 
-		return (*_array)[i];
+		return (*_data.array)[i];
 	}
 
 	Value& Value::operator[](const std::string& key)
 	{
-		if (_type != ValueType::Object)
+		if (_data.type != ValueType::Object)
 			throw std::runtime_error("Value is not an object.");
 
-		auto iter = _object->find(key);
+		auto& object = this->object();
+		auto iter = object.find(key);
 
-		if (iter == _object->end())
+		if (iter == object.end())
 			throw std::runtime_error("No member with key '" + key + "' exists.");
 
 		return iter->second;
@@ -346,12 +540,12 @@ namespace hirzel::json
 
 	const Value& Value::operator[](const std::string& key) const
 	{
-		if (_type != ValueType::Object)
+		if (_data.type != ValueType::Object)
 			throw std::runtime_error("Value is not an object.");
 
-		auto iter = _object->find(key);
+		auto iter = _data.object->find(key);
 
-		if (iter == _object->end())
+		if (iter == _data.object->end())
 			throw std::runtime_error("No member with key '" + key + "' exists.");
 
 		return iter->second;
@@ -359,18 +553,18 @@ namespace hirzel::json
 
 	int64_t Value::asInteger() const
 	{
-		switch (_type)
+		switch (_data.type)
 		{
 		case ValueType::Number:
-			return (int64_t)_number;
+			return (int64_t)_data.number;
 
 		case ValueType::Boolean:
-			return (int64_t)_boolean;
+			return (int64_t)_data.boolean;
 
 		case ValueType::String:
 			try
 			{
-				return std::stoll(*_string);
+				return std::stoll(std::string(string()));
 			}
 			catch (const std::exception&)
 			{
@@ -386,18 +580,18 @@ namespace hirzel::json
 
 	double Value::asDecimal() const
 	{
-		switch (_type)
+		switch (_data.type)
 		{
 		case ValueType::Number:
-			return _number;
+			return _data.number;
 
 		case ValueType::Boolean:
-			return (double)_boolean;
+			return (double)_data.boolean;
 			
 		case ValueType::String:
 			try
 			{
-				return std::stod(*_string);
+				return std::stod(std::string(string()));
 			}
 			catch (const std::exception&)
 			{
@@ -413,16 +607,16 @@ namespace hirzel::json
 
 	bool Value::asBoolean() const
 	{
-		switch (_type)
+		switch (_data.type)
 		{
 		case ValueType::Number:
-			return (bool)_number;
+			return (bool)_data.number;
 
 		case ValueType::Boolean:
-			return _boolean;
+			return _data.boolean;
 
 		case ValueType::String:
-			return !_string->empty();
+			return !string().empty();
 
 		default:
 			return false;
@@ -431,24 +625,24 @@ namespace hirzel::json
 
 	std::string Value::asString() const
 	{
-		if (_type == ValueType::String)
-			return *_string;
+		if (_data.type == ValueType::String)
+			return std::string(string());
 
 		return serialize(*this, false);
 	}
 
 	bool Value::isEmpty() const
 	{
-		switch (_type)
+		switch (_data.type)
 		{
 		case ValueType::String:
-			return _string->empty();
+			return string().empty();
 
 		case ValueType::Array:
-			return _array->empty();
+			return _data.array->empty();
 
 		case ValueType::Object:
-			return _object->empty();
+			return _data.object->empty();
 
 		case ValueType::Null:
 			return true;
@@ -460,16 +654,16 @@ namespace hirzel::json
 
 	size_t Value::length() const
 	{
-		switch (_type)
+		switch (_data.type)
 		{
 		case ValueType::String:
-			return _string->length();
+			return string().length();
 
 		case ValueType::Array:
-			return _array->size();
+			return _data.array->size();
 
 		case ValueType::Object:
-			return _object->size();
+			return _data.object->size();
 
 		default:
 			return 0;
@@ -479,26 +673,32 @@ namespace hirzel::json
 	bool Value::operator==(const Value& other) const
 	{
 
-		if (_type != other.type())
+		if (_data.type != other.type())
 			return false;
 
-		switch (_type)
+		// Copies that still share a payload are equal without looking inside
+		if (_data.storage == Storage::Owned && other._data.storage == Storage::Owned
+			&& (_data.type == ValueType::Array || _data.type == ValueType::Object)
+			&& _data.array == other._data.array)
+			return true;
+
+		switch (_data.type)
 		{
 		case ValueType::Null:
 			return true;
 
 		case ValueType::Number:
-			return _number == other.number();
+			return _data.number == other.number();
 
 		case ValueType::Boolean:
-			return _boolean == other.boolean();
+			return _data.boolean == other.boolean();
 
 		case ValueType::String:
-			return *_string == other.string();
+			return string() == other.string();
 
 		case ValueType::Array:
 		{
-			const auto& arr = *_array;
+			const auto& arr = *_data.array;
 			const auto& oarr = other.array();
 
 			if (arr.size() != oarr.size())
@@ -515,7 +715,7 @@ namespace hirzel::json
 
 		case ValueType::Object:
 		{
-			const auto& aTable = *_object;
+			const auto& aTable = *_data.object;
 			const auto& bTable = other.object();
 
 			if (aTable.size() != bTable.size())
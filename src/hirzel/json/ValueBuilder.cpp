@@ -0,0 +1,51 @@
+#include <hirzel/json/ValueBuilder.hpp>
+#include <stdexcept>
+
+namespace hirzel::json
+{
+	ValueBuilder::ValueBuilder() :
+		_isComplete(false)
+	{}
+
+	void ValueBuilder::add(Value&& value)
+	{
+		if (_containers.empty())
+		{
+			_result = std::move(value);
+			_isComplete = true;
+			return;
+		}
+
+		auto& parent = _containers.back();
+
+		if (parent.isArray())
+		{
+			parent.array().emplace_back(std::move(value));
+			return;
+		}
+
+		const auto& key = _keys.back();
+
+		parent.object().emplace(key, std::move(value));
+
+		_keys.pop_back();
+	}
+
+	void ValueBuilder::onEnd()
+	{
+		auto value = std::move(_containers.back());
+
+		_containers.pop_back();
+		add(std::move(value));
+	}
+
+	Value ValueBuilder::take()
+	{
+		if (!_isComplete)
+			throw std::runtime_error("Value is not complete.");
+
+		_isComplete = false;
+
+		return std::move(_result);
+	}
+}
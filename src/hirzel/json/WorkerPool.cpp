@@ -0,0 +1,76 @@
+#include <hirzel/json/WorkerPool.hpp>
+#include <utility>
+
+namespace hirzel::json
+{
+	WorkerPool::WorkerPool(size_t threadCount, Function work, Function cancel) :
+		_work(std::move(work)),
+		_cancel(std::move(cancel))
+	{
+		try
+		{
+			_threads.reserve(threadCount);
+
+			for (size_t i = 0; i < threadCount; ++i)
+				_threads.emplace_back([this]() { run(); });
+		}
+		catch (...)
+		{
+			stop();
+			throw;
+		}
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		stop();
+	}
+
+	void WorkerPool::run()
+	{
+		try
+		{
+			_work();
+		}
+		catch (...)
+		{
+			{
+				auto lock = std::lock_guard<std::mutex>(_mutex);
+
+				if (!_error)
+					_error = std::current_exception();
+			}
+
+			_cancel();
+		}
+	}
+
+	void WorkerPool::stop()
+	{
+		auto isRunning = false;
+
+		for (const auto& thread : _threads)
+			isRunning = isRunning || thread.joinable();
+
+		if (isRunning)
+			_cancel();
+
+		for (auto& thread : _threads)
+		{
+			if (thread.joinable())
+				thread.join();
+		}
+	}
+
+	void WorkerPool::join()
+	{
+		for (auto& thread : _threads)
+		{
+			if (thread.joinable())
+				thread.join();
+		}
+
+		if (_error)
+			std::rethrow_exception(_error);
+	}
+}
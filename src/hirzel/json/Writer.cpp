@@ -0,0 +1,110 @@
+#include <hirzel/json/Writer.hpp>
+#include <algorithm>
+
+namespace hirzel::json
+{
+	static constexpr char indentation[] = "\n\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+	static constexpr size_t maxIndentation = sizeof(indentation) - 2;
+
+	Writer::Writer(size_t initialCapacity) :
+		_storage(new char[std::max(initialCapacity, (size_t)16)]),
+		_stream(nullptr),
+		_data(_storage.get()),
+		_length(0),
+		_capacity(std::max(initialCapacity, (size_t)16)),
+		_fixedCapacity(0),
+		_isFixed(false),
+		_isOverflowed(false)
+	{}
+
+	Writer::Writer(char* data, size_t capacity) :
+		_stream(nullptr),
+		_data(data),
+		_length(0),
+		_capacity(capacity),
+		_fixedCapacity(capacity),
+		_isFixed(true),
+		_isOverflowed(false)
+	{}
+
+	Writer::Writer(std::ostream& stream, size_t bufferSize) :
+		Writer(bufferSize)
+	{
+		_stream = &stream;
+	}
+
+	Writer::~Writer()
+	{
+		// A stream that fails here is reported by an explicit flush, or is
+		// being unwound from the failure that already was
+		try
+		{
+			flush();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	bool Writer::reserveSlow(size_t size)
+	{
+		if (_isFixed)
+		{
+			// Pinning the capacity sends every later write down this path too
+			_capacity = _length;
+			_isOverflowed = true;
+
+			return false;
+		}
+
+		if (_stream)
+		{
+			flush();
+
+			if (size <= _capacity)
+				return true;
+		}
+
+		auto capacity = std::max(_capacity * 2, _length + size);
+		auto* storage = new char[capacity];
+
+		std::memcpy(storage, _data, _length);
+		_storage.reset(storage);
+		_data = storage;
+		_capacity = capacity;
+
+		return true;
+	}
+
+	void Writer::newline(size_t depth)
+	{
+		if (depth <= maxIndentation)
+		{
+			write(indentation, depth + 1);
+			return;
+		}
+
+		write(indentation, maxIndentation + 1);
+
+		for (depth -= maxIndentation; depth > 0; depth -= std::min(depth, maxIndentation))
+			write(indentation + 1, std::min(depth, maxIndentation));
+	}
+
+	void Writer::flush()
+	{
+		if (_stream == nullptr || _length == 0)
+			return;
+
+		_stream->write(_data, _length);
+		_length = 0;
+	}
+
+	void Writer::clear()
+	{
+		if (_isFixed)
+			_capacity = _fixedCapacity;
+
+		_length = 0;
+		_isOverflowed = false;
+	}
+}
@@ -0,0 +1,855 @@
+#include <hirzel/json/binary.hpp>
+#include <hirzel/json/ParseError.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace hirzel::json
+{
+	// Integral numbers in [minInteger, maxUnsigned) are written as integers
+	static constexpr double minInteger = -9223372036854775808.0;
+	static constexpr double maxUnsigned = 18446744073709551616.0;
+
+	static bool isInteger(double value)
+	{
+		return value >= minInteger
+			&& value < maxUnsigned
+			&& std::trunc(value) == value
+			&& !(value == 0 && std::signbit(value));
+	}
+
+	static bool isFloat(double value)
+	{
+		// Converting a double outside the range of float is undefined
+		if (std::isinf(value))
+			return true;
+
+		return std::fabs(value) <= FLT_MAX && (double)(float)value == value;
+	}
+
+	static void writeBigEndian(Writer& out, uint8_t prefix, uint64_t value, size_t size)
+	{
+		char bytes[9];
+
+		bytes[0] = (char)prefix;
+
+		for (size_t i = 0; i < size; ++i)
+			bytes[1 + i] = (char)(value >> (8 * (size - 1 - i)));
+
+		out.write(bytes, size + 1);
+	}
+
+	static void writeFloat(Writer& out, uint8_t prefix32, uint8_t prefix64, double value)
+	{
+		if (isFloat(value))
+		{
+			auto single = (float)value;
+			uint32_t bits;
+
+			std::memcpy(&bits, &single, sizeof(bits));
+			writeBigEndian(out, prefix32, bits, sizeof(bits));
+			return;
+		}
+
+		uint64_t bits;
+
+		std::memcpy(&bits, &value, sizeof(bits));
+		writeBigEndian(out, prefix64, bits, sizeof(bits));
+	}
+
+	static void checkLength(size_t length)
+	{
+		if (length > std::numeric_limits<uint32_t>::max())
+			throw std::runtime_error("Length " + std::to_string(length) + " is too large to encode.");
+	}
+
+	/*
+	 * Reads either format. Strings are viewed in place when decoding a view
+	 * and copied otherwise, as are those assembled from several chunks,
+	 * which have no single place in the data to view.
+	 */
+	struct Decoder
+	{
+		const char* format;
+		std::string_view data;
+		Arena* arena;
+		bool isViewing;
+		size_t pos = 0;
+		size_t depth = 0;
+
+		Decoder(const char* format, std::string_view data, Arena* arena, bool isViewing) :
+			format(format),
+			data(data),
+			arena(arena),
+			isViewing(isViewing)
+		{}
+
+		[[noreturn]] void fail(const std::string& reason, size_t offset) const
+		{
+			throw std::runtime_error("Failed to decode " + std::string(format) + ": "
+				+ reason + " at pos: " + std::to_string(offset) + ".");
+		}
+
+		uint8_t byte()
+		{
+			if (pos == data.size())
+				fail("Unexpected end of data", pos);
+
+			return (uint8_t)data[pos++];
+		}
+
+		std::string_view take(uint64_t size)
+		{
+			if (size > data.size() - pos)
+				fail("Unexpected end of data", data.size());
+
+			auto out = data.substr(pos, (size_t)size);
+
+			pos += (size_t)size;
+
+			return out;
+		}
+
+		uint64_t bigEndian(size_t size)
+		{
+			uint64_t value = 0;
+
+			for (auto c : take(size))
+				value = (value << 8) | (uint8_t)c;
+
+			return value;
+		}
+
+		double float32()
+		{
+			auto bits = (uint32_t)bigEndian(4);
+			float value;
+
+			std::memcpy(&value, &bits, sizeof(value));
+
+			return value;
+		}
+
+		double float64()
+		{
+			auto bits = bigEndian(8);
+			double value;
+
+			std::memcpy(&value, &bits, sizeof(value));
+
+			return value;
+		}
+
+		bool isInData(std::string_view text) const
+		{
+			return text.data() >= data.data() && text.data() + text.size() <= data.data() + data.size();
+		}
+
+		Value string(std::string_view text) const
+		{
+			if (arena == nullptr)
+				return Value(std::string(text));
+
+			return isViewing && isInData(text)
+				? arena->viewString(text)
+				: arena->createString(text);
+		}
+
+		Key key(std::string_view text) const
+		{
+			if (arena == nullptr)
+				return Key(text);
+
+			return isViewing && isInData(text) && text.size() > Key::inlineCapacity
+				? Key::borrow(text)
+				: arena->createKey(text);
+		}
+
+		// Every item takes at least a byte, which bounds what a count can
+		// reserve however large it claims to be
+		size_t reservable(uint64_t count) const
+		{
+			return (size_t)std::min<uint64_t>(count, data.size() - pos);
+		}
+
+		Value array(uint64_t count) const
+		{
+			auto out = arena
+				? arena->createArray()
+				: Value(ValueType::Array);
+
+			arrayContents(out).reserve(reservable(count));
+
+			return out;
+		}
+
+		Value object(uint64_t count) const
+		{
+			auto out = arena
+				? arena->createObject()
+				: Value(ValueType::Object);
+
+			objectContents(out).reserve(reservable(count));
+
+			return out;
+		}
+
+		// Arena containers are filled through the arena, which then releases
+		// them without walking them
+		Array& arrayContents(Value& array) const
+		{
+			return arena
+				? arena->arrayToFill(array)
+				: array.array();
+		}
+
+		Object& objectContents(Value& object) const
+		{
+			return arena
+				? arena->objectToFill(object)
+				: object.object();
+		}
+
+		void enter()
+		{
+			depth += 1;
+
+			if (depth > maxParseDepth)
+				fail("Nesting is too deep", pos);
+		}
+
+		void leave()
+		{
+			depth -= 1;
+		}
+	};
+
+	static Value decode(Value (*decodeValue)(Decoder&), const char* format, std::string_view data, Arena* arena, bool isViewing)
+	{
+		auto in = Decoder(format, data, arena, isViewing);
+		auto out = decodeValue(in);
+
+		if (in.pos != data.size())
+			in.fail("Trailing data", in.pos);
+
+		return out;
+	}
+
+	static void writeMessagePackLength(Writer& out, size_t length, uint8_t fixPrefix, size_t fixLimit, uint8_t prefix16)
+	{
+		checkLength(length);
+
+		if (length < fixLimit)
+			out.put((char)(fixPrefix | length));
+		else if (length <= 0xFFFF)
+			writeBigEndian(out, prefix16, length, 2);
+		else
+			writeBigEndian(out, prefix16 + 1, length, 4);
+	}
+
+	static void writeMessagePackString(Writer& out, std::string_view text)
+	{
+		if (text.size() >= 32 && text.size() <= 0xFF)
+			writeBigEndian(out, 0xD9, text.size(), 1);
+		else
+			writeMessagePackLength(out, text.size(), 0xA0, 32, 0xDA);
+
+		out.write(text);
+	}
+
+	static void writeMessagePackNumber(Writer& out, double value)
+	{
+		if (!isInteger(value))
+		{
+			writeFloat(out, 0xCA, 0xCB, value);
+			return;
+		}
+
+		if (value >= 0)
+		{
+			auto number = (uint64_t)value;
+
+			if (number < 0x80)
+				out.put((char)number);
+			else if (number <= 0xFF)
+				writeBigEndian(out, 0xCC, number, 1);
+			else if (number <= 0xFFFF)
+				writeBigEndian(out, 0xCD, number, 2);
+			else if (number <= 0xFFFFFFFF)
+				writeBigEndian(out, 0xCE, number, 4);
+			else
+				writeBigEndian(out, 0xCF, number, 8);
+
+			return;
+		}
+
+		auto number = (int64_t)value;
+
+		if (number >= -32)
+			out.put((char)number);
+		else if (number >= INT8_MIN)
+			writeBigEndian(out, 0xD0, (uint64_t)number, 1);
+		else if (number >= INT16_MIN)
+			writeBigEndian(out, 0xD1, (uint64_t)number, 2);
+		else if (number >= INT32_MIN)
+			writeBigEndian(out, 0xD2, (uint64_t)number, 4);
+		else
+			writeBigEndian(out, 0xD3, (uint64_t)number, 8);
+	}
+
+	static void encodeMessagePack(Writer& out, const Value& value)
+	{
+		switch (value.type())
+		{
+		case ValueType::Null:
+			out.put((char)0xC0);
+			break;
+
+		case ValueType::Boolean:
+			out.put(value.boolean() ? (char)0xC3 : (char)0xC2);
+			break;
+
+		case ValueType::Number:
+			writeMessagePackNumber(out, value.number());
+			break;
+
+		case ValueType::String:
+			writeMessagePackString(out, value.string());
+			break;
+
+		case ValueType::Array:
+			writeMessagePackLength(out, value.array().size(), 0x90, 16, 0xDC);
+
+			for (const auto& item : value.array())
+				encodeMessagePack(out, item);
+			break;
+
+		case ValueType::Object:
+			writeMessagePackLength(out, value.object().size(), 0x80, 16, 0xDE);
+
+			for (const auto& member : value.object())
+			{
+				writeMessagePackString(out, member.first);
+				encodeMessagePack(out, member.second);
+			}
+			break;
+		}
+	}
+
+	// Size of the length that follows a str or bin type, or zero for other types
+	static size_t messagePackLengthSize(uint8_t type)
+	{
+		switch (type)
+		{
+		case 0xC4:
+		case 0xD9:
+			return 1;
+
+		case 0xC5:
+		case 0xDA:
+			return 2;
+
+		case 0xC6:
+		case 0xDB:
+			return 4;
+
+		default:
+			return 0;
+		}
+	}
+
+	static Value decodeMessagePack(Decoder& in);
+
+	static Value decodeMessagePackArray(Decoder& in, uint64_t count)
+	{
+		in.enter();
+
+		auto out = in.array(count);
+		auto& array = in.arrayContents(out);
+
+		for (uint64_t i = 0; i < count; ++i)
+			array.emplace_back(decodeMessagePack(in));
+
+		in.leave();
+
+		return out;
+	}
+
+	static Value decodeMessagePackMap(Decoder& in, uint64_t count)
+	{
+		in.enter();
+
+		auto out = in.object(count);
+		auto& object = in.objectContents(out);
+
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			auto offset = in.pos;
+			auto type = in.byte();
+			auto length = (uint64_t)0;
+
+			if ((type & 0xE0) == 0xA0)
+				length = type & 0x1F;
+			else if (messagePackLengthSize(type) > 0)
+				length = in.bigEndian(messagePackLengthSize(type));
+			else
+				in.fail("Object keys must be strings", offset);
+
+			auto key = in.key(in.take(length));
+			auto value = decodeMessagePack(in);
+
+			object.emplace(std::move(key), std::move(value));
+		}
+
+		in.leave();
+
+		return out;
+	}
+
+	static Value decodeMessagePack(Decoder& in)
+	{
+		auto offset = in.pos;
+		auto type = in.byte();
+
+		if (type <= 0x7F)
+			return Value((double)type);
+
+		if (type >= 0xE0)
+			return Value((double)(int8_t)type);
+
+		if ((type & 0xE0) == 0xA0)
+			return in.string(in.take(type & 0x1F));
+
+		if ((type & 0xF0) == 0x90)
+			return decodeMessagePackArray(in, type & 0x0F);
+
+		if ((type & 0xF0) == 0x80)
+			return decodeMessagePackMap(in, type & 0x0F);
+
+		if (messagePackLengthSize(type) > 0)
+			return in.string(in.take(in.bigEndian(messagePackLengthSize(type))));
+
+		switch (type)
+		{
+		case 0xC0:
+			return Value();
+
+		case 0xC2:
+			return Value(false);
+
+		case 0xC3:
+			return Value(true);
+
+		case 0xCA:
+			return Value(in.float32());
+
+		case 0xCB:
+			return Value(in.float64());
+
+		case 0xCC:
+			return Value((double)in.bigEndian(1));
+
+		case 0xCD:
+			return Value((double)in.bigEndian(2));
+
+		case 0xCE:
+			return Value((double)in.bigEndian(4));
+
+		case 0xCF:
+			return Value((double)in.bigEndian(8));
+
+		case 0xD0:
+			return Value((double)(int8_t)in.bigEndian(1));
+
+		case 0xD1:
+			return Value((double)(int16_t)in.bigEndian(2));
+
+		case 0xD2:
+			return Value((double)(int32_t)in.bigEndian(4));
+
+		case 0xD3:
+			return Value((double)(int64_t)in.bigEndian(8));
+
+		case 0xDC:
+			return decodeMessagePackArray(in, in.bigEndian(2));
+
+		case 0xDD:
+			return decodeMessagePackArray(in, in.bigEndian(4));
+
+		case 0xDE:
+			return decodeMessagePackMap(in, in.bigEndian(2));
+
+		case 0xDF:
+			return decodeMessagePackMap(in, in.bigEndian(4));
+
+		default:
+			in.fail("Unsupported type " + std::to_string(type), offset);
+		}
+	}
+
+	void toMessagePack(Writer& out, const Value& value)
+	{
+		encodeMessagePack(out, value);
+	}
+
+	void toMessagePack(std::ostream& out, const Value& value)
+	{
+		auto writer = Writer(out);
+
+		encodeMessagePack(writer, value);
+		writer.flush();
+	}
+
+	std::string toMessagePack(const Value& value)
+	{
+		auto writer = Writer();
+
+		encodeMessagePack(writer, value);
+
+		return writer.str();
+	}
+
+	Value fromMessagePack(std::string_view data)
+	{
+		return decode(decodeMessagePack, "MessagePack", data, nullptr, false);
+	}
+
+	Value fromMessagePack(std::string_view data, Arena& arena)
+	{
+		return decode(decodeMessagePack, "MessagePack", data, &arena, false);
+	}
+
+	Value fromMessagePackView(std::string_view data, Arena& arena)
+	{
+		return decode(decodeMessagePack, "MessagePack", data, &arena, true);
+	}
+
+	enum CborMajorType : uint8_t
+	{
+		CborUnsigned,
+		CborNegative,
+		CborBytes,
+		CborText,
+		CborArray,
+		CborMap,
+		CborTag,
+		CborSimple
+	};
+
+	static constexpr uint8_t cborIndefinite = 31;
+	static constexpr uint8_t cborBreak = 0xFF;
+
+	static void writeCborHead(Writer& out, uint8_t major, uint64_t argument)
+	{
+		auto prefix = (uint8_t)(major << 5);
+
+		if (argument < 24)
+			out.put((char)(prefix | argument));
+		else if (argument <= 0xFF)
+			writeBigEndian(out, prefix | 24, argument, 1);
+		else if (argument <= 0xFFFF)
+			writeBigEndian(out, prefix | 25, argument, 2);
+		else if (argument <= 0xFFFFFFFF)
+			writeBigEndian(out, prefix | 26, argument, 4);
+		else
+			writeBigEndian(out, prefix | 27, argument, 8);
+	}
+
+	static void encodeCbor(Writer& out, const Value& value)
+	{
+		switch (value.type())
+		{
+		case ValueType::Null:
+			out.put((char)0xF6);
+			break;
+
+		case ValueType::Boolean:
+			out.put(value.boolean() ? (char)0xF5 : (char)0xF4);
+			break;
+
+		case ValueType::Number:
+		{
+			auto number = value.number();
+
+			if (!isInteger(number))
+				writeFloat(out, 0xFA, 0xFB, number);
+			else if (number >= 0)
+				writeCborHead(out, CborUnsigned, (uint64_t)number);
+			else
+				writeCborHead(out, CborNegative, (uint64_t)(-1 - (int64_t)number));
+			break;
+		}
+
+		case ValueType::String:
+			writeCborHead(out, CborText, value.string().size());
+			out.write(value.string());
+			break;
+
+		case ValueType::Array:
+			writeCborHead(out, CborArray, value.array().size());
+
+			for (const auto& item : value.array())
+				encodeCbor(out, item);
+			break;
+
+		case ValueType::Object:
+			writeCborHead(out, CborMap, value.object().size());
+
+			for (const auto& member : value.object())
+			{
+				writeCborHead(out, CborText, member.first.length());
+				out.write(member.first.view());
+				encodeCbor(out, member.second);
+			}
+			break;
+		}
+	}
+
+	static uint64_t readCborArgument(Decoder& in, uint8_t info, size_t offset)
+	{
+		if (info < 24)
+			return info;
+
+		switch (info)
+		{
+		case 24:
+			return in.bigEndian(1);
+
+		case 25:
+			return in.bigEndian(2);
+
+		case 26:
+			return in.bigEndian(4);
+
+		case 27:
+			return in.bigEndian(8);
+
+		default:
+			in.fail("Invalid argument", offset);
+		}
+	}
+
+	static bool acceptCborBreak(Decoder& in)
+	{
+		if (in.pos == in.data.size() || (uint8_t)in.data[in.pos] != cborBreak)
+			return false;
+
+		in.pos += 1;
+
+		return true;
+	}
+
+	// Byte or text string, which views the data unless it is split into
+	// chunks, in which case they are joined in buffer
+	static std::string_view readCborText(Decoder& in, uint8_t head, size_t offset, std::string& buffer)
+	{
+		auto major = head >> 5;
+		auto info = head & 0x1F;
+
+		if (info != cborIndefinite)
+			return in.take(readCborArgument(in, info, offset));
+
+		buffer.clear();
+
+		while (!acceptCborBreak(in))
+		{
+			auto chunkOffset = in.pos;
+			auto chunk = in.byte();
+
+			if ((chunk >> 5) != major || (chunk & 0x1F) == cborIndefinite)
+				in.fail("Invalid string chunk", chunkOffset);
+
+			buffer += in.take(readCborArgument(in, chunk & 0x1F, chunkOffset));
+		}
+
+		return buffer;
+	}
+
+	static double decodeHalf(uint16_t half)
+	{
+		auto exponent = (half >> 10) & 0x1F;
+		auto mantissa = half & 0x3FF;
+		auto value = exponent == 0
+			? std::ldexp(mantissa, -24)
+			: exponent == 31
+				? (mantissa == 0 ? INFINITY : NAN)
+				: std::ldexp(mantissa + 1024, exponent - 25);
+
+		return half & 0x8000
+			? -value
+			: value;
+	}
+
+	static Value decodeCbor(Decoder& in);
+
+	static Value decodeCborArray(Decoder& in, uint8_t info, size_t offset)
+	{
+		auto isIndefinite = info == cborIndefinite;
+		auto count = isIndefinite
+			? 0
+			: readCborArgument(in, info, offset);
+
+		in.enter();
+
+		auto out = in.array(count);
+		auto& array = in.arrayContents(out);
+
+		if (isIndefinite)
+		{
+			while (!acceptCborBreak(in))
+				array.emplace_back(decodeCbor(in));
+		}
+		else
+		{
+			for (uint64_t i = 0; i < count; ++i)
+				array.emplace_back(decodeCbor(in));
+		}
+
+		in.leave();
+
+		return out;
+	}
+
+	static Value decodeCborMap(Decoder& in, uint8_t info, size_t offset)
+	{
+		auto isIndefinite = info == cborIndefinite;
+		auto count = isIndefinite
+			? 0
+			: readCborArgument(in, info, offset);
+
+		in.enter();
+
+		auto out = in.object(count);
+		auto& object = in.objectContents(out);
+		auto buffer = std::string();
+
+		for (uint64_t i = 0; isIndefinite ? !acceptCborBreak(in) : i < count; ++i)
+		{
+			auto keyOffset = in.pos;
+			auto head = in.byte();
+
+			if ((head >> 5) != CborText && (head >> 5) != CborBytes)
+				in.fail("Object keys must be strings", keyOffset);
+
+			auto key = in.key(readCborText(in, head, keyOffset, buffer));
+			auto value = decodeCbor(in);
+
+			object.emplace(std::move(key), std::move(value));
+		}
+
+		in.leave();
+
+		return out;
+	}
+
+	static Value decodeCbor(Decoder& in)
+	{
+		auto offset = in.pos;
+		auto head = in.byte();
+		auto info = (uint8_t)(head & 0x1F);
+
+		switch (head >> 5)
+		{
+		case CborUnsigned:
+			return Value((double)readCborArgument(in, info, offset));
+
+		case CborNegative:
+			return Value(-1.0 - (double)readCborArgument(in, info, offset));
+
+		case CborBytes:
+		case CborText:
+		{
+			auto buffer = std::string();
+
+			return in.string(readCborText(in, head, offset, buffer));
+		}
+
+		case CborArray:
+			return decodeCborArray(in, info, offset);
+
+		case CborMap:
+			return decodeCborMap(in, info, offset);
+
+		case CborTag:
+		{
+			readCborArgument(in, info, offset);
+			in.enter();
+
+			auto out = decodeCbor(in);
+
+			in.leave();
+
+			return out;
+		}
+
+		default:
+			break;
+		}
+
+		switch (info)
+		{
+		case 20:
+			return Value(false);
+
+		case 21:
+			return Value(true);
+
+		case 22:
+		case 23:
+			return Value();
+
+		case 25:
+			return Value(decodeHalf((uint16_t)in.bigEndian(2)));
+
+		case 26:
+			return Value(in.float32());
+
+		case 27:
+			return Value(in.float64());
+
+		default:
+			in.fail("Unsupported simple value " + std::to_string(info), offset);
+		}
+	}
+
+	void toCbor(Writer& out, const Value& value)
+	{
+		encodeCbor(out, value);
+	}
+
+	void toCbor(std::ostream& out, const Value& value)
+	{
+		auto writer = Writer(out);
+
+		encodeCbor(writer, value);
+		writer.flush();
+	}
+
+	std::string toCbor(const Value& value)
+	{
+		auto writer = Writer();
+
+		encodeCbor(writer, value);
+
+		return writer.str();
+	}
+
+	Value fromCbor(std::string_view data)
+	{
+		return decode(decodeCbor, "CBOR", data, nullptr, false);
+	}
+
+	Value fromCbor(std::string_view data, Arena& arena)
+	{
+		return decode(decodeCbor, "CBOR", data, &arena, false);
+	}
+
+	Value fromCborView(std::string_view data, Arena& arena)
+	{
+		return decode(decodeCbor, "CBOR", data, &arena, true);
+	}
+}
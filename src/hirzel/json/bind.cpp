@@ -0,0 +1,212 @@
+#include <hirzel/json/bind.hpp>
+#include <hirzel/json/number.hpp>
+#include <charconv>
+#include <cmath>
+
+namespace hirzel::json
+{
+	static std::runtime_error unexpected(const Token& token, const char* expected)
+	{
+		if (token.type() == TokenType::EndOfFile)
+			return std::runtime_error("Expected " + std::string(expected) + ", got end of file.");
+
+		return std::runtime_error("Expected " + std::string(expected) + ", got '" + token.text() + "'.");
+	}
+
+	static std::runtime_error outOfRange(const Token& token)
+	{
+		return std::runtime_error("Number '" + token.text() + "' is out of range.");
+	}
+
+	bool enterContainer(Token& token, TokenType open, size_t depth)
+	{
+		if (token.type() != open)
+			throw unexpected(token, open == TokenType::LeftBrace ? "object" : "array");
+
+		if (depth >= maxParseDepth)
+			throw std::runtime_error(std::string(describe(ParseError::TooDeep)) + " at pos: " + std::to_string(token.pos()) + ".");
+
+		auto close = open == TokenType::LeftBrace
+			? TokenType::RightBrace
+			: TokenType::RightBracket;
+
+		token.seekNext();
+
+		if (token.type() != close)
+			return true;
+
+		token.seekNext();
+
+		return false;
+	}
+
+	bool nextInContainer(Token& token, TokenType close)
+	{
+		if (token.type() == TokenType::Comma)
+		{
+			token.seekNext();
+			return true;
+		}
+
+		if (token.type() != close)
+			throw unexpected(token, close == TokenType::RightBrace ? "',' or '}'" : "',' or ']'");
+
+		token.seekNext();
+
+		return false;
+	}
+
+	std::string_view readKey(Token& token, std::string& buffer)
+	{
+		if (token.type() != TokenType::String)
+			throw unexpected(token, "label");
+
+		auto key = std::string_view(token.src() + token.pos() + 1, token.length() - 2);
+
+		if (findEscape(key) != key.size())
+		{
+			unescape(key, buffer);
+			key = buffer;
+		}
+
+		token.seekNext();
+
+		if (token.type() != TokenType::Colon)
+			throw unexpected(token, "':'");
+
+		token.seekNext();
+
+		return key;
+	}
+
+	bool readNull(Token& token)
+	{
+		if (token.type() != TokenType::Null)
+			return false;
+
+		token.seekNext();
+
+		return true;
+	}
+
+	bool readBoolean(Token& token)
+	{
+		auto type = token.type();
+
+		if (type != TokenType::True && type != TokenType::False)
+			throw unexpected(token, "boolean");
+
+		token.seekNext();
+
+		return type == TokenType::True;
+	}
+
+	double readNumber(Token& token)
+	{
+		if (token.type() != TokenType::Number)
+			throw unexpected(token, "number");
+
+		auto number = token.number();
+
+		token.seekNext();
+
+		return number;
+	}
+
+	// Integers written with a fraction or exponent are accepted as long as
+	// they are whole, e.g. 1e3
+	template <typename Integer>
+	static Integer readWhole(Token& token, Integer min, Integer max)
+	{
+		if (token.type() != TokenType::Number)
+			throw unexpected(token, "integer");
+
+		auto* first = token.src() + token.pos();
+		auto* last = first + token.length();
+		auto value = Integer();
+		auto result = std::from_chars(first, last, value);
+
+		if (result.ec == std::errc::result_out_of_range || (result.ec == std::errc() && result.ptr == last && (value < min || value > max)))
+			throw outOfRange(token);
+
+		if (result.ec != std::errc() || result.ptr != last)
+		{
+			auto number = token.number();
+
+			if (number != std::floor(number))
+				throw unexpected(token, "integer");
+
+			// The bounds as doubles round up for 64-bit types, hence >= for max
+			if (number < (double)min || number >= (double)max + 1.0)
+				throw outOfRange(token);
+
+			value = (Integer)number;
+		}
+
+		token.seekNext();
+
+		return value;
+	}
+
+	int64_t readInteger(Token& token, int64_t min, int64_t max)
+	{
+		return readWhole(token, min, max);
+	}
+
+	uint64_t readUnsigned(Token& token, uint64_t max)
+	{
+		return readWhole<uint64_t>(token, 0, max);
+	}
+
+	void readString(Token& token, std::string& out)
+	{
+		if (token.type() != TokenType::String)
+			throw unexpected(token, "string");
+
+		auto text = std::string_view(token.src() + token.pos() + 1, token.length() - 2);
+
+		if (findEscape(text) == text.size())
+			out.assign(text.data(), text.size());
+		else
+			unescape(text, out);
+
+		token.seekNext();
+	}
+
+	void skipValue(Token& token, std::string& buffer, size_t depth)
+	{
+		if (token.trySkipValidValue(buffer, depth))
+			return;
+
+		token.throwIfInvalid();
+
+		// Skipping only stops at an opening bracket when it is nested too deep
+		if (token.type() == TokenType::LeftBrace || token.type() == TokenType::LeftBracket)
+			throw std::runtime_error(std::string(describe(ParseError::TooDeep)) + " at pos: " + std::to_string(token.pos()) + ".");
+
+		throw unexpected(token, "value");
+	}
+
+	void writeNumber(Writer& out, double value)
+	{
+		char buffer[maxNumberLength];
+
+		out.write(buffer, formatNumber(value, buffer));
+	}
+
+	void writeInteger(Writer& out, int64_t value)
+	{
+		char buffer[24];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+		out.write(buffer, (size_t)(result.ptr - buffer));
+	}
+
+	void writeUnsigned(Writer& out, uint64_t value)
+	{
+		char buffer[24];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+		out.write(buffer, (size_t)(result.ptr - buffer));
+	}
+}
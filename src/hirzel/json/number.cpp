@@ -0,0 +1,273 @@
+#include <hirzel/json/number.hpp>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+#include <cstring>
+
+#if !defined(__cpp_lib_to_chars)
+#include <locale>
+#include <sstream>
+#include <string>
+#endif
+
+namespace hirzel::json
+{
+	// Every power of ten up to 1e22 is exactly representable as a double
+	static constexpr double exactPowersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	static constexpr size_t maxMantissaDigits = 19;
+	static constexpr uint64_t maxExactMantissa = uint64_t(1) << 53;
+
+	static constexpr double maxExactInteger = 9007199254740992.0;
+
+	static inline bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	// Only reached with text already known to be a valid number. The magnitude
+	// is the decimal exponent of the leading digit plus one, which is all that
+	// is needed to tell overflow from underflow.
+	static void parseSlow(const char* src, size_t length, bool isNegative, int64_t magnitude, double& out)
+	{
+#if defined(__cpp_lib_to_chars)
+		auto result = std::from_chars(src, src + length, out);
+		auto isOutOfRange = result.ec == std::errc::result_out_of_range;
+#else
+		auto stream = std::istringstream(std::string(src, length));
+
+		stream.imbue(std::locale::classic());
+		stream >> out;
+
+		auto isOutOfRange = stream.fail();
+#endif
+
+		if (isOutOfRange)
+		{
+			auto value = magnitude > 0
+				? HUGE_VAL
+				: 0.0;
+
+			out = isNegative
+				? -value
+				: value;
+		}
+	}
+
+	bool parseNumber(const char* src, size_t length, double& out)
+	{
+		const auto* iter = src;
+		const auto* end = src + length;
+		auto isNegative = iter < end && *iter == '-';
+
+		if (isNegative)
+			iter += 1;
+
+		// The digits are read into mantissa * 10^exponent. Digits past the
+		// nineteenth no longer fit, so a nonzero one means the pair is inexact.
+		uint64_t mantissa = 0;
+		int64_t exponent = 0;
+		size_t digitCount = 0;
+		bool isTruncated = false;
+
+		const auto* integerStart = iter;
+
+		for (; iter < end && isDigit(*iter); ++iter)
+		{
+			if (digitCount < maxMantissaDigits)
+			{
+				mantissa = mantissa * 10 + (*iter - '0');
+				digitCount += mantissa != 0;
+			}
+			else
+			{
+				exponent += 1;
+				isTruncated |= *iter != '0';
+			}
+		}
+
+		if (iter == integerStart)
+			return false;
+
+		if (iter < end && *iter == '.')
+		{
+			iter += 1;
+
+			const auto* fractionStart = iter;
+
+			for (; iter < end && isDigit(*iter); ++iter)
+			{
+				if (digitCount < maxMantissaDigits)
+				{
+					mantissa = mantissa * 10 + (*iter - '0');
+					digitCount += mantissa != 0;
+					exponent -= 1;
+				}
+				else
+				{
+					isTruncated |= *iter != '0';
+				}
+			}
+
+			if (iter == fractionStart)
+				return false;
+		}
+
+		if (iter < end && (*iter == 'e' || *iter == 'E'))
+		{
+			iter += 1;
+
+			auto isExponentNegative = iter < end && *iter == '-';
+
+			if (iter < end && (*iter == '-' || *iter == '+'))
+				iter += 1;
+
+			const auto* exponentStart = iter;
+			int64_t explicitExponent = 0;
+
+			for (; iter < end && isDigit(*iter); ++iter)
+			{
+				// Anything this large over- or underflows regardless of the digits
+				if (explicitExponent < 100000)
+					explicitExponent = explicitExponent * 10 + (*iter - '0');
+			}
+
+			if (iter == exponentStart)
+				return false;
+
+			exponent += isExponentNegative
+				? -explicitExponent
+				: explicitExponent;
+		}
+
+		if (iter != end)
+			return false;
+
+#if FLT_EVAL_METHOD == 0
+		if (!isTruncated)
+		{
+			double value;
+
+			if (mantissa == 0)
+			{
+				value = 0.0;
+			}
+			else if (exponent == 0)
+			{
+				// A single conversion, so it is correctly rounded even above 2^53
+				value = (double)mantissa;
+			}
+			else if (mantissa <= maxExactMantissa && exponent >= -22 && exponent <= 22)
+			{
+				// Both operands are exact, so the one rounding step is the correct one
+				value = exponent < 0
+					? (double)mantissa / exactPowersOfTen[-exponent]
+					: (double)mantissa * exactPowersOfTen[exponent];
+			}
+			else
+			{
+				parseSlow(src, length, isNegative, exponent + (int64_t)digitCount, out);
+
+				return true;
+			}
+
+			out = isNegative
+				? -value
+				: value;
+
+			return true;
+		}
+#endif
+
+		parseSlow(src, length, isNegative, exponent + (int64_t)digitCount, out);
+
+		return true;
+	}
+
+	static size_t formatInteger(int64_t value, char* out)
+	{
+		char digits[20];
+		size_t digitCount = 0;
+		size_t length = 0;
+		auto magnitude = value < 0
+			? (uint64_t)0 - (uint64_t)value
+			: (uint64_t)value;
+
+		do
+		{
+			digits[digitCount] = (char)('0' + magnitude % 10);
+			digitCount += 1;
+			magnitude /= 10;
+		}
+		while (magnitude > 0);
+
+		if (value < 0)
+		{
+			out[length] = '-';
+			length += 1;
+		}
+
+		while (digitCount > 0)
+		{
+			digitCount -= 1;
+			out[length] = digits[digitCount];
+			length += 1;
+		}
+
+		return length;
+	}
+
+	size_t formatNumber(double value, char* out)
+	{
+		if (!std::isfinite(value))
+		{
+			std::memcpy(out, "null", 4);
+			return 4;
+		}
+
+		if (value >= -maxExactInteger && value <= maxExactInteger)
+		{
+			auto integer = (int64_t)value;
+
+			// Negative zero is left to the general path so its sign survives
+			if ((double)integer == value && (integer != 0 || !std::signbit(value)))
+				return formatInteger(integer, out);
+		}
+
+#if defined(__cpp_lib_to_chars)
+		auto result = std::to_chars(out, out + maxNumberLength, value);
+
+		return result.ptr - out;
+#else
+		auto text = std::string();
+
+		// 17 significant digits always round-trip, but fewer usually suffice
+		for (int precision = 15; precision <= 17; ++precision)
+		{
+			auto stream = std::ostringstream();
+
+			stream.imbue(std::locale::classic());
+			stream.precision(precision);
+			stream << value;
+			text = stream.str();
+
+			double reparsed;
+
+			if (parseNumber(text.data(), text.length(), reparsed) && reparsed == value)
+				break;
+		}
+
+		std::memcpy(out, text.data(), text.length());
+
+		return text.length();
+#endif
+	}
+}
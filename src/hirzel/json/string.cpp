@@ -0,0 +1,431 @@
+#include <hirzel/json/string.hpp>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define HIRZEL_JSON_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define HIRZEL_JSON_NO_SANITIZE_ADDRESS __attribute__((no_sanitize("address", "thread")))
+#else
+#define HIRZEL_JSON_NO_SANITIZE_ADDRESS
+#endif
+
+namespace hirzel::json
+{
+	static constexpr char hexDigits[] = "0123456789abcdef";
+
+	static inline int trailingZeroes(uint32_t bits)
+	{
+#if defined(__GNUC__)
+		return __builtin_ctz(bits);
+#else
+		int count = 0;
+
+		while (!(bits & 1))
+		{
+			bits >>= 1;
+			count += 1;
+		}
+
+		return count;
+#endif
+	}
+
+#ifdef HIRZEL_JSON_SSE2
+
+	// Aligned loads never cross a page boundary, so scanning whole blocks
+	// around the terminator cannot fault even though it reads past the string.
+	HIRZEL_JSON_NO_SANITIZE_ADDRESS
+	static inline uint32_t stringEndMask(const char* block)
+	{
+		auto in = _mm_load_si128((const __m128i*)block);
+		auto special = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('\"')), _mm_cmpeq_epi8(in, _mm_set1_epi8('\\'))),
+			_mm_cmpeq_epi8(in, _mm_setzero_si128()));
+
+		return (uint32_t)_mm_movemask_epi8(special);
+	}
+
+	static inline uint32_t backslashMask(const char* block)
+	{
+		auto in = _mm_loadu_si128((const __m128i*)block);
+
+		return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('\\')));
+	}
+
+	static inline uint32_t escapableMask(const char* block)
+	{
+		auto in = _mm_loadu_si128((const __m128i*)block);
+		auto control = _mm_cmpeq_epi8(_mm_max_epu8(in, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+		auto special = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('\"')), _mm_cmpeq_epi8(in, _mm_set1_epi8('\\'))),
+			control);
+
+		return (uint32_t)_mm_movemask_epi8(special);
+	}
+
+	const char* skipString(const char* iter)
+	{
+		while (true)
+		{
+			auto offset = (uintptr_t)iter & 15;
+			const auto* block = iter - offset;
+			auto mask = stringEndMask(block) & (0xFFFFu << offset);
+
+			while (mask == 0)
+			{
+				block += 16;
+				mask = stringEndMask(block);
+			}
+
+			const auto* hit = block + trailingZeroes(mask);
+
+			if (*hit != '\\')
+				return hit;
+
+			if (hit[1] == '\0')
+				return hit + 1;
+
+			iter = hit + 2;
+		}
+	}
+
+#else
+
+	const char* skipString(const char* iter)
+	{
+		while (*iter != '\"' && *iter != '\0')
+		{
+			if (*iter == '\\' && iter[1] != '\0')
+				iter += 1;
+
+			iter += 1;
+		}
+
+		return iter;
+	}
+
+#endif
+
+	static inline bool isEscapable(char c)
+	{
+		return c == '\"' || c == '\\' || (unsigned char)c < 0x20;
+	}
+
+#ifdef HIRZEL_JSON_SSE2
+
+	// Runs mask over text in blocks. The tail is copied into a block padded
+	// with a byte that never matches, which is cheaper than scanning it bytewise.
+	template <uint32_t (*mask)(const char*)>
+	static inline size_t findFirst(const char* src, size_t length)
+	{
+		size_t i = 0;
+
+		for (; i + 16 <= length; i += 16)
+		{
+			auto bits = mask(src + i);
+
+			if (bits != 0)
+				return i + trailingZeroes(bits);
+		}
+
+		if (i == length)
+			return length;
+
+		char block[16];
+
+		std::memset(block, 'x', sizeof(block));
+		std::memcpy(block, src + i, length - i);
+
+		auto bits = mask(block);
+
+		return bits != 0
+			? i + trailingZeroes(bits)
+			: length;
+	}
+
+	size_t findEscape(std::string_view text)
+	{
+		return findFirst<backslashMask>(text.data(), text.size());
+	}
+
+	static size_t findEscapable(const char* src, size_t length)
+	{
+		return findFirst<escapableMask>(src, length);
+	}
+
+#else
+
+	size_t findEscape(std::string_view text)
+	{
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			if (text[i] == '\\')
+				return i;
+		}
+
+		return text.size();
+	}
+
+	static size_t findEscapable(const char* src, size_t length)
+	{
+		for (size_t i = 0; i < length; ++i)
+		{
+			if (isEscapable(src[i]))
+				return i;
+		}
+
+		return length;
+	}
+
+#endif
+
+	static bool parseHex4(const char* iter, const char* end, uint32_t& out)
+	{
+		if (end - iter < 4)
+			return false;
+
+		uint32_t value = 0;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			auto c = iter[i];
+
+			value <<= 4;
+
+			if (c >= '0' && c <= '9')
+				value |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				value |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				value |= c - 'A' + 10;
+			else
+				return false;
+		}
+
+		out = value;
+
+		return true;
+	}
+
+	static char* encodeUtf8(uint32_t codePoint, char* out)
+	{
+		if (codePoint < 0x80)
+		{
+			out[0] = (char)codePoint;
+			return out + 1;
+		}
+
+		if (codePoint < 0x800)
+		{
+			out[0] = (char)(0xC0 | (codePoint >> 6));
+			out[1] = (char)(0x80 | (codePoint & 0x3F));
+			return out + 2;
+		}
+
+		if (codePoint < 0x10000)
+		{
+			out[0] = (char)(0xE0 | (codePoint >> 12));
+			out[1] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+			out[2] = (char)(0x80 | (codePoint & 0x3F));
+			return out + 3;
+		}
+
+		out[0] = (char)(0xF0 | (codePoint >> 18));
+		out[1] = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+		out[2] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+		out[3] = (char)(0x80 | (codePoint & 0x3F));
+		return out + 4;
+	}
+
+	static ParseError decode(std::string_view text, char* out, size_t& length, size_t& errorOffset)
+	{
+		const auto* iter = text.data();
+		const auto* end = iter + text.size();
+		auto* dst = out;
+
+		while (true)
+		{
+			auto runLength = findEscape(std::string_view(iter, end - iter));
+
+			std::memcpy(dst, iter, runLength);
+			dst += runLength;
+			iter += runLength;
+
+			if (iter == end)
+				break;
+
+			errorOffset = iter - text.data();
+
+			if (iter + 1 == end)
+				return ParseError::InvalidEscape;
+
+			switch (iter[1])
+			{
+			case '\"':
+			case '\\':
+			case '/':
+				*dst++ = iter[1];
+				break;
+
+			case 'b':
+				*dst++ = '\b';
+				break;
+
+			case 'f':
+				*dst++ = '\f';
+				break;
+
+			case 'n':
+				*dst++ = '\n';
+				break;
+
+			case 'r':
+				*dst++ = '\r';
+				break;
+
+			case 't':
+				*dst++ = '\t';
+				break;
+
+			case 'u':
+			{
+				auto codePoint = (uint32_t)0;
+
+				if (!parseHex4(iter + 2, end, codePoint))
+					return ParseError::InvalidUnicodeEscape;
+
+				iter += 6;
+
+				auto low = (uint32_t)0;
+
+				if (codePoint >= 0xD800 && codePoint <= 0xDBFF && end - iter >= 6 && iter[0] == '\\' && iter[1] == 'u'
+					&& parseHex4(iter + 2, end, low) && low >= 0xDC00 && low <= 0xDFFF)
+				{
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+					iter += 6;
+				}
+
+				if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+					codePoint = 0xFFFD;
+
+				dst = encodeUtf8(codePoint, dst);
+				continue;
+			}
+
+			default:
+				return ParseError::InvalidEscape;
+			}
+
+			iter += 2;
+		}
+
+		length = dst - out;
+
+		return ParseError::None;
+	}
+
+	size_t unescape(std::string_view text, char* out)
+	{
+		auto length = (size_t)0;
+		auto errorOffset = (size_t)0;
+		auto error = decode(text, out, length, errorOffset);
+
+		if (error == ParseError::None)
+			return length;
+
+		auto escape = text.substr(errorOffset, error == ParseError::InvalidUnicodeEscape ? 6 : 2);
+
+		if (escape.length() < 2 || (error == ParseError::InvalidUnicodeEscape && escape.length() < 6))
+			throw std::runtime_error(std::string("Incomplete ") + (error == ParseError::InvalidUnicodeEscape ? "unicode " : "") + "escape sequence.");
+
+		throw std::runtime_error(std::string(describe(error)) + ": '" + std::string(escape) + "'.");
+	}
+
+	void unescape(std::string_view text, std::string& out)
+	{
+		out.resize(text.size());
+		out.resize(unescape(text, out.data()));
+	}
+
+	ParseError tryUnescape(std::string_view text, std::string& out, size_t& errorOffset)
+	{
+		auto length = (size_t)0;
+
+		out.resize(text.size());
+
+		auto error = decode(text, out.data(), length, errorOffset);
+
+		out.resize(length);
+
+		return error;
+	}
+
+	void writeEscaped(Writer& out, std::string_view text)
+	{
+		const auto* iter = text.data();
+		const auto* end = iter + text.size();
+
+		out.put('\"');
+
+		while (true)
+		{
+			auto runLength = findEscapable(iter, end - iter);
+
+			out.write(iter, runLength);
+			iter += runLength;
+
+			if (iter == end)
+				break;
+
+			auto c = *iter;
+
+			switch (c)
+			{
+			case '\"':
+				out.write("\\\"", 2);
+				break;
+
+			case '\\':
+				out.write("\\\\", 2);
+				break;
+
+			case '\b':
+				out.write("\\b", 2);
+				break;
+
+			case '\f':
+				out.write("\\f", 2);
+				break;
+
+			case '\n':
+				out.write("\\n", 2);
+				break;
+
+			case '\r':
+				out.write("\\r", 2);
+				break;
+
+			case '\t':
+				out.write("\\t", 2);
+				break;
+
+			default:
+			{
+				char escape[] = { '\\', 'u', '0', '0', hexDigits[(c >> 4) & 0xF], hexDigits[c & 0xF] };
+
+				out.write(escape, sizeof(escape));
+				break;
+			}
+			}
+
+			iter += 1;
+		}
+
+		out.put('\"');
+	}
+}
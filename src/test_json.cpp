@@ -1,5 +1,23 @@
 #include <hirzel/json.hpp>
+#include <hirzel/json/StructuralIndex.hpp>
+#include <hirzel/json/number.hpp>
+#include <hirzel/json/WorkerPool.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 
 using namespace hirzel;
 using namespace hirzel::json;
@@ -309,6 +327,11 @@ void assert_object(const Value& obj, const Object& value)
 	assert_equals(obj, Value(value));
 }
 
+std::string padded(const char* json)
+{
+	return json + std::string(300, ' ');
+}
+
 void assert_parse_throws(const char *json)
 {
 	try
@@ -412,6 +435,36 @@ void test_number()
 	assert_number(Value(-1023), -1023);
 	assert_number(Value(62), 62);
 
+	// Short strings live inline and survive copies, moves and reassignment
+	static_assert(sizeof(Value) == 16);
+
+	for (size_t length = 0; length <= Value::inlineCapacity + 2; ++length)
+	{
+		auto text = std::string(length, 'x');
+
+		for (size_t i = 0; i < length; ++i)
+			text[i] = (char)('a' + i);
+
+		auto value = Value(text);
+		auto moved = Value(std::string(text));
+
+		assert(value.isInline() == (length <= Value::inlineCapacity));
+		assert(moved.isInline() == value.isInline());
+		assert(value.string() == text);
+		assert(moved.string() == text);
+
+		auto copied = value;
+		auto taken = Value(std::move(value));
+
+		assert(copied.string() == text);
+		assert(taken.string() == text);
+		assert(value.isNull());
+
+		copied = Value("replacement");
+		assert(copied.string() == "replacement");
+		assert(taken == deserialize("\"" + text + "\""));
+	}
+
 	assert_not_equals(move, Value());
 	assert_not_equals(move, Value(130));
 	assert_not_equals(move, Value(-130));
@@ -480,6 +533,84 @@ void test_number()
 	assert_parse_throws(".123e1");
 	assert_parse_throws("23.e1");
 	assert_parse_throws("23.1e1.2");
+	assert_parse_throws("1e");
+	assert_parse_throws("1e+");
+	assert_parse_throws("1e-.5");
+
+	assert_json("1e-5", 1e-5);
+	assert_json("-2.5E+3", -2.5e3);
+
+	// Conversions must be correctly rounded, so they agree bit for bit with strtod
+	auto assert_rounding = [](const std::string& text)
+	{
+		[[maybe_unused]] auto expected = std::strtod(text.c_str(), nullptr);
+		[[maybe_unused]] double actual;
+
+		assert(parseNumber(text.data(), text.length(), actual));
+		assert(std::memcmp(&expected, &actual, sizeof(double)) == 0);
+	};
+
+	for (const auto* text : {
+		"9007199254740993", "18446744073709551615", "18446744073709551616", "0.1", "-0",
+		"2.2250738585072011e-308", "4.9406564584124654e-324", "1.7976931348623157e308",
+		"1e400", "-1e-400", "123456789012345678901234567890", "0.000000000000000000000000000001",
+		"7.0420557077594588669468784357561207962098443483187940792729600000e+59",
+		"89255.0e-22", "1448997445238699", "3.0e23", "1e23", "0.3" })
+	{
+		assert_rounding(text);
+	}
+
+	auto random = std::mt19937_64(7);
+
+	for (size_t i = 0; i < 20000; ++i)
+	{
+		auto text = std::to_string(random() % 1000000000);
+
+		if (i % 2 == 0)
+			text += "." + std::to_string(random());
+
+		if (i % 3 != 0)
+			text += "e" + std::to_string((int)(random() % 660) - 340);
+
+		assert_rounding(text);
+	}
+
+	[[maybe_unused]] double value;
+
+	assert(!parseNumber("", 0, value));
+	assert(!parseNumber("-", 1, value));
+	assert(!parseNumber("1 ", 2, value));
+	assert(!parseNumber("+1", 2, value));
+
+	assert(serialize(Value(42)) == "42");
+	assert(serialize(Value(-7)) == "-7");
+	assert(serialize(Value(0)) == "0");
+	assert(serialize(Value(-0.0)) == "-0");
+	assert(serialize(Value(0.1)) == "0.1");
+	assert(serialize(Value(1.5e300)) == "1.5e+300");
+	assert(serialize(Value(9007199254740992.0)) == "9007199254740992");
+	assert(serialize(Value(1.0 / 0.0)) == "null");
+	assert(serialize(Value(std::nan(""))) == "null");
+
+	// Serialized numbers must parse back to the same bits
+	for (size_t i = 0; i < 20000; ++i)
+	{
+		uint64_t bits = random();
+		double expected;
+
+		std::memcpy(&expected, &bits, sizeof(double));
+
+		if (!std::isfinite(expected))
+			continue;
+
+		char text[maxNumberLength];
+		[[maybe_unused]] auto length = formatNumber(expected, text);
+		[[maybe_unused]] double actual;
+
+		assert(length <= maxNumberLength);
+		assert(parseNumber(text, length, actual));
+		assert(std::memcmp(&expected, &actual, sizeof(double)) == 0);
+	}
 }
 
 void test_boolean()
@@ -572,7 +703,52 @@ void test_string()
 	assert_parse_throws("\"hello");
 	assert_parse_throws("\"hello\"\"");
 	assert_parse_throws("this is a string\"");
-} 
+
+	// escapes
+	assert_json("\"a\\\"b\"", "a\"b");
+	assert_json("\"\\\\\\/\\b\\f\\n\\r\\t\"", "\\/\b\f\n\r\t");
+	assert_json("\"\\u00e9\\u20AC\"", "\xc3\xa9\xe2\x82\xac");
+	assert_json("\"\\ud83d\\ude00\"", "\xf0\x9f\x98\x80");
+	assert_json("\"\\ud83d!\"", "\xef\xbf\xbd!");
+	assert_parse_throws("\"\\x\"");
+	assert_parse_throws("\"\\u12\"");
+	assert_parse_throws("\"\\u12g4\"");
+	assert_parse_throws("\"abc\\\"");
+	assert(deserialize(padded("{\"a\\\"b\": \"c\\nd\"}"))["a\"b"].string() == "c\nd");
+
+	// Escapes and terminators at every offset of the vector blocks
+	for (size_t length = 0; length < 48; ++length)
+	{
+		for (size_t escapeIndex = 0; escapeIndex <= length; ++escapeIndex)
+		{
+			auto text = std::string(length, 'x');
+
+			if (escapeIndex < length)
+				text[escapeIndex] = '\"';
+
+			auto json = serialize(Value(text));
+
+			assert(deserialize(json).string() == text);
+			assert(deserialize(std::string(escapeIndex, ' ') + json).string() == text);
+		}
+	}
+
+	assert(serialize(Value("a\"b\\c\n\x01\x1f")) == "\"a\\\"b\\\\c\\n\\u0001\\u001f\"");
+
+	auto random = std::mt19937(3);
+
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		auto text = std::string(random() % 40, ' ');
+
+		for (auto& c : text)
+			c = (char)(1 + random() % 255);
+
+		auto value = Value(text);
+
+		assert(deserialize(serialize(value)) == value);
+	}
+}
 
 void test_array()
 {
@@ -838,6 +1014,52 @@ void test_object()
 	assert_json("{\"key\":\"value\",\"number\":298}", Object({ { "key", "value" }, { "number", 298 } }));
 	assert_json("{\"table\":{\"subtable\":567}}", Object({ { "table", Object({ { "subtable", 567 } }) } }));
 
+	// Members keep insertion order, and the first of duplicate keys wins
+	assert(serialize(deserialize("{\"b\":1,\"a\":2,\"c\":3,\"a\":4}"), true) == "{\"b\":1,\"a\":2,\"c\":3}");
+
+	// Lookups agree on both sides of the index threshold and through erasure
+	auto members = Object();
+	auto expected = std::vector<std::string>();
+
+	for (size_t i = 0; i < 100; ++i)
+	{
+		auto key = "key" + std::to_string(i * 7919 % 100);
+
+		assert(members.emplace(key, Value(i)).second);
+		assert(!members.emplace(key, Value(-1)).second);
+		assert(members.isIndexed() == (members.size() > Object::indexThreshold));
+		expected.push_back(key);
+
+		for (size_t j = 0; j < expected.size(); ++j)
+			assert(members.find(expected[j])->second.number() == j);
+
+		assert(!members.contains("key" + std::to_string(i + 100)));
+	}
+
+	for (size_t i = 0; i < expected.size(); i += 2)
+		assert(members.erase(expected[i]) == 1);
+
+	assert(members.erase("missing") == 0);
+	assert(members.size() == 50);
+
+	auto position = (size_t)1;
+
+	for ([[maybe_unused]] const auto& member : members)
+	{
+		assert(std::string_view(member.first) == expected[position]);
+		assert(members.find(member.first)->second.number() == position);
+		position += 2;
+	}
+
+	while (members.size() > 3)
+		members.erase(members.begin()->first);
+
+	assert(!members.isIndexed());
+	assert(std::string_view(members.begin()->first) == expected[95]);
+	assert(members[expected[97]].number() == 97);
+	assert(members["added"].isNull());
+	assert(members.size() == 4);
+
 	assert_parse_throws("{");
 	assert_parse_throws("}");
 	assert_parse_throws("{a");
@@ -1032,6 +1254,2096 @@ void test_parse()
 	assert(from_json_clone == pokemon_expected);
 }
 
+void test_structural_index()
+{
+	auto index = StructuralIndex();
+	[[maybe_unused]] const char* json = R"({"a\"b": [1, true], "c": "}\\"} )";
+
+	assert(index.build(json, strlen(json)));
+	auto positions = std::vector<uint32_t>(index.positions(), index.positions() + index.count());
+	assert((positions == std::vector<uint32_t>{ 0, 1, 7, 9, 10, 11, 13, 17, 18, 20, 23, 25, 30, 32 }));
+
+	[[maybe_unused]] const char* commented = "{ \"a\": 1 // comment\n }";
+	assert(!index.build(commented, strlen(commented)));
+	assert(deserialize(padded(commented)) == Object({ { "a", 1 } }));
+
+	assert(deserialize(padded(colorsJson)) == deserialize(colorsJson));
+
+	assert_parse_throws(padded("nullb").c_str());
+	assert_parse_throws(padded("1x").c_str());
+	assert_parse_throws(padded("[1,]").c_str());
+	assert_parse_throws(padded("{\"a\":1}asdf").c_str());
+	assert_parse_throws(padded("\"hello\"\"").c_str());
+	assert_parse_throws(padded("23.1e1.2").c_str());
+
+	// Longer documents are indexed a piece at a time, with strings that
+	// straddle the pieces
+	auto strings = Array();
+	auto big = std::string("[");
+
+	for (size_t i = 0; i < 300; ++i)
+	{
+		strings.emplace_back(std::string(999, (char)('a' + i % 26)));
+		big += (i > 0 ? ",\"" : "\"") + std::string(999, (char)('a' + i % 26)) + "\"";
+	}
+
+	big += "]";
+
+	assert(index.build(big.c_str(), big.length()));
+	assert(index.count() == 2 * 300 + 2);
+	assert(deserialize(big) == Value(strings));
+}
+
+void test_arena()
+{
+	auto heap = deserialize(colorsJson);
+	auto copy = Value();
+
+	{
+		auto arena = Arena(256);
+
+		// Values from the arena are destroyed before it is reset
+		{
+			auto value = deserialize(colorsJson, arena);
+
+			assert(value.isBorrowed());
+			assert(value["colors"][0].isBorrowed());
+			assert(value["colors"][0]["color"].isInline());
+			assert(value == heap);
+			assert(value["colors"][2]["code"]["hex"].string() == "#FF0");
+			assert(arena.allocationCount() > 0);
+			assert(arena.bytesUsed() > 0);
+			assert(arena.bytesReserved() >= arena.bytesUsed());
+			assert(arena.blockCount() > 1);
+
+			copy = value;
+			assert(!copy.isBorrowed());
+			assert(!copy["colors"][0].isBorrowed());
+		}
+
+		arena.reset();
+		assert(arena.allocationCount() == 0);
+		assert(arena.bytesUsed() == 0);
+		assert(arena.blockCount() == 1);
+
+		auto reparsed = deserialize(pokemonJson, arena);
+		assert(reparsed == deserialize(pokemonJson));
+	}
+
+	assert(copy == heap);
+
+	// Heap values put in arena containers are released with the container
+	{
+		auto scoped = Arena();
+		auto array = deserialize("[1, 2]", scoped);
+		auto object = scoped.createObject();
+
+		array.array().push_back(Value(std::string(100, 'x')));
+		object.object().emplace(Key("k"), Value(Array({ Value(std::string(100, 'y')), Value(Object({ { "a long key that is not inline", Value(1) } })) })));
+		assert(array[2].string() == std::string(100, 'x'));
+		assert(object["k"][0].string() == std::string(100, 'y'));
+	}
+
+	// Parsed containers hold only arena values, so releasing them does no
+	// work per node, whereas a changed container is destroyed with its values
+	{
+		auto scoped = Arena();
+		[[maybe_unused]] auto released = (size_t)0;
+
+		{
+			const auto parsed = deserialize(colorsJson, scoped);
+			const auto decoded = fromMessagePack(toMessagePack(heap), scoped);
+
+			released = scoped.deallocationCount();
+		}
+
+		assert(scoped.deallocationCount() == released);
+
+		{
+			auto changed = deserialize(colorsJson, scoped);
+
+			changed["colors"].array().emplace_back(std::string(100, 'z'));
+			released = scoped.deallocationCount();
+		}
+
+		assert(scoped.deallocationCount() > released);
+	}
+
+	// Failing part way through leaves the arena usable, and reusable once reset
+	auto arena = Arena();
+	auto malformed = std::vector<std::string>({ "[\"a\", ", "{\"a\": [1, {\"b\": tru}]}", "[\"a long string that is not inline\", \"\\q\"]" });
+
+	for (const auto& text : malformed)
+	{
+		try
+		{
+			deserialize(text, arena);
+			assert(false && "deserialize should have thrown");
+		}
+		catch (const std::runtime_error&)
+		{
+		}
+
+		assert(!tryDeserialize(text, arena));
+	}
+
+	assert(deserialize(colorsJson, arena) == heap);
+	arena.reset();
+	assert(arena.bytesUsed() == 0);
+	assert(deserialize(colorsJson, arena) == heap);
+	assert(deserialize("\"\"", arena).string().empty());
+
+	// Unescaped strings view the source, escaped ones are decoded into the arena
+	auto source = std::string("[\"plain\", \"esc\\taped\"]");
+	const auto view = deserializeView(source, arena);
+
+	assert(view[0].string() == "plain");
+	assert(view[0].string().data() == source.data() + 2);
+	assert(view[1].string() == "esc\taped");
+	assert(view[1].string().data() < source.data() || view[1].string().data() >= source.data() + source.size());
+	assert(view == deserialize(source));
+
+	// Changing a borrowed string copies it out of the source first
+	auto changed = deserializeView(source, arena);
+
+	changed[0].string() += "!";
+	assert(!changed[0].isBorrowed());
+	assert(changed[0] == "plain!");
+	assert(source == "[\"plain\", \"esc\\taped\"]");
+}
+
+void test_shared_copy()
+{
+	auto original = deserialize(colorsJson);
+	[[maybe_unused]] const auto& frozen = original;
+	auto copy = original;
+
+	assert(original.isShared() && copy.isShared());
+	assert(&frozen.object() == &std::as_const(copy).object());
+	assert(copy == original);
+
+	// Reading through a const value leaves the payload shared
+	assert(std::as_const(copy)["colors"][0]["color"].string() == "black");
+	assert(copy.isShared());
+
+	// Writing copies only the containers on the way to the change
+	copy["colors"][0]["color"] = "white";
+
+	assert(!original.isShared() && !copy.isShared());
+	assert(frozen["colors"][0]["color"].string() == "black");
+	assert(copy["colors"][0]["color"].string() == "white");
+	assert(frozen["colors"][1].isShared());
+	assert(copy != original);
+
+	auto text = Value(std::string(Value::inlineCapacity + 1, 'x'));
+	auto textCopy = text;
+
+	assert(text.isShared() && std::as_const(textCopy).string().data() == std::as_const(text).string().data());
+	assert(!Value(1.5).isShared() && !Value("short").isShared());
+
+	// Strings changed in place are copied first if shared or inline
+	textCopy.string() += "y";
+	assert(!text.isShared() && text.string() == std::string(Value::inlineCapacity + 1, 'x'));
+	assert(textCopy.string() == std::string(Value::inlineCapacity + 1, 'x') + "y");
+
+	auto grown = Value("short");
+
+	grown.string().append(Value::inlineCapacity, '!');
+	assert(!grown.isInline() && grown.length() == 5 + Value::inlineCapacity);
+
+	// Keys borrowed from a pool must not outlive it through a shared payload
+	auto keys = KeyPool();
+	auto pooled = deserialize(colorsJson, keys);
+	auto pooledCopy = pooled;
+
+	assert(!pooled.isShared() && !pooledCopy.isShared());
+	assert(!pooledCopy["colors"][0].object().begin()->first.isBorrowed());
+
+	// Copies of one document may be made, read and dropped on several threads
+	auto expected = serialize(original);
+	auto threads = std::vector<std::thread>();
+	auto failures = std::atomic<size_t>(0);
+
+	for (size_t i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([&]()
+		{
+			for (size_t j = 0; j < 200; ++j)
+			{
+				const auto local = original;
+
+				if (serialize(local) != expected || local["colors"].length() != 6)
+					failures.fetch_add(1);
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	assert(failures.load() == 0);
+	assert(!original.isShared());
+}
+
+void test_document()
+{
+	auto paddedColors = padded(colorsJson);
+
+	for (const auto* json : { colorsJson, paddedColors.c_str(), "{\"colors\":[{\"code\":{\"hex\":\"#000\"}}]}" })
+	{
+		auto document = Document(json);
+		[[maybe_unused]] auto colors = document.root()["colors"];
+
+		assert(colors.isArray());
+		assert(colors[0]["code"]["hex"].string() == "#000");
+		assert(!colors.at(20));
+		assert(!colors[0].at("missing"));
+	}
+
+	auto document = Document(paddedColors);
+	auto root = document.root();
+	auto colors = root["colors"];
+
+	assert(root.type() == ValueType::Object);
+	assert(root.length() == 1);
+	assert(colors.length() == 6);
+	assert(colors[2]["color"].string() == "red");
+	assert(colors[2]["code"]["rgba"][0].number() == 255);
+	assert(colors[5]["type"].string() == "secondary");
+	assert(colors[3]["code"].value() == deserialize(colorsJson)["colors"][3]["code"]);
+	assert(root.value() == deserialize(colorsJson));
+
+	size_t hues = 0;
+
+	colors.forEachElement([&](const Cursor& color)
+	{
+		if (color["category"].string() == "hue")
+			hues += 1;
+	});
+
+	assert(hues == 5);
+
+	auto keys = std::string();
+
+	colors[1].forEachMember([&](std::string_view key, const Cursor&) { keys += key; });
+	assert(keys == "colorcategorycode");
+
+	auto literalsDocument = Document("[true, false, null, -1.5e2]");
+	[[maybe_unused]] auto literals = literalsDocument.root();
+	assert(literals[0].boolean());
+	assert(!literals[1].boolean());
+	assert(literals[2].isNull());
+	assert(literals[3].number() == -150.0);
+
+	auto assert_cursor_throws = [](const char* json, auto&& access)
+	{
+		try
+		{
+			access(Document(json).root());
+		}
+		catch (const std::exception&)
+		{
+			return;
+		}
+
+		assert(false && "Expected cursor access to throw.");
+	};
+
+	assert_cursor_throws("[1 2]", [](const Cursor& c) { c[1]; });
+	assert_cursor_throws("[1,]", [](const Cursor& c) { c[1]; });
+	assert_cursor_throws("[1,", [](const Cursor& c) { c[1]; });
+	assert_cursor_throws("[[1, 2]", [](const Cursor& c) { c[1]; });
+	assert_cursor_throws("{\"a\" 1}", [](const Cursor& c) { c["a"]; });
+	assert_cursor_throws("{\"a\": 1}", [](const Cursor& c) { c["b"]; });
+	assert_cursor_throws("{\"a\": 1}", [](const Cursor& c) { c[0]; });
+	assert_cursor_throws("\"a\"", [](const Cursor& c) { c.number(); });
+}
+
+struct EventCounter
+{
+	std::string events;
+	double total = 0.0;
+
+	void onNull() { events += "n"; }
+	void onBoolean(bool value) { events += value ? "t" : "f"; }
+	void onNumber(double value) { events += "#"; total += value; }
+	void onString(std::string_view value) { events += "\"" + std::string(value) + "\""; }
+	void onKey(std::string_view key) { events += std::string(key) + ":"; }
+	void onStartObject() { events += "{"; }
+	void onEndObject() { events += "}"; }
+	void onStartArray() { events += "["; }
+	void onEndArray() { events += "]"; }
+};
+
+void assert_events_throw(const char* json)
+{
+	auto counter = EventCounter();
+
+	try
+	{
+		parse(json, counter);
+	}
+	catch (const std::exception&)
+	{
+		return;
+	}
+
+	throw std::runtime_error("Expected parsing '" + std::string(json) + "' to throw exception.");
+}
+
+void test_escaped_cursor()
+{
+	const char* json = "{\"plain\": \"text\", \"tab\\tbed\": \"a\\u0041\"}";
+	auto document = Document(json);
+	auto root = document.root();
+	auto buffer = std::string();
+
+	assert(root["plain"].string(buffer).data() == json + 11);
+	assert(root["tab\tbed"].rawString() == "a\\u0041");
+	assert(root["tab\tbed"].string() == "aA");
+	assert(root["tab\tbed"].length() == 2);
+
+	auto keys = std::string();
+
+	root.forEachMember([&](std::string_view key, const Cursor&) { keys += key; keys += ','; });
+	assert(keys == "plain,tab\tbed,");
+
+	auto counter = EventCounter();
+
+	parse(json, counter);
+	assert(counter.events == "{plain:\"text\"tab\tbed:\"aA\"}");
+}
+
+void test_events()
+{
+	auto counter = EventCounter();
+
+	parse("{\"a\": [1, 2.5, true, false, null], \"b\": {\"c\": \"d\"}, \"e\": []}", counter);
+	assert(counter.events == "{a:[##tfn]b:{c:\"d\"}e:[]}");
+	assert(counter.total == 3.5);
+
+	struct RgbaSum
+	{
+		bool isRgba = false;
+		double total = 0.0;
+
+		void onNull() {}
+		void onBoolean(bool) {}
+		void onNumber(double value) { if (isRgba) total += value; }
+		void onString(std::string_view) {}
+		void onKey(std::string_view key) { isRgba = key == "rgba"; }
+		void onStartObject() {}
+		void onEndObject() {}
+		void onStartArray() {}
+		void onEndArray() { isRgba = false; }
+	};
+
+	auto sum = RgbaSum();
+
+	parse(padded(colorsJson), sum);
+	assert(sum.total == 255 * 8 + 6);
+
+	assert_events_throw("");
+	assert_events_throw("[1,]");
+	assert_events_throw("[1 2]");
+	assert_events_throw("{\"a\"}");
+	assert_events_throw("{\"a\":1,}");
+	assert_events_throw("{\"a\":1}true");
+	assert_events_throw(padded("[1, 2, 3]]").c_str());
+
+	// Nesting is limited as for deserialize, rather than by the stack
+	auto deep = std::string(maxParseDepth, '[') + std::string(maxParseDepth, ']');
+	auto tooDeep = std::string(2000000, '[');
+	auto nested = EventCounter();
+
+	parse(deep, nested);
+	assert_events_throw(("[" + deep + "]").c_str());
+	assert_events_throw(tooDeep.c_str());
+	assert(tryDeserialize(tooDeep).error() == ParseError::TooDeep);
+
+	try
+	{
+		parse(tooDeep, nested);
+		assert(false && "parse should have thrown");
+	}
+	catch (const std::runtime_error& e)
+	{
+		assert(std::string(e.what()).find(describe(ParseError::TooDeep)) != std::string::npos);
+	}
+}
+
+EventCounter push_events(const std::string& json, size_t chunkSize)
+{
+	auto counter = EventCounter();
+	auto parser = PushParser<EventCounter>(counter);
+
+	for (size_t i = 0; i < json.length(); i += chunkSize)
+		parser.feed(json.data() + i, std::min(chunkSize, json.length() - i));
+
+	parser.finish();
+
+	return counter;
+}
+
+void assert_push_throws(const std::string& json)
+{
+	for (size_t chunkSize = 1; chunkSize <= json.length() + 1; ++chunkSize)
+	{
+		try
+		{
+			push_events(json, chunkSize);
+		}
+		catch (const std::exception&)
+		{
+			continue;
+		}
+
+		throw std::runtime_error("Expected pushing '" + json + "' to throw exception.");
+	}
+}
+
+void test_push_parser()
+{
+	const char* documents[] = {
+		"{\"a\": [1, 2.5, true, false, null], \"b\": {\"c\": \"d\\\"\"}, \"e\": []}",
+		"  -12.5e3 ",
+		"123",
+		"null",
+		"\"\"",
+		"[[[], {}], /* note */ [\"\\\\\"]] // trailing"
+	};
+
+	for (const auto* document : documents)
+	{
+		auto expected = EventCounter();
+		auto json = std::string(document);
+
+		parse(json, expected);
+
+		for (size_t chunkSize = 1; chunkSize <= json.length(); ++chunkSize)
+		{
+			auto actual = push_events(json, chunkSize);
+
+			assert(actual.events == expected.events);
+			assert(actual.total == expected.total);
+		}
+	}
+
+	for (const auto* document : { colorsJson, pokemonJson })
+	{
+		auto expected = deserialize(document);
+
+		for (size_t chunkSize : { 1, 3, 64, 4096 })
+		{
+			auto builder = ValueBuilder();
+			auto parser = PushParser<ValueBuilder>(builder);
+			auto json = std::string(document);
+
+			for (size_t i = 0; i < json.length(); i += chunkSize)
+				parser.feed(json.data() + i, std::min(chunkSize, json.length() - i));
+
+			parser.finish();
+			assert(parser.isComplete());
+			assert(builder.take() == expected);
+		}
+	}
+
+	auto counter = EventCounter();
+	auto parser = PushParser<EventCounter>(counter);
+
+	parser.feed("[1, tr");
+	assert(counter.events == "[#");
+	assert(parser.depth() == 1);
+	parser.feed("ue, \"ab");
+	assert(counter.events == "[#t");
+	parser.feed("c\"]");
+	assert(counter.events == "[#t\"abc\"]");
+	assert(parser.isComplete());
+	parser.finish();
+
+	assert_push_throws("");
+	assert_push_throws("[1,]");
+	assert_push_throws("[1 2]");
+	assert_push_throws("{\"a\"}");
+	assert_push_throws("{\"a\":1,}");
+	assert_push_throws("{\"a\":1}true");
+	assert_push_throws("[1, 2, 3]]");
+	assert_push_throws("[1, 2");
+	assert_push_throws("tru");
+	assert_push_throws("truex");
+	assert_push_throws("\"abc");
+	assert_push_throws("1.2.3");
+	assert_push_throws("[1] /* open");
+}
+
+void test_ndjson()
+{
+	auto ndjson = std::string();
+
+	for (size_t i = 0; i < 500; ++i)
+	{
+		if (i % 50 == 7)
+			ndjson += "{\"id\": " + std::to_string(i) + ",}\n";
+		else if (i % 50 == 8)
+			ndjson += "   \r\n";
+		else
+			ndjson += "{\"id\": " + std::to_string(i) + ", \"tags\": [\"a\", \"b\"]}\n";
+	}
+
+	// Final line without a terminating newline
+	ndjson += "[500]";
+
+	for (size_t threadCount : { 1, 2, 4 })
+	{
+		for (size_t chunkSize : { 1, 100, 1 << 20 })
+		{
+			auto records = NdjsonReader(threadCount, true, chunkSize).read(ndjson);
+
+			assert(records.size() == 491);
+
+			size_t errorCount = 0;
+			[[maybe_unused]] size_t previousLine = 0;
+
+			for (const auto& record : records)
+			{
+				assert(record.line > previousLine);
+				previousLine = record.line;
+
+				auto index = record.line - 1;
+
+				assert(ndjson.compare(record.offset, 1, index == 500 ? "[" : "{") == 0);
+
+				if (index % 50 == 7)
+				{
+					assert(record.isError());
+					errorCount += 1;
+					continue;
+				}
+
+				assert(!record.isError());
+
+				if (index == 500)
+					assert(record.value[0].number() == 500);
+				else
+					assert(record.value["id"].number() == index);
+			}
+
+			assert(errorCount == 10);
+
+			auto unordered = NdjsonReader(threadCount, false, chunkSize).read(ndjson);
+			auto lines = std::vector<size_t>();
+
+			for (const auto& record : unordered)
+				lines.push_back(record.line);
+
+			std::sort(lines.begin(), lines.end());
+			assert(lines.size() == records.size());
+
+			for (size_t i = 0; i < lines.size(); ++i)
+				assert(lines[i] == records[i].line);
+		}
+	}
+
+	assert(NdjsonReader().read("").empty());
+	assert(NdjsonReader().read("\n\n").empty());
+
+	// Each line ends at its newline even where the next line would complete it
+	auto longArray = std::string("[0");
+
+	for (size_t i = 1; i < 100; ++i)
+		longArray += ", " + std::to_string(i);
+
+	auto spilling = std::vector<std::string> { "[1,", "2]", "\"open", "\"closed\"", longArray, "]", "{} /* comment", "*/", longArray + "]" };
+	auto joined = std::string();
+
+	for (const auto& line : spilling)
+		joined += line + "\n";
+
+	auto spilled = NdjsonReader(1).read(joined);
+
+	assert(spilled.size() == spilling.size());
+
+	for (size_t i = 0; i < spilling.size(); ++i)
+	{
+		auto expected = tryDeserialize(spilling[i]);
+
+		assert(spilled[i].isError() == !expected);
+		assert(spilled[i].error == (expected ? "" : expected.message()));
+	}
+
+	assert(spilled.back().value.length() == 100);
+	assert(spilled[3].value.string() == "closed");
+
+	size_t count = 0;
+
+	try
+	{
+		NdjsonReader(2, true, 64).read(ndjson.c_str(), ndjson.length(), [&](NdjsonRecord&&)
+		{
+			if (++count == 20)
+				throw std::runtime_error("stop");
+		});
+		assert(false);
+	}
+	catch (const std::runtime_error& e)
+	{
+		assert(std::string(e.what()) == "stop");
+		assert(count == 20);
+	}
+
+	// A worker that throws cancels the rest, and its exception reaches join
+	auto isCancelled = std::atomic<bool>(false);
+	auto started = std::atomic<size_t>(0);
+	auto pool = WorkerPool(4, [&]()
+	{
+		if (started.fetch_add(1) == 0)
+			throw std::runtime_error("worker");
+
+		while (!isCancelled.load())
+			std::this_thread::yield();
+	}, [&]() { isCancelled = true; });
+
+	try
+	{
+		pool.join();
+		assert(false && "join should have rethrown");
+	}
+	catch (const std::runtime_error& e)
+	{
+		assert(std::string(e.what()) == "worker");
+		assert(isCancelled.load());
+	}
+
+	// Destroying a pool without joining cancels and joins its workers
+	isCancelled = false;
+
+	{
+		auto unjoined = WorkerPool(2, [&]() { while (!isCancelled.load()) std::this_thread::yield(); }, [&]() { isCancelled = true; });
+	}
+
+	assert(isCancelled.load());
+}
+
+void test_writer()
+{
+	auto document = Value(Array({ Value(true), Value(false), Value(), Value(1.5), Value("a"), Value(Object({ { "k", Value(Array()) } })) }));
+
+	assert(serialize(document, true) == "[true,false,null,1.5,\"a\",{\"k\":[]}]");
+	assert(serialize(document) == "[\n\ttrue,\n\tfalse,\n\tnull,\n\t1.5,\n\t\"a\",\n\t{\n\t\t\"k\": []\n\t}\n]");
+
+	auto stream = std::ostringstream();
+
+	stream << document;
+	assert(stream.str() == serialize(document));
+
+	// Stream writers flush in blocks smaller than the output
+	auto pokemon = deserialize(pokemonJson);
+	auto small = std::ostringstream();
+
+	{
+		auto writer = Writer(small, 16);
+
+		serialize(writer, pokemon);
+	}
+
+	assert(small.str() == serialize(pokemon));
+
+	char buffer[16];
+	auto fixed = Writer(buffer, sizeof(buffer));
+
+	serialize(fixed, Value(Array({ Value(1), Value(2) })), true);
+	assert(!fixed.isOverflowed());
+	assert(fixed.view() == "[1,2]");
+
+	fixed.clear();
+	serialize(fixed, pokemon, true);
+	assert(fixed.isOverflowed());
+	assert(fixed.length() <= sizeof(buffer));
+
+	fixed.clear();
+	serialize(fixed, Value("fits"), true);
+	assert(!fixed.isOverflowed());
+	assert(fixed.view() == "\"fits\"");
+
+	// Indentation deeper than the precomputed run of tabs
+	auto deep = Value(1);
+
+	for (size_t i = 0; i < 70; ++i)
+		deep = Value(Array({ deep }));
+
+	auto text = serialize(deep);
+
+	assert(deserialize(text) == deep);
+	assert(text.find("\n" + std::string(70, '\t') + "1\n") != std::string::npos);
+}
+
+void test_serialize_parallel()
+{
+	auto records = Array();
+	auto wide = Object();
+
+	for (size_t i = 0; i < 5000; ++i)
+	{
+		records.emplace_back(Object({
+			{ "id", Value(i) },
+			{ "name", Value("record \"" + std::to_string(i) + "\"") },
+			{ "tags", Value(Array({ Value(i % 3 == 0), Value(), Value(Array()) })) },
+			{ "empty", Value(Object()) }
+		}));
+	}
+
+	// Containers with this many members or more are split
+	const size_t splitLength = 1024;
+
+	for (size_t i = 0; i < splitLength + 7; ++i)
+		wide.emplace(Key("key" + std::to_string(i)), Value(i * 0.5));
+
+	// Large containers at the top, nested in small ones, and just too small to split
+	auto documents = std::vector<Value>({
+		Value(records),
+		Value(Object({ { "meta", Value(Object({ { "count", Value(5000) } })) }, { "records", Value(records) }, { "wide", Value(wide) } })),
+		Value(Array({ Value(Array(splitLength - 1, Value(1))), Value(Array(splitLength, Value("x"))) })),
+		Value(Array()),
+		Value("scalar")
+	});
+
+	for (const auto& document : documents)
+	{
+		for (auto minimized : { false, true })
+		{
+			auto expected = serialize(document, minimized);
+
+			for ([[maybe_unused]] size_t threadCount : { 0, 1, 2, 3, 8 })
+				assert(serializeParallel(document, minimized, threadCount) == expected);
+
+			auto stream = std::ostringstream();
+
+			serializeParallel(stream, document, minimized, 4);
+			assert(stream.str() == expected);
+		}
+	}
+
+	// A fixed buffer that is too small overflows as it would for serialize
+	char buffer[64];
+	auto writer = Writer(buffer, sizeof(buffer));
+
+	serializeParallel(writer, documents[0], true, 4);
+	assert(writer.isOverflowed());
+
+	// A stream that fails part way stops the workers and reports the failure
+	struct FailingBuffer : std::streambuf
+	{
+		int overflow(int) override { return traits_type::eof(); }
+		std::streamsize xsputn(const char*, std::streamsize) override { return 0; }
+	};
+
+	auto failing = FailingBuffer();
+	auto broken = std::ostream(&failing);
+
+	broken.exceptions(std::ios::badbit);
+
+	try
+	{
+		serializeParallel(broken, documents[0], false, 4);
+		assert(false && "serializeParallel should have thrown");
+	}
+	catch (const std::ios_base::failure&)
+	{
+	}
+}
+
+void test_key_pool()
+{
+	auto shortKey = Key("color");
+	auto longKey = Key("a-key-too-long-to-fit-inline");
+	auto text = std::string("borrowed-key-text-outside");
+	auto borrowed = Key::borrow(text);
+
+	assert(shortKey.isInline() && shortKey == "color");
+	assert(!longKey.isInline() && !longKey.isBorrowed() && longKey == "a-key-too-long-to-fit-inline");
+	assert(borrowed.isBorrowed() && borrowed.data() == text.data());
+
+	auto copy = borrowed;
+	auto moved = Key(std::move(longKey));
+
+	assert(!copy.isBorrowed() && copy == text && copy.data() != text.data());
+	assert(moved == "a-key-too-long-to-fit-inline" && longKey == "");
+	copy = shortKey;
+	assert(copy.isInline() && copy == "color");
+
+	auto keys = KeyPool();
+
+	// Keys short enough to be inline never reach the pool
+	assert(deserialize(colorsJson, keys) == deserialize(colorsJson));
+	assert(keys.keyCount() == 0);
+	assert(keys.lookupCount() == 0);
+
+	auto records = std::string(R"([{"record-identifier": 1, "record-category": "x", "id": 1}, {"record-identifier": 2, "record-category": "y", "id": 2}])");
+	auto first = deserialize(records, keys);
+	[[maybe_unused]] auto storedBytes = keys.bytesStored();
+	[[maybe_unused]] auto storedKeys = keys.keyCount();
+
+	assert(first == deserialize(records));
+	assert(storedKeys == 2);
+	assert(keys.hitCount() == 2);
+
+	auto second = deserialize(records, keys);
+	[[maybe_unused]] const auto& a = first[0].object();
+	[[maybe_unused]] const auto& b = second[1].object();
+
+	// Every key is shared, and the second document added nothing to the pool
+	assert(keys.keyCount() == storedKeys);
+	assert(keys.bytesStored() == storedBytes);
+	assert(a.begin()->first.isBorrowed());
+	assert(a.begin()->first.data() == b.begin()->first.data());
+	assert(keys.bytesSaved() > storedBytes);
+	assert(keys.hitRate() > 0.5 && keys.hitRate() < 1.0);
+
+	// Copies own their keys, so they outlive the pool
+	auto detached = Value();
+
+	{
+		auto scoped = KeyPool();
+		auto parsed = deserialize(records, scoped);
+
+		detached = parsed;
+	}
+
+	assert(detached == first);
+	assert(!detached[0].object().begin()->first.isBorrowed());
+
+	// Keys over the length limit or past the byte budget are not interned
+	auto limited = KeyPool(20, 30);
+	auto kept = std::string(16, 'a');
+
+	assert(!limited.intern(std::string(21, 'b')).isBorrowed());
+	assert(limited.intern(kept).isBorrowed());
+	assert(limited.intern(std::string(16, 'c')).isBorrowed() == false);
+	assert(limited.intern(kept).isBorrowed());
+	assert(limited.intern("short").isInline());
+	assert(limited.keyCount() == 1);
+	assert(limited.lookupCount() == 4);
+	assert(limited.hitCount() == 1);
+
+	// Concurrent interning hands every thread the same storage
+	auto shared = KeyPool();
+	auto threads = std::vector<std::thread>();
+	auto pointers = std::vector<std::vector<const char*>>(4);
+
+	for (size_t t = 0; t < pointers.size(); ++t)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (size_t i = 0; i < 1000; ++i)
+				pointers[t].push_back(shared.intern("concurrent-key-" + std::to_string(i % 100)).data());
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	for (size_t t = 1; t < pointers.size(); ++t)
+		assert(pointers[t] == pointers[0]);
+
+	assert(shared.keyCount() == 100);
+	assert(shared.hitCount() == 3900);
+
+	auto ndjson = std::string();
+
+	for (size_t i = 0; i < 200; ++i)
+		ndjson += "{\"record-identifier\": " + std::to_string(i) + ", \"record-category\": \"x\"}\n";
+
+	auto reader = NdjsonReader(4, true, 256);
+	auto pool = KeyPool();
+
+	reader.setKeyPool(&pool);
+
+	auto lines = reader.read(ndjson);
+
+	assert(lines.size() == 200);
+	assert(lines[199].value["record-identifier"].number() == 199);
+	assert(pool.keyCount() == 2);
+	assert(pool.hitCount() == 398);
+}
+
+void assert_parse_error(const std::string& json, [[maybe_unused]] ParseError error, [[maybe_unused]] size_t offset)
+{
+	// Long inputs go through the structural index, short ones do not
+	for (const auto& text : { json, json + std::string(300, ' ') })
+	{
+		auto result = tryDeserialize(text);
+
+		assert(!result.isOk());
+		assert(result.error() == error);
+		assert(result.offset() == (error == ParseError::UnexpectedEndOfFile ? text.length() : offset));
+	}
+}
+
+void test_try_deserialize()
+{
+	auto result = tryDeserialize(colorsJson);
+
+	assert(result);
+	assert(result.error() == ParseError::None);
+	assert(result.value() == deserialize(colorsJson));
+	assert(result.take()["colors"].length() == 6);
+
+	// The end of file is wherever the input ends
+	assert_parse_error("", ParseError::UnexpectedEndOfFile, 0);
+	assert_parse_error("[1, 2", ParseError::UnexpectedEndOfFile, 0);
+	assert_parse_error("{\"a\": 1", ParseError::UnexpectedEndOfFile, 0);
+	assert_parse_error("[1 2]", ParseError::ExpectedCommaOrBracket, 3);
+	assert_parse_error("{\"a\": 1 \"b\": 2}", ParseError::ExpectedCommaOrBrace, 8);
+	assert_parse_error("{\"a\" 1}", ParseError::ExpectedColon, 5);
+	assert_parse_error("{1: 1}", ParseError::ExpectedKey, 1);
+	assert_parse_error("[1,]", ParseError::UnexpectedCharacter, 3);
+	assert_parse_error("[tru]", ParseError::InvalidLiteral, 1);
+	assert_parse_error("[@]", ParseError::UnexpectedCharacter, 1);
+	assert_parse_error("[1, \x80 2]", ParseError::UnexpectedCharacter, 4);
+	assert_parse_error("[1.]", ParseError::InvalidNumber, 1);
+	assert_parse_error("[-x]", ParseError::InvalidNumber, 1);
+	assert_parse_error("[\"abc", ParseError::UnterminatedString, 1);
+	assert_parse_error("[\"ab\\qc\"]", ParseError::InvalidEscape, 4);
+	assert_parse_error("{\"k\\u12G4\": 1}", ParseError::InvalidUnicodeEscape, 3);
+	assert_parse_error("[1] 2", ParseError::TrailingContent, 4);
+	assert_parse_error(std::string(maxParseDepth + 1, '['), ParseError::TooDeep, maxParseDepth);
+
+	auto deep = std::string(maxParseDepth, '[') + std::string(maxParseDepth, ']');
+
+	assert(tryDeserialize(deep));
+
+	// Line and column are counted from the offset on request
+	auto text = std::string("{\n\t\"a\": 1,\n\t\"b\": tru\n}");
+	auto error = tryDeserialize(text);
+
+	assert(error.error() == ParseError::InvalidLiteral);
+	assert(error.line() == 3);
+	assert(error.column() == 7);
+	assert(error.message() == "Invalid literal at line 3, column 7 (offset 17).");
+
+	try
+	{
+		deserialize(text);
+		assert(false && "deserialize should have thrown");
+	}
+	catch (const std::runtime_error& e)
+	{
+		assert(std::string(e.what()) == "Failed to deserialize JSON: " + error.message());
+	}
+
+	auto arena = Arena();
+	auto keys = KeyPool();
+
+	assert(tryDeserialize(colorsJson, arena).value() == deserialize(colorsJson));
+	assert(tryDeserialize(colorsJson, keys).value() == deserialize(colorsJson));
+	assert(tryDeserialize("[\"\\x\"]", arena).error() == ParseError::InvalidEscape);
+}
+
+void test_deserialize_into()
+{
+	auto first = std::string(R"({"id": 1, "tags": ["a", "b", "c"], "note": "a note too long to be inline", "meta": {"ok": true}})");
+	auto second = std::string(R"({"id": 2, "tags": ["d", "e"], "note": "another long note, \"escaped\"", "meta": {"ok": false}})");
+	auto value = Value();
+
+	deserializeInto(first, value);
+	assert(value == deserialize(first));
+
+	const auto& view = value;
+	[[maybe_unused]] const auto* tags = &view["tags"].array();
+	[[maybe_unused]] const auto* note = view["note"].string().data();
+	[[maybe_unused]] const auto* meta = &view["meta"].object();
+
+	// The same shape is parsed into the containers and strings already there
+	deserializeInto(second, value);
+	assert(value == deserialize(second));
+	assert(&view["tags"].array() == tags);
+	assert(view["note"].string().data() == note);
+	assert(&view["meta"].object() == meta);
+
+	// Members that move, disappear or change type are handled like a fresh parse
+	auto changes = std::vector<std::string>({
+		R"({"meta": {"ok": true, "extra": [1]}, "id": "one"})",
+		R"({"id": 3, "tags": [], "note": "x", "meta": null, "more": {"a": 1}})",
+		R"({"a": 1, "a": 2, "b": 3})",
+		R"([1, {"a": "b"}, [2, 3]])",
+		R"([{"a": "b"}])",
+		R"("text")",
+		first
+	});
+
+	for (const auto& text : changes)
+	{
+		deserializeInto(text, value);
+		assert(value == deserialize(text));
+		assert(serialize(value) == serialize(deserialize(text)));
+	}
+
+	// A copy keeps what it had instead of being parsed into
+	auto copy = value;
+
+	deserializeInto(second, value);
+	assert(copy == deserialize(first));
+	assert(value == deserialize(second));
+
+	auto parser = Parser();
+	auto reused = Value();
+
+	for (const auto& text : changes)
+	{
+		parser.parseInto(text, reused);
+		assert(reused == deserialize(text));
+	}
+
+	assert(!parser.tryParseInto("[1, 2", reused));
+	assert(parser.error() == ParseError::UnexpectedEndOfFile);
+	assert(!parser.tryParseInto("{\"a\": tru}", reused));
+	assert(parser.error() == ParseError::InvalidLiteral);
+	assert(parser.errorOffset() == 6);
+	assert(parser.tryParseInto(first, reused) && parser.error() == ParseError::None);
+	assert(reused == deserialize(first));
+
+	try
+	{
+		parser.parseInto("[1] 2", reused);
+		assert(false && "parseInto should have thrown");
+	}
+	catch (const std::runtime_error& e)
+	{
+		assert(std::string(e.what()) == "Failed to deserialize JSON: " + tryDeserialize("[1] 2").message());
+	}
+
+	// Assigning releases the old payload, even when the new value is part of it
+	auto tree = deserialize(first);
+
+	tree = tree;
+	assert(tree == deserialize(first));
+	tree = std::move(tree);
+	assert(tree == deserialize(first));
+	tree = std::as_const(tree)["meta"];
+	assert(tree == deserialize(R"({"ok": true})"));
+	tree = std::move(tree["ok"]);
+	assert(tree == Value(true));
+}
+
+void test_pointer()
+{
+	// The example document from RFC 6901, section 5
+	auto rfc = deserialize(R"({
+		"foo": ["bar", "baz"],
+		"": 0,
+		"a/b": 1,
+		"c%d": 2,
+		"e^f": 3,
+		"g|h": 4,
+		"i\\j": 5,
+		"k\"l": 6,
+		" ": 7,
+		"m~n": 8
+	})");
+
+	assert(*Pointer("").resolve(rfc) == rfc);
+	assert(*Pointer("/foo").resolve(rfc) == rfc["foo"]);
+	assert(*Pointer("/foo/0").resolve(rfc) == "bar");
+	assert(*Pointer("/").resolve(rfc) == 0);
+	assert(*Pointer("/a~1b").resolve(rfc) == 1);
+	assert(*Pointer("/c%d").resolve(rfc) == 2);
+	assert(*Pointer("/e^f").resolve(rfc) == 3);
+	assert(*Pointer("/g|h").resolve(rfc) == 4);
+	assert(*Pointer("/i\\j").resolve(rfc) == 5);
+	assert(*Pointer("/k\"l").resolve(rfc) == 6);
+	assert(*Pointer("/ ").resolve(rfc) == 7);
+	assert(*Pointer("/m~0n").resolve(rfc) == 8);
+
+	// ~01 unescapes to ~1, not to /
+	assert(Pointer("/~01").key(0) == "~1");
+	assert(Pointer("/a/").depth() == 2);
+	assert(Pointer("/a/").key(1).empty());
+
+	auto colors = deserialize(colorsJson);
+	auto rgba = Pointer("/colors/3/code/rgba/0");
+
+	assert(colors.at(rgba) == &colors["colors"][3]["code"]["rgba"][0]);
+	assert(Pointer("/colors/-").resolve(colors) == nullptr);
+	assert(Pointer("/colors/01").resolve(colors) == nullptr);
+	assert(Pointer("/colors/6").resolve(colors) == nullptr);
+	assert(Pointer("/colors/0/color/x").resolve(colors) == nullptr);
+	assert(Pointer("/missing/0").resolve(colors) == nullptr);
+
+	// Digits name members of objects like any other token
+	auto numbered = deserialize("{\"0\": {\"01\": true}}");
+
+	assert(*Pointer("/0/01").resolve(numbered) == true);
+
+	*Pointer("/colors/0/color").resolve(colors) = "white";
+	assert(colors["colors"][0]["color"] == "white");
+
+	// Writing through a pointer unshares every container on the way
+	auto doc = deserialize(R"({"a": {"b": [1, 2]}})");
+	auto copy = doc;
+
+	*copy.at(Pointer("/a/b/0")) = Value(99);
+	assert(copy["a"]["b"][0] == 99);
+	assert(doc == deserialize(R"({"a": {"b": [1, 2]}})"));
+
+	// Objects past the index threshold resolve through the hash index
+	auto wide = Object();
+
+	for (int i = 0; i < 64; ++i)
+		wide["key" + std::to_string(i)] = i;
+
+	assert(*Pointer("/key42").resolve(Value(wide)) == 42);
+
+	for (const auto* invalid : { "a", "/~", "/~2", "/a~" })
+	{
+		try
+		{
+			Pointer(std::string_view(invalid));
+			assert(false && "pointer should be invalid");
+		}
+		catch (const std::runtime_error&)
+		{}
+	}
+
+	auto set = PointerSet({
+		Pointer("/colors/1/code/hex"),
+		Pointer("/colors/1/code/rgba/2"),
+		Pointer("/missing/a"),
+		Pointer("/colors/1/code"),
+		Pointer(""),
+		Pointer("/missing/b"),
+		Pointer("/colors/1/type"),
+		Pointer("/colors/9/code"),
+		Pointer("/colors/1/code/hex")
+	});
+	auto found = set.resolve(colors);
+
+	assert(found.size() == set.size());
+
+	for (size_t i = 0; i < set.size(); ++i)
+		assert(found[i] == set.pointers()[i].resolve(colors));
+
+	assert(*found[0] == "#FFF");
+	assert(found[2] == nullptr);
+	assert(found[4] == &colors);
+	assert(found[7] == nullptr);
+
+	// Pointers deeper than the inline path still resolve
+	auto deep = Value(1);
+	auto deepText = std::string();
+
+	for (int i = 0; i < 40; ++i)
+	{
+		deep = Array({ std::move(deep) });
+		deepText += "/0";
+	}
+
+	auto deepSet = PointerSet({ Pointer(deepText), Pointer(deepText + "/0") });
+
+	assert(*deepSet.resolve(deep)[0] == 1);
+	assert(deepSet.resolve(deep)[1] == nullptr);
+}
+
+// Runs query over both a parsed value and the raw text and checks that
+// each finds exactly the expected values, in order
+void assert_query(const char* json, const char* query, const std::vector<Value>& expected)
+{
+	auto compiled = Query(query);
+	auto value = deserialize(json);
+	auto values = compiled.select(value);
+
+	assert(values.size() == expected.size());
+
+	for (size_t i = 0; i < expected.size(); ++i)
+		assert(*values[i] == expected[i]);
+
+	auto text = padded(json);
+
+	for (const auto* src : { json, text.c_str() })
+	{
+		auto document = Document(src);
+		auto cursors = compiled.select(document);
+
+		assert(cursors.size() == expected.size());
+
+		for (size_t i = 0; i < expected.size(); ++i)
+		{
+			assert(cursors[i].value() == expected[i]);
+			assert(deserialize(std::string(cursors[i].raw())) == expected[i]);
+		}
+	}
+}
+
+void test_query()
+{
+	assert_query(colorsJson, "$", { deserialize(colorsJson) });
+	assert_query(colorsJson, "$.colors[1].color", { "white" });
+	assert_query(colorsJson, "$['colors'][1][\"color\"]", { "white" });
+	assert_query(colorsJson, "$.colors[*].color", { "black", "white", "red", "blue", "yellow", "green" });
+	assert_query(colorsJson, "$.colors[?(@.category=='hue')].code.hex", { "#000", "#FF0", "#00F", "#FF0", "#0F0" });
+	assert_query(colorsJson, "$.colors[?(@.category != 'hue')].color", { "white" });
+	assert_query(colorsJson, "$.colors[?(@.code.rgba[0] >= 255)].color", { "black", "red", "yellow" });
+	assert_query(colorsJson, "$.colors[?(@.code.rgba[2] < 1)].color", { "white", "red", "yellow", "green" });
+	assert_query(colorsJson, "$.colors[?(@.type)].type", { "primary", "primary", "primary", "primary", "secondary" });
+	assert_query(colorsJson, "$.colors[?(@.type == 1)]", {});
+	assert_query(colorsJson, "$.colors[9].color", {});
+	assert_query(colorsJson, "$.colors.color", {});
+	assert_query(colorsJson, "$.colors[0].code.*", { Array({ 255, 255, 255, 1 }), "#000" });
+	assert_query(colorsJson, "$..hex", { "#000", "#FFF", "#FF0", "#00F", "#FF0", "#0F0" });
+	assert_query(colorsJson, "$..rgba[3]", { 1, 1, 1, 1, 1, 1 });
+	assert_query(colorsJson, "$.colors[5]..*", { "green", "hue", "secondary", deserialize(colorsJson)["colors"][5]["code"],
+		Array({ 0, 255, 0, 1 }), 0, 255, 0, 1, "#0F0" });
+	assert_query("{\"a\": {\"name\": 1}, \"name\": 2}", "$..name", { 1, 2 });
+	assert_query("[[0, 1], [[2]], 3]", "$..[0]", { Array({ 0, 1 }), 0, Array({ 2 }), 2 });
+
+	auto mixed = "[{\"a\": true}, {\"a\": null}, {\"a\": \"x\\ny\"}, {\"a\": -2.5e1}, 3]";
+
+	assert_query(mixed, "$[?(@.a == true)].a", { true });
+	assert_query(mixed, "$[?(@.a == null)].a", { Value() });
+	assert_query(mixed, "$[?(@.a == 'x\ny')].a", { "x\ny" });
+	assert_query(mixed, "$[?(@.a < -10)].a", { -25 });
+	assert_query(mixed, "$[?(@.a != null)].a", { true, "x\ny", -25 });
+
+	auto colors = Document(colorsJson);
+	[[maybe_unused]] auto cursor = colors.root();
+
+	assert(Query("$.colors[1].code").select(cursor)[0].raw() == "{\n\t\t\t\t\"rgba\": [0,0,0,1],\n\t\t\t\t\"hex\": \"#FFF\"\n\t\t\t}");
+	assert(Query("$.colors[1].code.rgba[1]").select(cursor)[0].raw() == "0");
+
+	// Descendant steps walk as deep as deserialize goes and no further
+	auto deep = std::string(maxParseDepth, '[') + std::string(maxParseDepth, ']');
+	auto tooDeep = std::string(1000000, '[') + std::string(1000000, ']');
+
+	assert(Query("$..*").select(deserialize(deep)).size() == maxParseDepth - 1);
+	assert(Query("$..*").select(Document(deep)).size() == maxParseDepth - 1);
+
+	try
+	{
+		Query("$..*").select(Document(tooDeep));
+		assert(false && "query should not select");
+	}
+	catch (const std::runtime_error& e)
+	{
+		assert(std::string(e.what()).find(describe(ParseError::TooDeep)) != std::string::npos);
+	}
+
+	for (const auto* invalid : { "", "colors", "$.", "$[", "$[1", "$['a", "$[?(@.a = 1)]", "$[?(@.a == )]", "$[?(a)]", "$x" })
+	{
+		try
+		{
+			Query(std::string_view(invalid));
+			assert(false && "query should be invalid");
+		}
+		catch (const std::runtime_error&)
+		{}
+	}
+}
+
+std::string bytes(std::initializer_list<int> values)
+{
+	auto out = std::string();
+
+	for (auto value : values)
+		out += (char)value;
+
+	return out;
+}
+
+void assert_decode_throws(Value (*decode)(std::string_view), const std::string& data)
+{
+	try
+	{
+		decode(data);
+	}
+	catch (const std::runtime_error&)
+	{
+		return;
+	}
+
+	assert(false && "decoding should have thrown");
+}
+
+void test_binary()
+{
+	auto numbers = Value(Array({ 0, 1, 127, 128, 255, 256, 65535, 65536, 4294967295.0, 4294967296.0, -1, -32, -33,
+		-128, -129, -32768, -32769, -2147483648.0, -2147483649.0, 1.5, 0.1, -0.0, 1e300, 9007199254740992.0 }));
+	auto text = Value(Array({ "", "short", std::string(31, 's'), std::string(32, 'm'), std::string(255, 'm'),
+		std::string(256, 'l'), std::string(70000, 'x'), "tab\tnull\0byte" }));
+
+	for (const auto& value : { deserialize(colorsJson), deserialize(pokemonJson), numbers, text,
+		Value(), Value(true), Value(false), Value(Array()), Value(Object()) })
+	{
+		assert(fromMessagePack(toMessagePack(value)) == value);
+		assert(fromCbor(toCbor(value)) == value);
+
+		auto arena = Arena();
+		auto packed = toMessagePack(value);
+		auto cbor = toCbor(value);
+
+		assert(fromMessagePack(packed, arena) == value);
+		assert(fromMessagePackView(packed, arena) == value);
+		assert(fromCbor(cbor, arena) == value);
+		assert(fromCborView(cbor, arena) == value);
+
+		auto stream = std::ostringstream();
+
+		toMessagePack(stream, value);
+		assert(stream.str() == packed);
+	}
+
+	// Examples from the MessagePack and CBOR specifications
+	auto compact = Value(Object({ { "compact", true }, { "schema", 0 } }));
+
+	assert(toMessagePack(compact) == bytes({ 0x82, 0xA7, 'c', 'o', 'm', 'p', 'a', 'c', 't', 0xC3, 0xA6, 's', 'c', 'h', 'e', 'm', 'a', 0x00 }));
+	assert(toMessagePack(-33) == bytes({ 0xD0, 0xDF }));
+	assert(toMessagePack(1.5) == bytes({ 0xCA, 0x3F, 0xC0, 0x00, 0x00 }));
+	assert(toCbor(0) == bytes({ 0x00 }));
+	assert(toCbor(24) == bytes({ 0x18, 0x18 }));
+	assert(toCbor(1000) == bytes({ 0x19, 0x03, 0xE8 }));
+	assert(toCbor(-1000) == bytes({ 0x39, 0x03, 0xE7 }));
+	assert(toCbor(1.1) == bytes({ 0xFB, 0x3F, 0xF1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A }));
+	assert(toCbor(deserialize("{\"a\": 1, \"b\": [2, 3]}")) == bytes({ 0xA2, 0x61, 'a', 0x01, 0x61, 'b', 0x82, 0x02, 0x03 }));
+	assert(fromCbor(bytes({ 0xF9, 0x3E, 0x00 })) == 1.5);
+	assert(fromCbor(bytes({ 0xF9, 0xC4, 0x00 })) == -4);
+	assert(fromCbor(bytes({ 0xF7 })).isNull());
+	assert(fromCbor(bytes({ 0xC1, 0x1A, 0x51, 0x4B, 0x67, 0xB0 })) == 1363896240);
+	assert(fromCbor(bytes({ 0x9F, 0x01, 0x82, 0x02, 0x03, 0x9F, 0x04, 0x05, 0xFF, 0xFF })) == deserialize("[1, [2, 3], [4, 5]]"));
+	assert(fromCbor(bytes({ 0x7F, 0x65, 's', 't', 'r', 'e', 'a', 0x64, 'm', 'i', 'n', 'g', 0xFF })) == "streaming");
+	assert(fromCbor(bytes({ 0xBF, 0x61, 'a', 0x01, 0xFF })) == Object({ { "a", 1 } }));
+	assert(fromMessagePack(bytes({ 0xC4, 0x02, 0x00, 0xFF })).string() == bytes({ 0x00, 0xFF }));
+	assert(fromMessagePack(bytes({ 0x81, 0xC4, 0x01, 'k', 0xC0 })) == Object({ { "k", Value() } }));
+
+	// Views refer to the encoded data rather than copying out of it
+	auto arena = Arena();
+	auto packed = toMessagePack(Object({ { "a long enough member name", "a long enough string value" } }));
+	auto view = fromMessagePackView(packed, arena);
+	[[maybe_unused]] const auto& member = *view.object().begin();
+
+	assert(member.first.isBorrowed());
+	assert(member.first.data() >= packed.data() && member.first.data() < packed.data() + packed.size());
+	assert(member.second.isBorrowed());
+	assert(member.second.string().data() >= packed.data() && member.second.string().data() < packed.data() + packed.size());
+
+	auto cbor = toCbor(Object({ { "a long enough member name", "a long enough string value" } }));
+
+	assert(fromCborView(cbor, arena).object().begin()->second.isBorrowed());
+
+	assert_decode_throws(fromMessagePack, "");
+	assert_decode_throws(fromCbor, "");
+	assert_decode_throws(fromMessagePack, std::string(maxParseDepth + 1, (char)0x91) + '\0');
+	assert_decode_throws(fromCbor, std::string(maxParseDepth + 1, (char)0x81) + '\0');
+
+	assert_decode_throws(fromMessagePack, bytes({ 0x92, 0x01 }));
+	assert_decode_throws(fromMessagePack, bytes({ 0xDB, 0xFF, 0xFF, 0xFF, 0xFF }));
+	assert_decode_throws(fromMessagePack, bytes({ 0x01, 0x02 }));
+	assert_decode_throws(fromMessagePack, bytes({ 0x81, 0x01, 0x02 }));
+	assert_decode_throws(fromMessagePack, bytes({ 0xD4, 0x01, 0x02 }));
+	assert_decode_throws(fromCbor, bytes({ 0x82, 0x01 }));
+	assert_decode_throws(fromCbor, bytes({ 0x1C }));
+	assert_decode_throws(fromCbor, bytes({ 0xA1, 0x01, 0x02 }));
+	assert_decode_throws(fromCbor, bytes({ 0x7F, 0x41, 'a', 0xFF }));
+	assert_decode_throws(fromCbor, bytes({ 0x9F, 0x01 }));
+	assert_decode_throws(fromCbor, bytes({ 0xFF }));
+}
+
+struct BoundCode
+{
+	std::vector<int> rgba;
+	std::string hex;
+};
+
+struct BoundColor
+{
+	std::string name;
+	std::string category;
+	std::optional<std::string> type;
+	BoundCode code;
+};
+
+struct BoundColors
+{
+	std::vector<BoundColor> colors;
+};
+
+struct BoundScalars
+{
+	bool flag = false;
+	int8_t small = 0;
+	uint16_t port = 0;
+	int64_t big = 0;
+	uint64_t huge = 0;
+	float ratio = 0;
+	double value = 0;
+	std::optional<double> maybe;
+	std::map<std::string, std::vector<bool>> flags;
+	std::unordered_map<std::string, std::optional<int>> counts;
+};
+
+struct BoundNode
+{
+	std::string label;
+	std::vector<BoundNode> children;
+};
+
+namespace hirzel::json
+{
+	template <>
+	struct Binding<BoundCode>
+	{
+		static constexpr auto fields = std::make_tuple(
+			field("rgba", &BoundCode::rgba),
+			field("hex", &BoundCode::hex));
+	};
+
+	template <>
+	struct Binding<BoundColor>
+	{
+		static constexpr auto fields = std::make_tuple(
+			field("color", &BoundColor::name),
+			field("category", &BoundColor::category),
+			field("type", &BoundColor::type),
+			field("code", &BoundColor::code));
+	};
+
+	template <>
+	struct Binding<BoundColors>
+	{
+		static constexpr auto fields = std::make_tuple(field("colors", &BoundColors::colors));
+	};
+
+	template <>
+	struct Binding<BoundScalars>
+	{
+		static constexpr auto fields = std::make_tuple(
+			field("flag", &BoundScalars::flag),
+			field("small", &BoundScalars::small),
+			field("port", &BoundScalars::port),
+			field("big", &BoundScalars::big),
+			field("huge", &BoundScalars::huge),
+			field("ratio", &BoundScalars::ratio),
+			field("value", &BoundScalars::value),
+			field("maybe", &BoundScalars::maybe),
+			field("flags", &BoundScalars::flags),
+			field("counts", &BoundScalars::counts));
+	};
+
+	template <>
+	struct Binding<BoundNode>
+	{
+		static constexpr auto fields = std::make_tuple(
+			field("label", &BoundNode::label),
+			field("children", &BoundNode::children));
+	};
+}
+
+template <typename T>
+void assert_bind_throws(const std::string& json)
+{
+	auto out = T();
+
+	try
+	{
+		deserializeInto(json, out);
+	}
+	catch (const std::exception&)
+	{
+		return;
+	}
+
+	assert(false);
+}
+
+void test_bind()
+{
+	using Table = FieldTable<BoundScalars>;
+
+	for (size_t i = 0; i < Table::count; ++i)
+		assert(Table::find(Table::names[i]) == i);
+
+	for ([[maybe_unused]] auto key : { "", "flagz", "Flag", "colors", "value ", "counts\n" })
+		assert(Table::find(key) == Table::count);
+
+	auto colors = BoundColors();
+
+	deserializeInto(colorsJson, colors);
+
+	assert(colors.colors.size() == 6);
+	assert(colors.colors[0].name == "black");
+	assert(colors.colors[0].type == "primary");
+	assert(colors.colors[0].code.rgba == std::vector<int>({ 255, 255, 255, 1 }));
+	assert(colors.colors[1].code.hex == "#FFF");
+	assert(!colors.colors[1].type.has_value());
+
+	// Written the same way as the equivalent value
+	assert(deserialize(serialize(colors)) == deserialize(colorsJson));
+	assert(deserialize(serialize(colors, true)) == deserialize(colorsJson));
+
+	auto stream = std::ostringstream();
+
+	serialize(stream, colors);
+	assert(stream.str() == serialize(colors));
+
+	// Reading into the same object again reuses it
+	[[maybe_unused]] auto capacity = colors.colors.capacity();
+
+	deserializeInto("{\"colors\": [{\"color\": \"red\", \"ignored\": {\"a\": [1, {}]}, \"code\": {\"rgba\": []}}]}", colors);
+	assert(colors.colors.size() == 1 && colors.colors.capacity() == capacity);
+	assert(colors.colors[0].name == "red" && colors.colors[0].code.rgba.empty());
+
+	auto scalars = BoundScalars();
+	auto scalarsJson = "{\"flag\": true, \"small\": -128, \"port\": 65535, \"big\": -9223372036854775808, "
+		"\"huge\": 18446744073709551615, \"ratio\": 0.5, \"value\": 1e300, \"maybe\": 2, "
+		"\"flags\": {\"on\": [true, false], \"\\u006Ff\\u0066\": []}, \"counts\": {\"a\": 1, \"b\": null}, \"extra\": null}";
+
+	deserializeInto(scalarsJson, scalars);
+
+	assert(scalars.flag && scalars.small == -128 && scalars.port == 65535);
+	assert(scalars.big == std::numeric_limits<int64_t>::min());
+	assert(scalars.huge == std::numeric_limits<uint64_t>::max());
+	assert(scalars.ratio == 0.5f && scalars.value == 1e300 && scalars.maybe == 2.0);
+	assert(scalars.flags.at("on") == std::vector<bool>({ true, false }) && scalars.flags.at("off").empty());
+	assert(scalars.counts.at("a") == 1 && !scalars.counts.at("b").has_value());
+
+	auto roundTrip = BoundScalars();
+
+	deserializeInto(serialize(scalars), roundTrip);
+	assert(roundTrip.flag == scalars.flag && roundTrip.small == scalars.small && roundTrip.port == scalars.port);
+	assert(roundTrip.big == scalars.big && roundTrip.huge == scalars.huge);
+	assert(roundTrip.ratio == scalars.ratio && roundTrip.value == scalars.value && roundTrip.maybe == scalars.maybe);
+	assert(roundTrip.flags == scalars.flags && roundTrip.counts == scalars.counts);
+
+	// Empty optionals are left out and missing members keep their values
+	scalars.maybe.reset();
+	assert(serialize(scalars, true).find("maybe") == std::string::npos);
+	deserializeInto("{\"small\": 1e2, \"maybe\": null}", scalars);
+	assert(scalars.small == 100 && !scalars.maybe && scalars.port == 65535);
+
+	assert(serialize(BoundNode(), true) == "{\"label\":\"\",\"children\":[]}");
+	assert(serialize(BoundNode()) == "{\n\t\"label\": \"\",\n\t\"children\": []\n}");
+	assert(serialize(std::vector<int>({ 1, -2 }), true) == "[1,-2]");
+	assert(serialize(std::map<std::string, std::vector<int>>(), true) == "{}");
+	assert(serialize(std::optional<BoundNode>(), true) == "null");
+
+	auto tree = BoundNode();
+
+	deserializeInto("{\"label\": \"root\", \"children\": [{\"label\": \"a\", \"children\": [{\"label\": \"b\"}]}, {}]}", tree);
+	assert(tree.children.size() == 2 && tree.children[0].children[0].label == "b" && tree.children[1].label.empty());
+
+	assert_bind_throws<BoundScalars>("{\"small\": 128}");
+	assert_bind_throws<BoundScalars>("{\"port\": -1}");
+	assert_bind_throws<BoundScalars>("{\"big\": 9223372036854775808}");
+	assert_bind_throws<BoundScalars>("{\"big\": 1.5}");
+	assert_bind_throws<BoundScalars>("{\"flag\": 1}");
+	assert_bind_throws<BoundScalars>("{\"value\": \"1\"}");
+	assert_bind_throws<BoundScalars>("{\"extra\": }");
+
+	// Members no field is bound to must still be valid JSON
+	assert_bind_throws<BoundScalars>("{\"skipped\": [1,,2], \"flag\": true}");
+	assert_bind_throws<BoundScalars>("{\"skipped\": {\"a\" 1 :}, \"flag\": true}");
+	assert_bind_throws<BoundScalars>("{\"skipped\": [1.], \"flag\": true}");
+	assert_bind_throws<BoundScalars>("{\"skipped\": \"\\q\", \"flag\": true}");
+	assert_bind_throws<BoundScalars>("{\"skipped\": " + std::string(maxParseDepth, '[') + std::string(maxParseDepth, ']') + "}");
+
+	auto skipped = BoundScalars();
+
+	deserializeInto("{\"skipped\": [1, {\"a\": [true, null, \"\\n\"]}, -2.5e3], \"flag\": true}", skipped);
+	assert(skipped.flag);
+	assert_bind_throws<BoundScalars>("{\"flag\": true,}");
+	assert_bind_throws<BoundScalars>("{\"flag\": true");
+	assert_bind_throws<BoundScalars>("{\"flag\" true}");
+	assert_bind_throws<BoundScalars>("{\"flag\": true} []");
+	assert_bind_throws<BoundScalars>("[]");
+	assert_bind_throws<BoundScalars>("");
+	assert_bind_throws<BoundColors>("{\"colors\": {}}");
+	assert_bind_throws<BoundNode>(std::string(2000, '[') + std::string(2000, ']'));
+
+	auto deep = std::string();
+
+	for (size_t i = 0; i < 2000; ++i)
+		deep += "{\"children\": [";
+
+	assert_bind_throws<BoundNode>(deep);
+}
+
+void assert_valid(const char* format, [[maybe_unused]] const Value& value)
+{
+	auto validator = Validator(format);
+
+	assert(validator.isValid(value));
+	assert(validator.errors(value).empty());
+	assert(validator.isValidJson(serialize(value)));
+	assert(tryDeserialize(serialize(value), validator).value() == value);
+}
+
+void assert_invalid(const char* format, [[maybe_unused]] const Value& value)
+{
+	auto validator = Validator(format);
+
+	assert(!validator.isValid(value));
+	assert(!validator.errors(value).empty());
+	assert(!validator.isValidJson(serialize(value)));
+	assert(tryDeserialize(serialize(value), validator).error() == ParseError::FormatMismatch);
+}
+
+void assert_format_throws(const char* format)
+{
+	try
+	{
+		auto validator = Validator(format);
+	}
+	catch (const std::exception&)
+	{
+		return;
+	}
+
+	assert(false);
+}
+
+void test_validator()
+{
+	// Integers
+	assert_valid("#", 123);
+	assert_invalid("#", Value());
+	assert_invalid("#", "hello");
+	assert_invalid("#", 1.5);
+
+	assert_valid("#?", 123);
+	assert_valid("#?", Value());
+	assert_invalid("#?", "hello");
+
+	assert_valid("#[0,1]", 0);
+	assert_valid("#[0,1]", 1);
+	assert_invalid("#(0,1]", 0);
+	assert_invalid("#[0,1)", 1);
+	assert_invalid("#(0,1)", 0);
+	assert_invalid("#(0,1)", 1);
+	assert_valid("#[0,0]", 0);
+	assert_invalid("#(0,0)", 0);
+
+	assert_valid("#[0,~]", 0);
+	assert_valid("#[0,~]", 1);
+	assert_valid("#[0,~]", LLONG_MAX);
+	assert_valid("#[0,~)", 0);
+	assert_valid("#[0,~)", 1);
+	assert_invalid("#[0,~)", LLONG_MAX);
+
+	assert_invalid("#[~,0]", 1);
+	assert_valid("#[~,0]", 0);
+	assert_valid("#[~,0]", -1);
+	assert_valid("#[~,0]", -134543);
+	assert_valid("#[~,0]", LLONG_MIN);
+	assert_valid("#(~,0]", 0);
+	assert_valid("#(~,0]", -1);
+	assert_invalid("#(~,0]", LLONG_MIN);
+
+	// Decimals
+	assert_format_throws("%[");
+	assert_format_throws("%[,");
+	assert_format_throws("%[1]");
+	assert_format_throws("%[1,");
+	assert_format_throws("%[1,]");
+	assert_format_throws("%[1,0]");
+
+	assert_valid("%", 123);
+	assert_invalid("%", Value());
+	assert_invalid("%", "hello");
+
+	assert_valid("%?", 123);
+	assert_valid("%?", Value());
+	assert_invalid("%?", "hello");
+
+	assert_valid("%[0.0,1.0]", 0.0);
+	assert_valid("%[12,56]", 12.0);
+	assert_invalid("%(0,1]", 0);
+	assert_invalid("%[0,1)", 1);
+	assert_invalid("%(0,1)", 0);
+	assert_invalid("%(0,1)", 1);
+	assert_valid("%[0,0]", 0);
+	assert_invalid("%(0,0)", 0);
+
+	assert_valid("%[0,~]", 0.0);
+	assert_valid("%[0,~]", 1.0);
+	assert_valid("%[0,~]", DBL_MAX);
+	assert_valid("%[0,~)", 0.0);
+	assert_valid("%[0,~)", 1.0);
+	assert_invalid("%[0,~)", DBL_MAX);
+
+	assert_invalid("%[~,0]", 1.0);
+	assert_valid("%[~,0]", 0.0);
+	assert_valid("%[~,0]", -1.0);
+	assert_valid("%[~,0]", -134543.0);
+	assert_valid("%[~,0]", -DBL_MAX);
+	assert_valid("%(~,0]", 0.0);
+	assert_valid("%(~,0]", -1.0);
+	assert_invalid("%(~,0]", DBL_MAX);
+
+	// Strings and booleans
+	assert_valid("$", "hello");
+	assert_invalid("$", 1);
+	assert_invalid("$", Value());
+	assert_valid("$?", Value());
+	assert_valid("$?", "hello");
+	assert_invalid("$?", 1);
+
+	assert_valid("&", true);
+	assert_invalid("&", 1);
+	assert_invalid("&", Value());
+	assert_valid("&?", Value());
+	assert_valid("&?", false);
+	assert_invalid("&?", 1);
+
+	// Objects
+	assert_valid("{}", Object());
+	assert_invalid("{}", Value());
+	assert_invalid("{}", 1);
+	assert_valid("{}", Object({ { "key", 4 } }));
+
+	assert_valid("{}?", Value());
+	assert_valid("{}?", Object());
+	assert_invalid("{}?", 1);
+
+	assert_valid("{key:#}", Object({ { "key", 47 } }));
+	assert_invalid("{key:#}", Object({ { "key", Value() } }));
+	assert_invalid("{key:#}", Object());
+
+	assert_valid("{key:#?}", Object({ { "key", Value() } }));
+	assert_valid("{key:#?}", Object({ { "key", 1 } }));
+	assert_invalid("{key:#?}", Object({ { "key", "hello" } }));
+
+	assert_valid("{key:#,name:$}", Object({ { "key", 47 }, { "name", "Isaac" } }));
+	assert_invalid("{key:#,name:$}", Object({ { "key", Value() } }));
+	assert_invalid("{key:#,name:$}", Object({ { "key", Value() }, { "name", Value() } }));
+	assert_invalid("{key:#,name:$}", Object());
+	assert_format_throws("{key:#,key:$}");
+	assert_format_throws("{key #}");
+
+	// Arrays
+	assert_format_throws("[#..., #...]");
+
+	assert_valid("[]", Array());
+	assert_invalid("[]", Array({ 1 }));
+	assert_invalid("[]", Value());
+	assert_invalid("[]", 1);
+
+	assert_valid("[]?", Array());
+	assert_valid("[]?", Value());
+	assert_invalid("[]?", Array({ 1 }));
+	assert_invalid("[]?", 1);
+
+	assert_valid("[#]", Array({ 1 }));
+	assert_invalid("[#]", Array({ 1, 2 }));
+	assert_invalid("[#]", Array({ "hello" }));
+	assert_invalid("[#]", Array({ Value() }));
+
+	assert_valid("[#]?", Array({ 1 }));
+	assert_invalid("[#]?", Array({ 1, 2 }));
+	assert_invalid("[#]?", Array({ "hello" }));
+	assert_invalid("[#]?", Array({ Value() }));
+
+	assert_valid("[#?]", Array({ Value() }));
+	assert_invalid("[#?]", Array({ "hello" }));
+	assert_valid("[#?, #?, #]", Array({ Value(), Value(), 3 }));
+
+	assert_valid("[#?]?", Array({ Value() }));
+	assert_invalid("[#?]?", Array({ "hello" }));
+	assert_valid("[#?]?", Value());
+
+	assert_valid("[#...]", Array());
+	assert_valid("[#...]", Array({ 1 }));
+	assert_valid("[#...]", Array({ 1, 2, 3 }));
+	assert_invalid("[#...]", Array({ "hello" }));
+	assert_invalid("[#...]", Array({ 1, 2, "hello" }));
+
+	assert_valid("[#, #...]", Array({ 1 }));
+	assert_valid("[#, #...]", Array({ 1, 2 }));
+	assert_valid("[#, #...]", Array({ 1, 2, 234, 109 }));
+	assert_invalid("[#, #...]", Array());
+
+	assert_valid("[#?...]", Array());
+	assert_valid("[#?...]", Array({ Value() }));
+	assert_valid("[#?...]", Array({ 1 }));
+	assert_valid("[#?...]", Array({ 1, Value(), 2, Value() }));
+	assert_valid("[#?...]", Array({ Value(), Value(), Value() }));
+	assert_invalid("[#?...]", Array({ "hello" }));
+	assert_invalid("[#?...]", Array({ 1, "hello" }));
+	assert_invalid("[#?...]", Array({ Value(), "hello" }));
+
+	// Forms
+	auto form = "{first_name:$,middle_name:$?,last_name:$,age:#[0,150],minor:&,patience:%[0,1],friends:[$, $, $]}";
+	auto person = Value(Object({
+		{ "first_name", "Isaac" },
+		{ "last_name", "Hirzel" },
+		{ "age", 22 },
+		{ "minor", false },
+		{ "patience", 0.6 },
+		{ "friends", Array({ "Alex", "Jacob", "Memo" }) }
+	}));
+
+	assert_valid(form, person);
+
+	auto request = R"==(
+		{
+			ticker: $,
+			portfolio: $,
+			interval: #(0, ~]?,
+			ranges: [#(0, ~]...]?,
+			strategy: $?,
+			indicators: $?
+		}
+	)==";
+
+	assert_valid(request, Object({ { "ticker", "EUR_USD" }, { "portfolio", "Forex" } }));
+	assert_valid(request, Object({ { "ticker", "EUR_USD" }, { "portfolio", "Forex" }, { "ranges", Array({ 1, 5 }) } }));
+	assert_invalid(request, Object({ { "ticker", "EUR_USD" }, { "portfolio", "Forex" }, { "ranges", Array({ 1, 0 }) } }));
+
+	// Every failure is reported with where it happened
+	auto errors = Validator(form).errors(Object({ { "first_name", 1 }, { "age", 200 }, { "friends", Array({ "Alex" }) } }));
+
+	assert(errors == std::vector<std::string>({
+		"/first_name: expected string, got number.",
+		"root: missing member 'last_name'.",
+		"/age: 200 is out of range.",
+		"root: missing member 'minor'.",
+		"root: missing member 'patience'.",
+		"/friends: expected 3 elements, got 1."
+	}));
+
+	// Text is checked from its tokens, and malformed text is simply invalid
+	auto validator = Validator("{id:#,tags:[$...]?}");
+
+	assert(validator.isValidJson("{\"skipped\": {\"a\": [1, {}]}, \"id\": 1e2, \"tags\": [\"a\", \"\\u0062\"]}"));
+	assert(!validator.isValidJson("{\"id\": 1, \"tags\": [\"\\x\"]}"));
+	assert(!validator.isValidJson("{\"id\": 1"));
+	assert(!validator.isValidJson("{\"id\": 1} {}"));
+	assert(!validator.isValidJson("{\"id\": 1, \"id2\": }"));
+
+	// Members the format does not mention are checked for syntax all the same
+	auto idOnly = Validator("{id:#}");
+	auto malformedMembers = std::vector<std::string>({
+		"{\"skipped\": [1,,2], \"id\": 1}",
+		"{\"skipped\": {\"a\" 1 :}, \"id\": 1}",
+		"{\"skipped\": [1 2], \"id\": 1}",
+		"{\"skipped\": {1: 2}, \"id\": 1}",
+		"{\"skipped\": [1.], \"id\": 1}",
+		"{\"skipped\": \"\\q\", \"id\": 1}",
+		"{\"skipped\": [}, \"id\": 1}",
+		"{\"skipped\": " + std::string(maxParseDepth + 1, '[') + std::string(maxParseDepth + 1, ']') + ", \"id\": 1}"
+	});
+
+	for ([[maybe_unused]] const auto& text : malformedMembers)
+	{
+		assert(!idOnly.isValidJson(text));
+		assert(!tryDeserialize(text));
+	}
+
+	assert(idOnly.isValidJson("{\"skipped\": [1, {\"a\": [true, null, \"\\n\"]}, -2.5e3], \"id\": 1}"));
+	assert(!validator.isValidJson(""));
+	assert(validator.isValidJson("{\"\\u0069d\": 1}"));
+
+	// Parsing against a format stops at the first value it rejects
+	auto assert_rejected_at = [&](const char* json, [[maybe_unused]] size_t offset)
+	{
+		auto result = tryDeserialize(json, validator);
+
+		assert(result.error() == ParseError::FormatMismatch);
+		assert(result.offset() == offset);
+	};
+
+	assert_rejected_at("{\"id\": \"1\"}", 7);
+	assert_rejected_at("{\"id\": 1.5}", 7);
+	assert_rejected_at("{\"tags\": [\"a\", 2], \"id\": 1}", 15);
+	assert_rejected_at("{\"tags\": null, \"other\": {}}", 26);
+	assert_rejected_at("[]", 0);
+	assert(tryDeserialize("{\"id\": 1, \"tags\": [\"a\", }", validator).error() == ParseError::UnexpectedCharacter);
+	assert(tryDeserialize("{\"id\": 1,", validator).error() == ParseError::UnexpectedEndOfFile);
+	assert(deserialize("{\"id\": 1, \"extra\": [1, 2]}", validator) == Value(Object({ { "id", 1 }, { "extra", Array({ 1, 2 }) } })));
+	assert_rejected_at("[1, 2]", 0);
+	assert(tryDeserialize("[1, 2, 3]", Validator("[#, #]")).offset() == 7);
+	assert(tryDeserialize("[1]", Validator("[#, #]")).offset() == 2);
+
+	try
+	{
+		deserialize("{\"id\": -1e400}", validator);
+		assert(false);
+	}
+	catch (const std::exception&)
+	{
+	}
+}
+
+void writeFile(const std::string& filepath, const std::string& text)
+{
+	auto file = std::ofstream(filepath, std::ios::binary);
+
+	file << text;
+}
+
+void test_tape()
+{
+	auto colors = deserialize(colorsJson);
+	auto tape = Tape(colorsJson);
+	auto root = tape.root();
+
+	assert(root.isObject());
+	assert(root.length() == 1);
+	assert(root.value() == colors);
+	assert(root["colors"].length() == 6);
+	assert(root["colors"][3]["color"].string() == "blue");
+	assert(root["colors"][3]["code"]["rgba"][2].number() == 255);
+	assert(!root.at("missing"));
+	assert(!root["colors"].at(6));
+	assert(root["colors"][5]["code"]["hex"].value() == "#0F0");
+
+	auto names = std::vector<std::string_view>();
+
+	root["colors"].forEachElement([&](const TapeValue& color) { names.push_back(color["color"].string()); });
+	assert(names.size() == 6 && names[0] == "black" && names[5] == "green");
+
+	for (const auto* json : { "null", "true", "false", "-1.5e3", "\"a\\n\\u00e9\"", "[]", "{}", "[[], {}, [1, [2]]]", "{\"\": {\"a\": [null]}}" })
+	{
+		auto scalar = Tape(json);
+
+		assert(scalar.root().value() == deserialize(json));
+	}
+
+	assert(Tape("\"a\\tb\"").root().string() == "a\tb");
+	assert(Tape(pokemonJson).root().value() == deserialize(pokemonJson));
+
+	try
+	{
+		Tape("[1, 2");
+		assert(false && "tape should not parse");
+	}
+	catch (const std::runtime_error&)
+	{}
+
+	// Loading maps the saved words and strings instead of parsing them again
+	auto filepath = (std::filesystem::temp_directory_path() / "hirzel_json_test_tape.bin").string();
+
+	tape.save(filepath);
+
+	auto loaded = Tape::load(filepath);
+
+	assert(loaded.isMapped());
+	assert(loaded.wordCount() == tape.wordCount());
+	assert(loaded.root().value() == colors);
+
+	auto moved = std::move(loaded);
+
+	assert(moved.root()["colors"][1]["code"]["hex"].string() == "#FFF");
+
+	// Truncated and foreign files are rejected by their header
+	auto bytes = std::string();
+
+	{
+		auto file = std::ifstream(filepath, std::ios::binary);
+
+		bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	for (const auto& contents : { bytes.substr(0, bytes.size() - 1), std::string(colorsJson), std::string() })
+	{
+		writeFile(filepath, contents);
+
+		try
+		{
+			Tape::load(filepath);
+			assert(false && "tape should not load");
+		}
+		catch (const std::runtime_error&)
+		{}
+	}
+
+	std::filesystem::remove(filepath);
+
+	// Building is limited to the same depth as deserialize
+	auto deep = std::string(maxParseDepth, '[') + std::string(maxParseDepth, ']');
+
+	assert(Tape(deep).root().length() == 1);
+
+	for (const auto& text : { "[" + deep + "]", std::string(2000000, '[') })
+	{
+		try
+		{
+			Tape(text.c_str(), text.size());
+			assert(false && "tape should not build");
+		}
+		catch (const std::runtime_error& e)
+		{
+			assert(std::string(e.what()).find(describe(ParseError::TooDeep)) != std::string::npos);
+		}
+	}
+}
+
+void test_mapped_file()
+{
+	auto directory = std::filesystem::temp_directory_path();
+	auto filepath = (directory / "hirzel_json_test_mapped_file.json").string();
+
+	writeFile(filepath, colorsJson);
+
+	auto file = MappedFile(filepath);
+
+	assert(file.length() == std::strlen(colorsJson));
+	assert(std::memcmp(file.data(), colorsJson, file.length()) == 0);
+
+	for (size_t i = 0; i < MappedFile::padding; ++i)
+		assert(file.data()[file.length() + i] == '\0');
+
+	assert(deserializeFile(filepath) == deserialize(colorsJson));
+
+	auto arena = Arena();
+
+	assert(deserializeFile(filepath, arena) == deserialize(colorsJson));
+
+	assert(deserializeView(file, arena) == deserialize(colorsJson));
+
+	auto moved = std::move(file);
+
+	assert(file.length() == 0);
+	assert(moved.length() == std::strlen(colorsJson));
+
+	// Files filling whole pages are still followed by zeroed padding
+	auto document = std::string("{\"text\": \"") + std::string(4096 * 2 - 12, 'x') + "\"}";
+
+	assert(document.length() == 4096 * 2);
+	writeFile(filepath, document);
+
+	auto pageFile = MappedFile(filepath);
+
+	assert(pageFile.data()[pageFile.length()] == '\0');
+
+	// Strings without escapes view the mapping itself
+	const auto view = deserializeView(pageFile, arena);
+
+	assert(view["text"].isBorrowed());
+	assert(view["text"].string().data() == pageFile.data() + 10);
+	assert(deserializeFile(filepath)["text"].string().length() == 4096 * 2 - 12);
+
+	writeFile(filepath, "");
+	assert(MappedFile(filepath).length() == 0);
+	assert(MappedFile(filepath).data()[0] == '\0');
+
+	try
+	{
+		deserializeFile(filepath);
+		assert(false && "empty file should not parse");
+	}
+	catch (const std::runtime_error&)
+	{}
+
+	std::filesystem::remove(filepath);
+
+	try
+	{
+		deserializeFile(filepath);
+		assert(false && "missing file should not open");
+	}
+	catch (const std::runtime_error& e)
+	{
+		assert(std::string(e.what()).find(filepath) != std::string::npos);
+	}
+}
+
 int main()
 {
 	// TODO: Add testing for new exceptions and 'at' functions
@@ -1042,6 +3354,26 @@ int main()
 	test_array();
 	test_object();
 	test_parse();
+	test_structural_index();
+	test_arena();
+	test_shared_copy();
+	test_document();
+	test_events();
+	test_escaped_cursor();
+	test_push_parser();
+	test_ndjson();
+	test_writer();
+	test_serialize_parallel();
+	test_key_pool();
+	test_try_deserialize();
+	test_deserialize_into();
+	test_mapped_file();
+	test_pointer();
+	test_query();
+	test_binary();
+	test_tape();
+	test_bind();
+	test_validator();
 
 	return 0;
 }